@@ -0,0 +1,173 @@
+#pragma once
+/*
+ * Minimal Arduino core for the native (host) build
+ * Provides the subset of the Arduino/ESP32 API used by the LED engine so that it can be
+ * compiled and benchmarked on a PC. There is no hardware: GPIO and LEDC calls are no-ops,
+ * time comes from std::chrono (and can be advanced manually, see hostSetTime()).
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+#include <type_traits>
+#include <cmath>
+#include <string>
+
+typedef uint8_t byte;
+typedef bool boolean;
+typedef uint16_t word;
+inline uint16_t makeWord(uint16_t w) { return w; }
+inline uint16_t makeWord(uint8_t h, uint8_t l) { return (h << 8) | l; }
+#define word(...) makeWord(__VA_ARGS__)
+
+// mixed argument types are allowed like on the device (where size_t and uint32_t are the same type)
+template<typename T, typename L> static inline typename std::common_type<T, L>::type min(T a, L b) { return (b < a) ? b : a; }
+template<typename T, typename L> static inline typename std::common_type<T, L>::type max(T a, L b) { return (b > a) ? b : a; }
+using std::isinf;
+using std::isnan;
+
+#define HIGH 0x1
+#define LOW  0x0
+#define INPUT          0x01
+#define OUTPUT         0x03
+#define PULLUP         0x04
+#define INPUT_PULLUP   0x05
+#define PULLDOWN       0x08
+#define INPUT_PULLDOWN 0x09
+#define OPEN_DRAIN     0x10
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+#define radians(deg) ((deg)*DEG_TO_RAD)
+#define degrees(rad) ((rad)*RAD_TO_DEG)
+#define sq(x) ((x)*(x))
+#define _min(a,b) ((a)<(b)?(a):(b))
+#define _max(a,b) ((a)>(b)?(a):(b))
+#define lowByte(w) ((uint8_t) ((w) & 0xff))
+#define highByte(w) ((uint8_t) ((w) >> 8))
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+#define bit(b) (1UL << (b))
+
+// attributes and flash access (flash is normal memory on the host)
+#define IRAM_ATTR
+#define ICACHE_RAM_ATTR
+#define RAM_ATTR
+#define DRAM_ATTR
+#define ICACHE_FLASH_ATTR
+#define PROGMEM
+#define PGM_P const char *
+#define PGM_VOID_P const void *
+#define PSTR(s) (s)
+class __FlashStringHelper;
+#define FPSTR(p) (reinterpret_cast<const __FlashStringHelper *>(p))
+#define F(s) FPSTR(PSTR(s))
+#define pgm_read_byte(addr)  (*(const uint8_t *)(addr))
+#define pgm_read_word(addr)  (*(const uint16_t *)(addr))
+// tables of pointers are read with pgm_read_dword() on the 32 bit targets, keep full pointers on 64 bit hosts
+template<typename T> inline uint32_t hostReadDword(const T *addr) { return *(const uint32_t *)addr; }
+template<typename T> inline T *hostReadDword(T * const *addr) { return *addr; }
+#define pgm_read_dword(addr) hostReadDword(addr)
+#define pgm_read_float(addr) (*(const float *)(addr))
+#define pgm_read_ptr(addr)   (*(const void * const *)(addr))
+#define pgm_read_byte_near(addr)  pgm_read_byte(addr)
+#define pgm_read_word_near(addr)  pgm_read_word(addr)
+#define pgm_read_dword_near(addr) pgm_read_dword(addr)
+#define memcpy_P      memcpy
+#define memcmp_P      memcmp
+#define strcpy_P      strcpy
+#define strncpy_P     strncpy
+#define strcat_P      strcat
+#define strncat_P     strncat
+#define strlen_P      strlen
+#define strnlen_P     strnlen
+#define strcmp_P      strcmp
+#define strncmp_P     strncmp
+#define strcasecmp_P  strcasecmp
+#define strncasecmp_P strncasecmp
+#define strstr_P      strstr
+#define strchr_P      strchr
+#define sprintf_P     sprintf
+#define snprintf_P    snprintf
+#define vsnprintf_P   vsnprintf
+#define printf_P      printf
+
+// newlib extensions missing from glibc
+size_t strlcpy(char *dst, const char *src, size_t size);
+size_t strlcat(char *dst, const char *src, size_t size);
+char *itoa(int value, char *str, int base);
+char *utoa(unsigned value, char *str, int base);
+char *ltoa(long value, char *str, int base);
+char *ultoa(unsigned long value, char *str, int base);
+char *dtostrf(double val, signed char width, unsigned char prec, char *sout);
+
+// time: real time by default, can be frozen/advanced by benchmarks and tests
+unsigned long millis();
+unsigned long micros();
+uint64_t micros64();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+void hostSetTime(uint64_t us);  // freezes time at given value (us)
+void hostAdvanceTime(uint64_t us);
+void hostRealTime();             // back to real time
+
+// random numbers
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+uint32_t esp_random();
+
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+
+// GPIO, PWM, ADC (no hardware)
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int val);
+double ledcSetup(uint8_t channel, double freq, uint8_t resolution_bits);
+void ledcWrite(uint8_t channel, uint32_t duty);
+void ledcAttachPin(uint8_t pin, uint8_t channel);
+void ledcDetachPin(uint8_t pin);
+bool digitalPinIsValid(int8_t pin);
+#define digitalPinToAnalogChannel(p) (-1)
+#define digitalPinToTouchChannel(p) (-1)
+#define digitalPinCanOutput(p) ((p) >= 0 && (p) < 34)
+
+// default pins of an ESP32 dev board (pins_arduino.h)
+static const uint8_t SDA = 21;
+static const uint8_t SCL = 22;
+static const uint8_t SS = 5;
+static const uint8_t MOSI = 23;
+static const uint8_t MISO = 19;
+static const uint8_t SCK = 18;
+
+// PSRAM and heap
+bool psramFound();
+void *ps_malloc(size_t size);
+void *ps_calloc(size_t n, size_t size);
+void *ps_realloc(void *ptr, size_t size);
+
+#include "freertos/FreeRTOS.h"
+#include "WString.h"
+#include "Print.h"
+#include "IPAddress.h"
+#include "HardwareSerial.h"
+#include "Esp.h"
@@ -0,0 +1,35 @@
+#pragma once
+// async TCP client for the native build (never connects)
+#include "Arduino.h"
+#include <functional>
+
+class AsyncClient;
+typedef std::function<void(void *, AsyncClient *)> AcConnectHandler;
+typedef std::function<void(void *, AsyncClient *, void *data, size_t len)> AcDataHandler;
+typedef std::function<void(void *, AsyncClient *, int8_t error)> AcErrorHandler;
+
+class AsyncClient {
+  public:
+    bool connect(IPAddress, uint16_t) { return false; }
+    bool connect(const char *, uint16_t) { return false; }
+    void close(bool = false) {}
+    void stop() {}
+    bool connected() { return false; }
+    bool connecting() { return false; }
+    bool disconnected() { return true; }
+    size_t add(const char *, size_t, uint8_t = 0) { return 0; }
+    size_t write(const char *) { return 0; }
+    size_t write(const char *, size_t, uint8_t = 0) { return 0; }
+    bool send() { return false; }
+    size_t space() { return 0; }
+    bool canSend() { return false; }
+    void setNoDelay(bool) {}
+    void onConnect(AcConnectHandler, void * = nullptr) {}
+    void onDisconnect(AcConnectHandler, void * = nullptr) {}
+    void onData(AcDataHandler, void * = nullptr) {}
+    void onError(AcErrorHandler, void * = nullptr) {}
+    void onTimeout(std::function<void(void *, AsyncClient *, uint32_t)>, void * = nullptr) {}
+    IPAddress remoteIP() { return IPAddress(); }
+    uint16_t remotePort() { return 0; }
+    IPAddress localIP() { return IPAddress(); }
+};
@@ -0,0 +1,45 @@
+#pragma once
+// async UDP for the native build: packets are delivered by tests with hostUdpDeliver() (see HostNet.h)
+
+#include "Arduino.h"
+#include <functional>
+#include <vector>
+
+class AsyncUDPPacket {
+  public:
+    AsyncUDPPacket(const uint8_t *data, size_t len, IPAddress remote, uint16_t remotePort, uint16_t localPort, bool broadcast = false, bool multicast = false)
+    : _data(data), _len(len), _remote(remote), _remotePort(remotePort), _localPort(localPort), _broadcast(broadcast), _multicast(multicast) {}
+    uint8_t *data() { return const_cast<uint8_t *>(_data); }
+    size_t length() { return _len; }
+    IPAddress remoteIP() { return _remote; }
+    uint16_t remotePort() { return _remotePort; }
+    IPAddress localIP() { return IPAddress(192, 168, 1, 100); }
+    uint16_t localPort() { return _localPort; }
+    bool isBroadcast() { return _broadcast; }
+    bool isMulticast() { return _multicast; }
+  private:
+    const uint8_t *_data;
+    size_t _len;
+    IPAddress _remote;
+    uint16_t _remotePort, _localPort;
+    bool _broadcast, _multicast;
+};
+
+typedef std::function<void(AsyncUDPPacket &packet)> AuPacketHandlerFunction;
+
+class AsyncUDP {
+  public:
+    AsyncUDP();
+    ~AsyncUDP();
+    bool listen(uint16_t port) { _port = port; return true; }
+    bool listenMulticast(const IPAddress &, uint16_t port, uint8_t ttl = 1) { return listen(port); }
+    void onPacket(AuPacketHandlerFunction cb) { _cb = cb; }
+    void close() { _port = 0; }
+    size_t writeTo(const uint8_t *data, size_t len, const IPAddress &addr, uint16_t port);
+    size_t broadcastTo(uint8_t *data, size_t len, uint16_t port) { return writeTo(data, len, IPAddress(255, 255, 255, 255), port); }
+    uint16_t port() const { return _port; }
+    void deliver(AsyncUDPPacket &p) { if (_cb) _cb(p); }
+  private:
+    uint16_t _port = 0;
+    AuPacketHandlerFunction _cb;
+};
@@ -0,0 +1,11 @@
+#pragma once
+// captive portal DNS server for the native build (no-op)
+#include "Arduino.h"
+class DNSServer {
+  public:
+    bool start(uint16_t, const String &, const IPAddress &) { return true; }
+    void stop() {}
+    void processNextRequest() {}
+    void setErrorReplyCode(int) {}
+};
+#define DNSReplyCode int
@@ -0,0 +1,334 @@
+#pragma once
+// async web server and WebSocket for the native build
+// Requests are not served. WebSocket clients can be added by tests (AsyncWebSocket::hostAddClient()),
+// messages sent to them are recorded per client.
+
+#include "Arduino.h"
+#include "AsyncTCP.h"
+#include "LittleFS.h"
+#include <functional>
+#include <vector>
+#include <memory>
+
+#define SPIFFS_EDITOR_AIRCOOOKIE
+
+typedef enum {
+  HTTP_GET     = 0b00000001,
+  HTTP_POST    = 0b00000010,
+  HTTP_DELETE  = 0b00000100,
+  HTTP_PUT     = 0b00001000,
+  HTTP_PATCH   = 0b00010000,
+  HTTP_HEAD    = 0b00100000,
+  HTTP_OPTIONS = 0b01000000,
+  HTTP_ANY     = 0b01111111,
+} WebRequestMethod;
+typedef uint8_t WebRequestMethodComposite;
+
+class AsyncWebServerRequest;
+class AsyncWebServerResponse;
+typedef std::function<void(AsyncWebServerRequest *request)> ArRequestHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest *request, const String &filename, size_t index, uint8_t *data, size_t len, bool final)> ArUploadHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)> ArBodyHandlerFunction;
+typedef std::function<size_t(uint8_t *buffer, size_t maxLen, size_t index)> AwsResponseFiller;
+typedef std::function<String(const String &)> AwsTemplateProcessor;
+
+class AsyncWebHeader {
+  public:
+    AsyncWebHeader(const String &name, const String &value) : _name(name), _value(value) {}
+    const String &name() const { return _name; }
+    const String &value() const { return _value; }
+  private:
+    String _name, _value;
+};
+
+class AsyncWebParameter {
+  public:
+    AsyncWebParameter(const String &name, const String &value, bool form = false, bool file = false, size_t size = 0)
+    : _name(name), _value(value), _size(size), _isForm(form), _isFile(file) {}
+    const String &name() const { return _name; }
+    const String &value() const { return _value; }
+    size_t size() const { return _size; }
+    bool isPost() const { return _isForm; }
+    bool isFile() const { return _isFile; }
+  private:
+    String _name, _value;
+    size_t _size;
+    bool _isForm, _isFile;
+};
+
+class AsyncWebServerResponse {
+  public:
+    virtual ~AsyncWebServerResponse() {}
+    void addHeader(const String &, const String &) {}
+    void setCode(int code) { _code = code; }
+    void setContentLength(size_t len) { _contentLength = len; }
+    void setContentType(const String &type) { _contentType = type; }
+    virtual bool _sourceValid() const { return false; }
+  protected:
+    int _code = 0;
+    String _contentType;
+    size_t _contentLength = 0;
+    size_t _sentLength = 0;
+};
+
+class AsyncAbstractResponse : public AsyncWebServerResponse {
+  public:
+    virtual size_t _fillBuffer(uint8_t *buf, size_t maxLen) { return 0; }
+};
+
+class AsyncResponseStream : public AsyncWebServerResponse, public Print {
+  public:
+    size_t write(uint8_t c) override { _content += (char)c; return 1; }
+    size_t write(const uint8_t *data, size_t len) override { _content.concat((const char *)data, len); return len; }
+    using Print::write;
+    size_t available() const { return _content.length(); }
+    bool _sourceValid() const override { return true; }
+    const String &hostContent() const { return _content; }
+  private:
+    String _content;
+};
+
+// filler is called with small chunks when the response is sent so chunk boundaries are exercised
+class AsyncChunkedResponse : public AsyncWebServerResponse {
+  public:
+    AsyncChunkedResponse(AwsResponseFiller filler) : _filler(filler) {}
+    bool _sourceValid() const override { return true; }
+    String hostContent() const {
+      String content;
+      uint8_t buf[61];
+      size_t len;
+      while ((len = _filler(buf, sizeof(buf), content.length())) > 0) content.concat((const char *)buf, len);
+      return content;
+    }
+  private:
+    AwsResponseFiller _filler;
+};
+
+class AsyncWebServerRequest {
+  public:
+    void *_tempObject = nullptr;
+    File _tempFile;
+
+    const String &url() const { return _url; }
+    WebRequestMethodComposite method() const { return _method; }
+    size_t contentLength() const { return 0; }
+    size_t args() const { return _params.size(); }
+    const String &arg(const String &name) const {
+      for (auto &p : _params) if (p.name() == name) return p.value();
+      return _empty;
+    }
+    const String &arg(size_t i) const { return i < _params.size() ? _params[i].value() : _empty; }
+    const String &argName(size_t i) const { return i < _params.size() ? _params[i].name() : _empty; }
+    bool hasArg(const char *name) const { for (auto &p : _params) if (p.name() == name) return true; return false; }
+    bool hasArg(const __FlashStringHelper *name) const { return hasArg(reinterpret_cast<const char *>(name)); }
+    bool hasParam(const String &name, bool post = false, bool file = false) const { return hasArg(name.c_str()); }
+    AsyncWebParameter *getParam(const String &name, bool post = false, bool file = false) const {
+      for (auto &p : _params) if (p.name() == name) return const_cast<AsyncWebParameter *>(&p);
+      return nullptr;
+    }
+    bool hasHeader(const String &) const { return false; }
+    AsyncWebHeader *getHeader(const String &) const { return nullptr; }
+    void addInterestingHeader(const String &) {}
+    IPAddress client_remoteIP() const { return IPAddress(); }
+
+    void send(AsyncWebServerResponse *response) {
+      _code = response ? 200 : 500;
+      if (auto *r = dynamic_cast<AsyncResponseStream *>(response)) _sent = r->hostContent();
+      if (auto *r = dynamic_cast<AsyncChunkedResponse *>(response)) _sent = r->hostContent();
+      delete response;
+    }
+    void send(int code, const String &contentType = String(), const String &content = String()) { _code = code; _sent = content; }
+    void send_P(int code, const String &contentType, const uint8_t *content, size_t len, AwsTemplateProcessor = nullptr) { _code = code; }
+    void send_P(int code, const String &contentType, const char *content, AwsTemplateProcessor = nullptr) { _code = code; _sent = content; }
+    void send(fs::FS &, const String &, const String & = String(), bool = false, AwsTemplateProcessor = nullptr) { _code = 200; }
+    AsyncWebServerResponse *beginResponse(int code, const String & = String(), const String & = String()) { return new AsyncWebServerResponse(); }
+    AsyncWebServerResponse *beginResponse(fs::FS &, const String &, const String & = String(), bool = false, AwsTemplateProcessor = nullptr) { return new AsyncWebServerResponse(); }
+    AsyncWebServerResponse *beginResponse_P(int code, const String &, const uint8_t *, size_t, AwsTemplateProcessor = nullptr) { return new AsyncWebServerResponse(); }
+    AsyncWebServerResponse *beginResponse_P(int code, const String &, const char *, AwsTemplateProcessor = nullptr) { return new AsyncWebServerResponse(); }
+    AsyncWebServerResponse *beginResponse(const String &, size_t, AwsResponseFiller, AwsTemplateProcessor = nullptr) { return new AsyncWebServerResponse(); }
+    AsyncWebServerResponse *beginChunkedResponse(const String &, AwsResponseFiller filler, AwsTemplateProcessor = nullptr) { return new AsyncChunkedResponse(filler); }
+    AsyncResponseStream *beginResponseStream(const String &, size_t = 1460) { return new AsyncResponseStream(); }
+
+    void hostAddArg(const String &name, const String &value) { _params.emplace_back(name, value); }
+    void hostSetUrl(const String &url) { _url = url; }
+    int hostCode() const { return _code; }
+    const String &hostSent() const { return _sent; }
+
+  private:
+    String _url;
+    WebRequestMethodComposite _method = HTTP_GET;
+    std::vector<AsyncWebParameter> _params;
+    int _code = 0;
+    String _sent;
+    String _empty;
+};
+
+class AsyncWebHandler {
+  public:
+    virtual ~AsyncWebHandler() {}
+    virtual bool canHandle(AsyncWebServerRequest *) { return false; }
+    virtual void handleRequest(AsyncWebServerRequest *) {}
+    virtual void handleUpload(AsyncWebServerRequest *, const String &, size_t, uint8_t *, size_t, bool) {}
+    virtual void handleBody(AsyncWebServerRequest *, uint8_t *, size_t, size_t, size_t) {}
+    virtual bool isRequestHandlerTrivial() { return true; }
+    AsyncWebHandler &setFilter(std::function<bool(AsyncWebServerRequest *)>) { return *this; }
+};
+
+class AsyncCallbackWebHandler : public AsyncWebHandler {};
+
+class DefaultHeaders {
+  public:
+    void addHeader(const String &name, const String &value) {}
+    static DefaultHeaders &Instance() { static DefaultHeaders instance; return instance; }
+};
+
+inline bool ON_STA_FILTER(AsyncWebServerRequest *request) { return true; }
+inline bool ON_AP_FILTER(AsyncWebServerRequest *request) { return false; }
+
+class AsyncWebServer {
+  public:
+    AsyncWebServer(uint16_t port) {}
+    void begin() {}
+    void end() {}
+    void reset() {}
+    AsyncWebHandler &addHandler(AsyncWebHandler *handler) { return *handler; }
+    bool removeHandler(AsyncWebHandler *) { return true; }
+    AsyncCallbackWebHandler &on(const char *, ArRequestHandlerFunction) { return _h; }
+    AsyncCallbackWebHandler &on(const char *, WebRequestMethodComposite, ArRequestHandlerFunction) { return _h; }
+    AsyncCallbackWebHandler &on(const char *, WebRequestMethodComposite, ArRequestHandlerFunction, ArUploadHandlerFunction) { return _h; }
+    AsyncCallbackWebHandler &on(const char *, WebRequestMethodComposite, ArRequestHandlerFunction, ArUploadHandlerFunction, ArBodyHandlerFunction) { return _h; }
+    void onNotFound(ArRequestHandlerFunction) {}
+    void onFileUpload(ArUploadHandlerFunction) {}
+    void onRequestBody(ArBodyHandlerFunction) {}
+  private:
+    AsyncCallbackWebHandler _h;
+};
+
+// WebSocket
+
+typedef enum { WS_DISCONNECTED, WS_CONNECTED, WS_DISCONNECTING } AwsClientStatus;
+typedef enum { WS_CONTINUATION, WS_TEXT, WS_BINARY, WS_DISCONNECT = 0x08, WS_PING, WS_PONG } AwsFrameType;
+typedef enum { WS_MSG_SENDING, WS_MSG_SENT, WS_MSG_ERROR } AwsMessageStatus;
+typedef enum { WS_EVT_CONNECT, WS_EVT_DISCONNECT, WS_EVT_PONG, WS_EVT_ERROR, WS_EVT_DATA } AwsEventType;
+
+typedef struct {
+  uint8_t message_opcode;
+  uint32_t num;
+  uint8_t final;
+  uint8_t masked;
+  uint8_t opcode;
+  uint64_t len;
+  uint8_t mask[4];
+  uint64_t index;
+} AwsFrameInfo;
+
+class AsyncWebSocketMessageBuffer {
+  public:
+    AsyncWebSocketMessageBuffer(size_t size = 0) : _data(size + 1, 0), _len(size) {}
+    AsyncWebSocketMessageBuffer(const uint8_t *data, size_t size) : _data(data, data + size), _len(size) { _data.push_back(0); }
+    uint8_t *get() { return _data.data(); }
+    size_t length() const { return _len; }
+    void lock() { _lock++; }
+    void unlock() { if (_lock) _lock--; }
+    bool canDelete() const { return !_lock; }
+  private:
+    std::vector<uint8_t> _data;
+    size_t _len;
+    uint8_t _lock = 0;
+};
+
+class AsyncWebSocket;
+
+class AsyncWebSocketClient {
+  public:
+    AsyncWebSocketClient(AsyncWebSocket *server, uint32_t id) : _server(server), _id(id) {}
+    uint32_t id() const { return _id; }
+    AwsClientStatus status() const { return _status; }
+    IPAddress remoteIP() const { return IPAddress(192, 168, 1, 2); }
+    bool queueIsFull() const { return false; }
+    size_t queueLength() const { return 0; }
+    bool canSend() const { return true; }
+    void close(uint16_t code = 0, const char *message = nullptr) { _status = WS_DISCONNECTED; }
+    void ping(const uint8_t * = nullptr, size_t = 0) {}
+    void text(const char *message, size_t len) { _texts.emplace_back(message, len); }
+    void text(const char *message) { text(message, strlen(message)); }
+    void text(const String &message) { text(message.c_str(), message.length()); }
+    void text(const __FlashStringHelper *message) { text(reinterpret_cast<const char *>(message)); }
+    void text(AsyncWebSocketMessageBuffer *buffer) { if (buffer) text((const char *)buffer->get(), buffer->length()); }
+    void binary(const uint8_t *message, size_t len) { _binaries.emplace_back(message, message + len); }
+    void binary(const char *message, size_t len) { binary((const uint8_t *)message, len); }
+    void binary(AsyncWebSocketMessageBuffer *buffer) { if (buffer) binary(buffer->get(), buffer->length()); }
+
+    // messages sent to this client (native build only)
+    std::vector<String> &hostTexts() { return _texts; }
+    std::vector<std::vector<uint8_t>> &hostBinaries() { return _binaries; }
+  private:
+    AsyncWebSocket *_server;
+    uint32_t _id;
+    AwsClientStatus _status = WS_CONNECTED;
+    std::vector<String> _texts;
+    std::vector<std::vector<uint8_t>> _binaries;
+};
+
+typedef std::function<void(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len)> AwsEventHandler;
+
+class AsyncWebSocket : public AsyncWebHandler {
+  public:
+    typedef std::vector<AsyncWebSocketClient *> AsyncWebSocketClientLinkedList;
+
+    AsyncWebSocket(const String &url) {}
+    ~AsyncWebSocket() { for (auto c : _clients) delete c; }
+    void onEvent(AwsEventHandler handler) { _handler = handler; }
+    size_t count() const {
+      size_t n = 0;
+      for (auto c : _clients) if (c->status() == WS_CONNECTED) n++;
+      return n;
+    }
+    AsyncWebSocketClient *client(uint32_t id) {
+      for (auto c : _clients) if (c->id() == id && c->status() == WS_CONNECTED) return c;
+      return nullptr;
+    }
+    const AsyncWebSocketClientLinkedList &getClients() const { return _clients; }
+    bool availableForWriteAll() { return true; }
+    bool availableForWrite(uint32_t) { return true; }
+    void cleanupClients(uint16_t maxClients = 8) {
+      while (count() > maxClients) { for (auto c : _clients) if (c->status() == WS_CONNECTED) { c->close(); break; } }
+    }
+    void closeAll(uint16_t code = 0, const char *message = nullptr) { for (auto c : _clients) c->close(code, message); }
+    void textAll(const char *message, size_t len) { for (auto c : _clients) if (c->status() == WS_CONNECTED) c->text(message, len); }
+    void textAll(const char *message) { textAll(message, strlen(message)); }
+    void textAll(const String &message) { textAll(message.c_str(), message.length()); }
+    void textAll(AsyncWebSocketMessageBuffer *buffer) { if (buffer) textAll((const char *)buffer->get(), buffer->length()); }
+    void binaryAll(const uint8_t *message, size_t len) { for (auto c : _clients) if (c->status() == WS_CONNECTED) c->binary(message, len); }
+    void binaryAll(AsyncWebSocketMessageBuffer *buffer) { if (buffer) binaryAll(buffer->get(), buffer->length()); }
+    AsyncWebSocketMessageBuffer *makeBuffer(size_t size = 0) { _buffers.emplace_back(new AsyncWebSocketMessageBuffer(size)); return _buffers.back().get(); }
+    AsyncWebSocketMessageBuffer *makeBuffer(const uint8_t *data, size_t size) { _buffers.emplace_back(new AsyncWebSocketMessageBuffer(data, size)); return _buffers.back().get(); }
+    void _cleanBuffers() {
+      for (size_t i = 0; i < _buffers.size();) {
+        if (_buffers[i]->canDelete()) _buffers.erase(_buffers.begin() + i);
+        else i++;
+      }
+    }
+
+    // native build only: connects a client (calls event handler with WS_EVT_CONNECT)
+    AsyncWebSocketClient *hostAddClient() {
+      AsyncWebSocketClient *c = new AsyncWebSocketClient(this, ++_lastId);
+      _clients.push_back(c);
+      if (_handler) _handler(this, c, WS_EVT_CONNECT, nullptr, nullptr, 0);
+      return c;
+    }
+    // native build only: delivers a complete message from a client
+    void hostReceive(AsyncWebSocketClient *c, const uint8_t *data, size_t len, bool binary) {
+      AwsFrameInfo info = {};
+      info.opcode = info.message_opcode = binary ? WS_BINARY : WS_TEXT;
+      info.final = 1;
+      info.len = len;
+      if (_handler) _handler(this, c, WS_EVT_DATA, &info, const_cast<uint8_t *>(data), len);
+    }
+
+  private:
+    AsyncWebSocketClientLinkedList _clients;
+    std::vector<std::unique_ptr<AsyncWebSocketMessageBuffer>> _buffers;
+    AwsEventHandler _handler;
+    uint32_t _lastId = 0;
+};
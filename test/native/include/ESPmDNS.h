@@ -0,0 +1,15 @@
+#pragma once
+// mDNS for the native build (no-op)
+#include "Arduino.h"
+class MDNSResponder {
+  public:
+    bool begin(const char *) { return true; }
+    void end() {}
+    void addService(const char *, const char *, uint16_t) {}
+    void addServiceTxt(const char *, const char *, const char *, const char *) {}
+    int queryService(const char *, const char *) { return 0; }
+    IPAddress IP(int) { return IPAddress(); }
+    String hostname(int) { return String(); }
+    uint16_t port(int) { return 0; }
+};
+extern MDNSResponder MDNS;
@@ -0,0 +1,14 @@
+#pragma once
+// Ethernet for the native build (not present)
+
+#include "Arduino.h"
+
+class ETHClass {
+  public:
+    IPAddress localIP() { return IPAddress(); }
+    IPAddress subnetMask() { return IPAddress(); }
+    IPAddress gatewayIP() { return IPAddress(); }
+    String macAddress() { return String("00:00:00:00:00:00"); }
+};
+
+extern ETHClass ETH;
@@ -0,0 +1,29 @@
+#pragma once
+// ESP object for the native build (heap figures are fixed values of a typical ESP32)
+
+#include <stdint.h>
+
+class EspClass {
+  public:
+    uint32_t getFreeHeap() { return _freeHeap; }
+    uint32_t getHeapSize() { return 327680; }
+    uint32_t getMinFreeHeap() { return _freeHeap; }
+    uint32_t getMaxAllocHeap() { return _freeHeap; }
+    uint32_t getPsramSize() { return 0; }
+    uint32_t getFreePsram() { return 0; }
+    uint32_t getFlashChipSize() { return 4*1024*1024; }
+    uint32_t getFreeSketchSpace() { return 1024*1024; }
+    uint32_t getCpuFreqMHz() { return 240; }
+    uint32_t getCycleCount();
+    const char *getChipModel() { return "host"; }
+    uint8_t getChipRevision() { return 0; }
+    uint8_t getChipCores() { return 1; }
+    const char *getSdkVersion() { return "host"; }
+    uint64_t getEfuseMac() { return 0x0000AABBCCDDEEFFULL; }
+    void restart() {}
+    void hostSetFreeHeap(uint32_t bytes) { _freeHeap = bytes; } // to test low memory paths
+  private:
+    uint32_t _freeHeap = 200000;
+};
+
+extern EspClass ESP;
@@ -0,0 +1,35 @@
+#pragma once
+// Serial for the native build: output goes to stdout, input is fed by tests (hostSerialInput())
+
+#include <stddef.h>
+#include <stdint.h>
+#include "Print.h"
+
+#define SERIAL_8N1 0x800001c
+
+class HardwareSerial : public Stream {
+  public:
+    void begin(unsigned long baud, uint32_t config = SERIAL_8N1, int8_t rxPin = -1, int8_t txPin = -1) { _baud = baud; }
+    void end() {}
+    void updateBaudRate(unsigned long baud) { _baud = baud; }
+    unsigned long baudRate() { return _baud; }
+    int available() override { return _rxLen - _rxPos; }
+    int availableForWrite() { return 128; }
+    int read() override { return _rxPos < _rxLen ? _rx[_rxPos++] : -1; }
+    int peek() override { return _rxPos < _rxLen ? _rx[_rxPos] : -1; }
+    size_t write(uint8_t c) override { return _quiet ? 1 : fwrite(&c, 1, 1, stdout); }
+    size_t write(const uint8_t *buf, size_t size) override { return _quiet ? size : fwrite(buf, 1, size, stdout); }
+    using Print::write;
+    operator bool() const { return true; }
+
+    void hostInput(const uint8_t *data, size_t len) { _rx = data; _rxLen = len; _rxPos = 0; } // data must stay valid while read
+    void hostQuiet(bool quiet) { _quiet = quiet; }
+
+  private:
+    unsigned long _baud = 115200;
+    const uint8_t *_rx = nullptr;
+    size_t _rxLen = 0, _rxPos = 0;
+    bool _quiet = false;
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,20 @@
+#pragma once
+// in-process loopback network of the native build
+// Every packet sent with WiFiUDP or AsyncUDP is recorded (hostUdpSent()). Sent packets are also queued
+// for WiFiUDP sockets bound to the destination port (read with parsePacket()). Tests can inject
+// packets with hostUdpInject() (WiFiUDP) or hostUdpDeliver() (AsyncUDP listeners, called synchronously).
+
+#include "Arduino.h"
+#include <vector>
+
+struct HostUdpPacket {
+  IPAddress src, dst;
+  uint16_t srcPort, dstPort;
+  std::vector<uint8_t> data;
+};
+
+std::vector<HostUdpPacket> &hostUdpSent();  // all packets sent since last hostUdpReset()
+void hostUdpReset();                         // clears sent packets and receive queue
+void hostUdpLoopback(bool enable);           // queue sent packets for local receivers (default on)
+void hostUdpInject(const HostUdpPacket &p);  // queue packet for WiFiUDP receivers
+size_t hostUdpDeliver(const HostUdpPacket &p); // call AsyncUDP listeners of p.dstPort, returns number of listeners
@@ -0,0 +1,14 @@
+#pragma once
+// LED setup of the native build
+// Creates busses like cfg.cpp does (digital busses on the stub NeoPixelBus, see NeoPixelBusLg.h)
+// and renders frames with WS2812FX::service() on a frozen clock, so runs are repeatable.
+
+#include <stdint.h>
+
+extern uint32_t hostBusShowCount;                        // number of bus Show() calls (see NeoPixelBusLg.h)
+extern uint32_t hostBusPixelUs;                          // simulated send time per pixel after Show() (0: always ready)
+
+void hostStripSetup(uint16_t length, uint8_t type = 0, uint8_t numBusses = 1, bool buffered = false); // 1D strip of length pixels (type 0: WS2812 RGB) split across busses
+void hostMatrixSetup(uint8_t width, uint8_t height);     // single panel 2D matrix
+void hostStripFrame();                                   // advance clock (at least one frame time) until a frame is shown
+uint64_t hostStripBench(uint8_t mode, unsigned frames);  // render frames of mode on the main segment, returns host ns spent
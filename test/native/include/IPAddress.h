@@ -0,0 +1,43 @@
+#pragma once
+// IPv4 address for the native build
+
+#include <stdint.h>
+#include <stdio.h>
+#include "WString.h"
+
+class IPAddress {
+  public:
+    IPAddress() : _addr(0) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) { _b[0] = a; _b[1] = b; _b[2] = c; _b[3] = d; }
+    IPAddress(uint32_t addr) : _addr(addr) {}
+    IPAddress(const uint8_t *addr) { for (int i = 0; i < 4; i++) _b[i] = addr[i]; }
+
+    operator uint32_t() const { return _addr; }
+    bool operator==(const IPAddress &a) const { return _addr == a._addr; }
+    bool operator==(uint32_t a) const { return _addr == a; }
+    bool operator==(const uint8_t *a) const { return _b[0] == a[0] && _b[1] == a[1] && _b[2] == a[2] && _b[3] == a[3]; }
+    uint8_t operator[](int i) const { return _b[i]; }
+    uint8_t &operator[](int i) { return _b[i]; }
+    IPAddress &operator=(uint32_t a) { _addr = a; return *this; }
+
+    bool fromString(const char *s) {
+      unsigned a, b, c, d;
+      if (sscanf(s, "%u.%u.%u.%u", &a, &b, &c, &d) != 4 || a > 255 || b > 255 || c > 255 || d > 255) return false;
+      _b[0] = a; _b[1] = b; _b[2] = c; _b[3] = d;
+      return true;
+    }
+    bool fromString(const String &s) { return fromString(s.c_str()); }
+    String toString() const {
+      char buf[16];
+      snprintf(buf, sizeof(buf), "%u.%u.%u.%u", _b[0], _b[1], _b[2], _b[3]);
+      return String(buf);
+    }
+
+  private:
+    union {
+      uint8_t  _b[4];
+      uint32_t _addr;
+    };
+};
+
+#define INADDR_NONE IPAddress(0, 0, 0, 0)
@@ -0,0 +1,68 @@
+#pragma once
+// file system for the native build: files live in a host directory (see hostFsRoot())
+
+#include "Arduino.h"
+#include <memory>
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+namespace fs {
+
+class FileImpl;
+typedef std::shared_ptr<FileImpl> FileImplPtr;
+
+class File : public Stream {
+  public:
+    File(FileImplPtr p = FileImplPtr()) : _p(p) {}
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buf, size_t size) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t read(uint8_t *buf, size_t size);
+    size_t readBytes(char *buffer, size_t length) override { return read((uint8_t *)buffer, length); }
+    void flush() override;
+    bool seek(uint32_t pos, SeekMode mode);
+    bool seek(uint32_t pos) { return seek(pos, SeekSet); }
+    size_t position() const;
+    size_t size() const;
+    void close();
+    operator bool() const;
+    const char *name() const;
+    const char *path() const;
+    bool isDirectory() const;
+    File openNextFile(const char *mode = "r");
+    void rewindDirectory();
+  private:
+    FileImplPtr _p;
+};
+
+class FS {
+  public:
+    bool begin(bool formatOnFail = false) { return true; }
+    void end() {}
+    bool format();
+    File open(const char *path, const char *mode = "r", bool create = false);
+    File open(const String &path, const char *mode = "r", bool create = false) { return open(path.c_str(), mode, create); }
+    bool exists(const char *path);
+    bool exists(const String &path) { return exists(path.c_str()); }
+    bool remove(const char *path);
+    bool remove(const String &path) { return remove(path.c_str()); }
+    bool rename(const char *from, const char *to);
+    bool rename(const String &from, const String &to) { return rename(from.c_str(), to.c_str()); }
+    bool mkdir(const char *path);
+    bool rmdir(const char *path);
+    size_t totalBytes() { return 1024*1024; }
+    size_t usedBytes();
+};
+
+} // namespace fs
+
+using fs::FS;
+using fs::File;
+
+extern fs::FS LittleFS;
+
+const char *hostFsRoot();            // directory backing the file system (created on first use)
+void hostFsSetRoot(const char *dir); // use given directory instead
@@ -0,0 +1,161 @@
+#pragma once
+/*
+ * NeoPixelBus stand-in for the native build
+ * Every bus type is an in-memory pixel store: SetPixelColor() applies the luminance like
+ * NeoPixelBusLg does and keeps the dimmed value, GetPixelColor() returns it, Show() only
+ * counts frames. This lets the real bus_manager.cpp / bus_wrapper.h run on the host.
+ * Asynchronous sending can be simulated with hostBusPixelUs: CanShow() is false until the
+ * pixels of the previous Show() would have been sent (host clock, see hostSetTime()).
+ */
+
+#include <stdint.h>
+#include <vector>
+
+unsigned long micros();
+
+struct RgbColor;
+struct RgbwColor;
+
+struct RgbColor {
+  uint8_t R, G, B;
+  RgbColor() : R(0), G(0), B(0) {}
+  RgbColor(uint8_t r, uint8_t g, uint8_t b) : R(r), G(g), B(b) {}
+  RgbColor(uint8_t brightness) : R(brightness), G(brightness), B(brightness) {}
+  inline RgbColor(const RgbwColor &c);
+  RgbColor Dim(uint8_t ratio) const { return RgbColor(dim(R, ratio), dim(G, ratio), dim(B, ratio)); }
+  bool operator==(const RgbColor &o) const { return R == o.R && G == o.G && B == o.B; }
+  static uint8_t dim(uint8_t v, uint8_t ratio) { return (uint16_t(v) * (uint16_t(ratio) + 1)) >> 8; }
+};
+
+struct RgbwColor {
+  uint8_t R, G, B, W;
+  RgbwColor() : R(0), G(0), B(0), W(0) {}
+  RgbwColor(uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0) : R(r), G(g), B(b), W(w) {}
+  RgbwColor(uint8_t brightness) : R(0), G(0), B(0), W(brightness) {}
+  RgbwColor(const RgbColor &c) : R(c.R), G(c.G), B(c.B), W(0) {}
+  RgbwColor Dim(uint8_t ratio) const { return RgbwColor(RgbColor::dim(R, ratio), RgbColor::dim(G, ratio), RgbColor::dim(B, ratio), RgbColor::dim(W, ratio)); }
+  bool operator==(const RgbwColor &o) const { return R == o.R && G == o.G && B == o.B && W == o.W; }
+};
+
+inline RgbColor::RgbColor(const RgbwColor &c) : R(c.R), G(c.G), B(c.B) {}
+
+struct Rgb48Color {
+  uint16_t R, G, B;
+  Rgb48Color() : R(0), G(0), B(0) {}
+  Rgb48Color(uint16_t r, uint16_t g, uint16_t b) : R(r), G(g), B(b) {}
+  Rgb48Color(const RgbColor &c) : R(c.R << 8 | c.R), G(c.G << 8 | c.G), B(c.B << 8 | c.B) {}
+  Rgb48Color Dim(uint8_t ratio) const { return Rgb48Color(dim(R, ratio), dim(G, ratio), dim(B, ratio)); }
+  static uint16_t dim(uint16_t v, uint8_t ratio) { uint32_t r16 = uint32_t(ratio) << 8 | ratio; return (uint32_t(v) * (r16 + 1)) >> 16; }
+};
+
+struct Rgbw64Color {
+  uint16_t R, G, B, W;
+  Rgbw64Color() : R(0), G(0), B(0), W(0) {}
+  Rgbw64Color(uint16_t r, uint16_t g, uint16_t b, uint16_t w) : R(r), G(g), B(b), W(w) {}
+  Rgbw64Color(const RgbwColor &c) : R(c.R << 8 | c.R), G(c.G << 8 | c.G), B(c.B << 8 | c.B), W(c.W << 8 | c.W) {}
+  Rgbw64Color Dim(uint8_t ratio) const { return Rgbw64Color(Rgb48Color::dim(R, ratio), Rgb48Color::dim(G, ratio), Rgb48Color::dim(B, ratio), Rgb48Color::dim(W, ratio)); }
+};
+
+// features only select the color object
+struct NeoRgbFeatureBase    { typedef RgbColor    ColorObject; };
+struct NeoRgbwFeatureBase   { typedef RgbwColor   ColorObject; };
+struct NeoRgb48FeatureBase  { typedef Rgb48Color  ColorObject; };
+struct NeoRgbw64FeatureBase { typedef Rgbw64Color ColorObject; };
+
+struct NeoGrbFeature         : NeoRgbFeatureBase {};
+struct NeoBrgFeature         : NeoRgbFeatureBase {};
+struct NeoRbgFeature         : NeoRgbFeatureBase {};
+struct DotStarBgrFeature     : NeoRgbFeatureBase {};
+struct Lpd6803GrbFeature     : NeoRgbFeatureBase {};
+struct Lpd8806GrbFeature     : NeoRgbFeatureBase {};
+struct P9813BgrFeature       : NeoRgbFeatureBase {};
+struct NeoGrbwFeature        : NeoRgbwFeatureBase {};
+struct NeoWrgbTm1814Feature  : NeoRgbwFeatureBase {};
+struct NeoRgbUcs8903Feature  : NeoRgb48FeatureBase {};
+struct NeoRgbwUcs8904Feature : NeoRgbw64FeatureBase {};
+
+// methods carry no state on the host
+struct NeoGammaNullMethod {};
+struct SpiSpeedHz {};
+template<typename T_SPISPEED> struct TwoWireHspiImple {};
+template<typename T_TWOWIRE> struct Ws2801MethodBase {};
+
+#define NEO_HOST_METHOD(name) struct name {};
+NEO_HOST_METHOD(NeoEsp32RmtNWs2812xMethod)
+NEO_HOST_METHOD(NeoEsp32RmtN400KbpsMethod)
+NEO_HOST_METHOD(NeoEsp32RmtNTm1814Method)
+NEO_HOST_METHOD(NeoEsp32RmtNTm1829Method)
+NEO_HOST_METHOD(NeoEsp32I2s0800KbpsMethod)
+NEO_HOST_METHOD(NeoEsp32I2s1800KbpsMethod)
+NEO_HOST_METHOD(NeoEsp32I2s0400KbpsMethod)
+NEO_HOST_METHOD(NeoEsp32I2s1400KbpsMethod)
+NEO_HOST_METHOD(NeoEsp32I2s0Tm1814Method)
+NEO_HOST_METHOD(NeoEsp32I2s1Tm1814Method)
+NEO_HOST_METHOD(NeoEsp32I2s0Tm1829Method)
+NEO_HOST_METHOD(NeoEsp32I2s1Tm1829Method)
+NEO_HOST_METHOD(NeoEsp32BitBang800KbpsMethod)
+NEO_HOST_METHOD(NeoEsp32BitBang400KbpsMethod)
+NEO_HOST_METHOD(DotStarMethod)
+NEO_HOST_METHOD(DotStarSpiHzMethod)
+NEO_HOST_METHOD(DotStarEsp32HspiHzMethod)
+NEO_HOST_METHOD(Lpd8806Method)
+NEO_HOST_METHOD(Lpd8806SpiHzMethod)
+NEO_HOST_METHOD(Lpd6803Method)
+NEO_HOST_METHOD(Lpd6803SpiHzMethod)
+NEO_HOST_METHOD(Ws2801Method)
+NEO_HOST_METHOD(Ws2801SpiHzMethod)
+NEO_HOST_METHOD(P9813Method)
+NEO_HOST_METHOD(P9813SpiHzMethod)
+#undef NEO_HOST_METHOD
+
+enum NeoBusChannel { NeoBusChannel_0, NeoBusChannel_1, NeoBusChannel_2, NeoBusChannel_3,
+                     NeoBusChannel_4, NeoBusChannel_5, NeoBusChannel_6, NeoBusChannel_7 };
+
+struct NeoSpiSettings {
+  uint32_t Clock;
+  NeoSpiSettings(uint32_t clock) : Clock(clock) {}
+};
+
+struct NeoTm1814Settings {
+  uint16_t RedCurrent, GreenCurrent, BlueCurrent, WhiteCurrent;
+  NeoTm1814Settings(uint16_t r, uint16_t g, uint16_t b, uint16_t w) : RedCurrent(r), GreenCurrent(g), BlueCurrent(b), WhiteCurrent(w) {}
+};
+
+// number of Show() calls across all busses, lets tests assert on output frames
+extern uint32_t hostBusShowCount;
+// simulated time (us) to send one pixel after Show() (0: busses can always show)
+extern uint32_t hostBusPixelUs;
+
+template<typename T_COLOR_FEATURE, typename T_METHOD, typename T_GAMMA = NeoGammaNullMethod>
+class NeoPixelBusLg {
+  public:
+    typedef typename T_COLOR_FEATURE::ColorObject ColorObject;
+
+    NeoPixelBusLg(uint16_t countPixels, uint8_t pin) : _pixels(countPixels) {}
+    NeoPixelBusLg(uint16_t countPixels, uint8_t pin, NeoBusChannel channel) : _pixels(countPixels) {}
+    NeoPixelBusLg(uint16_t countPixels, uint8_t pinClock, uint8_t pinData) : _pixels(countPixels) {}
+
+    void Begin() {}
+    void Begin(int8_t sck, int8_t miso, int8_t mosi, int8_t ss) {}
+    void Show(bool maintainBufferConsistency = true) { hostBusShowCount++; _sendEnd = micros() + _pixels.size() * hostBusPixelUs; }
+    bool CanShow() const { return !hostBusPixelUs || (int32_t)(uint32_t(micros()) - _sendEnd) >= 0; }
+    bool IsDirty() const { return true; }
+    uint16_t PixelCount() const { return _pixels.size(); }
+
+    void SetMethodSettings(const NeoSpiSettings &) {}
+    void SetPixelSettings(const NeoTm1814Settings &) {}
+    void SetLuminance(uint8_t luminance) { _luminance = luminance; }
+    uint8_t GetLuminance() const { return _luminance; }
+
+    void SetPixelColor(uint16_t indexPixel, const ColorObject &color) {
+      if (indexPixel < _pixels.size()) _pixels[indexPixel] = color.Dim(_luminance);
+    }
+    ColorObject GetPixelColor(uint16_t indexPixel) const {
+      return indexPixel < _pixels.size() ? _pixels[indexPixel] : ColorObject();
+    }
+
+  private:
+    std::vector<ColorObject> _pixels;
+    uint8_t _luminance = 255;
+    uint32_t _sendEnd = 0; // micros() when previous Show() has been sent
+};
@@ -0,0 +1,96 @@
+#pragma once
+// Print and Stream for the native build
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include "WString.h"
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class Print;
+
+class Printable {
+  public:
+    virtual ~Printable() {}
+    virtual size_t printTo(Print &p) const = 0;
+};
+
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buf, size_t size) {
+      size_t n = 0;
+      while (size--) n += write(*buf++);
+      return n;
+    }
+    size_t write(const char *s) { return s ? write((const uint8_t *)s, strlen(s)) : 0; }
+    size_t write(const char *buf, size_t size) { return write((const uint8_t *)buf, size); }
+    virtual void flush() {}
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3))) {
+      char buf[256];
+      va_list args;
+      va_start(args, format);
+      int len = vsnprintf(buf, sizeof(buf), format, args);
+      va_end(args);
+      if (len < 0) return 0;
+      if ((size_t)len >= sizeof(buf)) len = sizeof(buf) - 1;
+      return write((const uint8_t *)buf, len);
+    }
+
+    size_t print(const __FlashStringHelper *s) { return write(reinterpret_cast<const char *>(s)); }
+    size_t print(const String &s) { return write(s.c_str()); }
+    size_t print(const char *s) { return write(s); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char v, int base = DEC) { return print((unsigned long)v, base); }
+    size_t print(int v, int base = DEC) { return print((long)v, base); }
+    size_t print(unsigned int v, int base = DEC) { return print((unsigned long)v, base); }
+    size_t print(long v, int base = DEC) { return write(String((long long)v, base).c_str()); }
+    size_t print(unsigned long v, int base = DEC) { return write(String((unsigned long long)v, base).c_str()); }
+    size_t print(long long v, int base = DEC) { return write(String(v, base).c_str()); }
+    size_t print(unsigned long long v, int base = DEC) { return write(String(v, base).c_str()); }
+    size_t print(double v, int digits = 2) { return write(String(v, digits).c_str()); }
+
+    size_t print(const Printable &x) { return x.printTo(*this); }
+
+    size_t println() { return write("\r\n"); }
+    template<typename T> size_t println(T v) { size_t n = print(v); return n + println(); }
+    template<typename T> size_t println(T v, int f) { size_t n = print(v, f); return n + println(); }
+};
+
+class Stream : public Print {
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    void setTimeout(unsigned long timeout) { _timeout = timeout; }
+    virtual size_t readBytes(char *buffer, size_t length) {
+      size_t n = 0;
+      while (n < length) { int c = read(); if (c < 0) break; buffer[n++] = (char)c; }
+      return n;
+    }
+    size_t readBytes(uint8_t *buffer, size_t length) { return readBytes((char *)buffer, length); }
+    bool find(const char *target) { return findUntil(target, nullptr); }
+    bool find(const char *target, size_t length) { (void)length; return find(target); }
+    bool findUntil(const char *target, const char *terminator) {
+      size_t tlen = strlen(target), tpos = 0, xpos = 0, xlen = terminator ? strlen(terminator) : 0;
+      if (!tlen) return true;
+      int c;
+      while ((c = read()) >= 0) {
+        if (c == target[tpos]) { if (++tpos == tlen) return true; }
+        else tpos = (c == target[0]) ? 1 : 0;
+        if (xlen) { if (c == terminator[xpos]) { if (++xpos == xlen) return false; } else xpos = 0; }
+      }
+      return false;
+    }
+    String readString() { String s; int c; while ((c = read()) >= 0) s += (char)c; return s; }
+  protected:
+    unsigned long _timeout = 1000;
+};
@@ -0,0 +1,20 @@
+#pragma once
+// SPI for the native build (no-op)
+#include "Arduino.h"
+#define SPI_MODE0 0
+#define MSBFIRST 1
+class SPISettings {
+  public:
+    SPISettings(uint32_t = 1000000, uint8_t = MSBFIRST, uint8_t = SPI_MODE0) {}
+};
+class SPIClass {
+  public:
+    void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) {}
+    void end() {}
+    void beginTransaction(SPISettings) {}
+    void endTransaction() {}
+    uint8_t transfer(uint8_t d) { return 0; }
+    void transferBytes(const uint8_t *, uint8_t *, uint32_t) {}
+    void writeBytes(const uint8_t *, uint32_t) {}
+};
+extern SPIClass SPI;
@@ -0,0 +1,9 @@
+#pragma once
+// file editor handler for the native build (not served)
+#include "ESPAsyncWebServer.h"
+#include "LittleFS.h"
+class SPIFFSEditor : public AsyncWebHandler {
+  public:
+    SPIFFSEditor(const String & = String(), const String & = String(), fs::FS & = LittleFS) {}
+    SPIFFSEditor(const fs::FS &, const String & = String(), const String & = String()) {}
+};
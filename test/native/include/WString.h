@@ -0,0 +1,131 @@
+#pragma once
+// Arduino String for the native build (backed by std::string)
+
+#include <string>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+class __FlashStringHelper;
+
+class String {
+  public:
+    String() {}
+    String(const char *s) : _s(s ? s : "") {}
+    String(const char *s, size_t len) : _s(s, len) {}
+    String(const __FlashStringHelper *s) : _s(s ? reinterpret_cast<const char *>(s) : "") {}
+    String(const std::string &s) : _s(s) {}
+    String(char c) : _s(1, c) {}
+    String(unsigned char v, unsigned char base = 10) { fromULong(v, base); }
+    String(int v, unsigned char base = 10) { fromLong(v, base); }
+    String(unsigned int v, unsigned char base = 10) { fromULong(v, base); }
+    String(long v, unsigned char base = 10) { fromLong(v, base); }
+    String(unsigned long v, unsigned char base = 10) { fromULong(v, base); }
+    String(long long v, unsigned char base = 10) { fromLong(v, base); }
+    String(unsigned long long v, unsigned char base = 10) { fromULong(v, base); }
+    String(float v, unsigned char decimals = 2) { fromDouble(v, decimals); }
+    String(double v, unsigned char decimals = 2) { fromDouble(v, decimals); }
+
+    const char *c_str() const { return _s.c_str(); }
+    unsigned int length() const { return _s.length(); }
+    bool isEmpty() const { return _s.empty(); }
+    bool reserve(unsigned int size) { _s.reserve(size); return true; }
+    void clear() { _s.clear(); }
+
+    bool concat(const String &s) { _s += s._s; return true; }
+    bool concat(const char *s) { if (s) _s += s; return true; }
+    bool concat(const char *s, unsigned int len) { if (s) _s.append(s, len); return true; }
+    bool concat(char c) { _s += c; return true; }
+    bool concat(const __FlashStringHelper *s) { return concat(reinterpret_cast<const char *>(s)); }
+    template<typename T> bool concat(T v) { return concat(String(v)); }
+
+    String &operator+=(const String &s) { concat(s); return *this; }
+    String &operator+=(const char *s) { concat(s); return *this; }
+    String &operator+=(char c) { concat(c); return *this; }
+    String &operator+=(const __FlashStringHelper *s) { concat(s); return *this; }
+    template<typename T> String &operator+=(T v) { concat(String(v)); return *this; }
+
+    friend String operator+(const String &a, const String &b) { String r(a); r.concat(b); return r; }
+    friend String operator+(const String &a, const char *b) { String r(a); r.concat(b); return r; }
+    friend String operator+(const char *a, const String &b) { String r(a); r.concat(b); return r; }
+    friend String operator+(const String &a, char b) { String r(a); r.concat(b); return r; }
+    friend String operator+(const String &a, const __FlashStringHelper *b) { String r(a); r.concat(b); return r; }
+    template<typename T> friend String operator+(const String &a, T b) { String r(a); r.concat(String(b)); return r; }
+
+    bool operator==(const String &s) const { return _s == s._s; }
+    bool operator==(const char *s) const { return _s == (s ? s : ""); }
+    bool operator!=(const String &s) const { return !(*this == s); }
+    bool operator!=(const char *s) const { return !(*this == s); }
+    bool operator<(const String &s) const { return _s < s._s; }
+    bool equals(const String &s) const { return *this == s; }
+    bool equals(const char *s) const { return *this == s; }
+    bool equalsIgnoreCase(const String &s) const { return strcasecmp(c_str(), s.c_str()) == 0; }
+    explicit operator bool() const { return true; }
+
+    char charAt(unsigned int i) const { return i < _s.length() ? _s[i] : 0; }
+    char operator[](unsigned int i) const { return charAt(i); }
+    char &operator[](unsigned int i) { return _s[i]; }
+    void setCharAt(unsigned int i, char c) { if (i < _s.length()) _s[i] = c; }
+
+    int indexOf(char c, unsigned int from = 0) const { size_t p = _s.find(c, from); return p == std::string::npos ? -1 : (int)p; }
+    int indexOf(const String &s, unsigned int from = 0) const { size_t p = _s.find(s._s, from); return p == std::string::npos ? -1 : (int)p; }
+    int indexOf(const char *s, unsigned int from = 0) const { size_t p = _s.find(s, from); return p == std::string::npos ? -1 : (int)p; }
+    int lastIndexOf(char c) const { size_t p = _s.rfind(c); return p == std::string::npos ? -1 : (int)p; }
+    int lastIndexOf(const String &s) const { size_t p = _s.rfind(s._s); return p == std::string::npos ? -1 : (int)p; }
+    bool startsWith(const String &s) const { return _s.compare(0, s._s.length(), s._s) == 0; }
+    bool startsWith(const char *s) const { return startsWith(String(s)); }
+    bool endsWith(const String &s) const { return _s.length() >= s._s.length() && _s.compare(_s.length() - s._s.length(), s._s.length(), s._s) == 0; }
+    bool endsWith(const char *s) const { return endsWith(String(s)); }
+    String substring(unsigned int from) const { return from < _s.length() ? String(_s.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+      if (from > to) std::swap(from, to);
+      if (from >= _s.length()) return String();
+      return String(_s.substr(from, to - from));
+    }
+    void replace(const String &find, const String &repl) {
+      if (find._s.empty()) return;
+      size_t p = 0;
+      while ((p = _s.find(find._s, p)) != std::string::npos) { _s.replace(p, find._s.length(), repl._s); p += repl._s.length(); }
+    }
+    void remove(unsigned int index) { if (index < _s.length()) _s.erase(index); }
+    void remove(unsigned int index, unsigned int count) { if (index < _s.length()) _s.erase(index, count); }
+    void toLowerCase() { for (auto &c : _s) c = tolower(c); }
+    void toUpperCase() { for (auto &c : _s) c = toupper(c); }
+    void trim() {
+      size_t b = _s.find_first_not_of(" \t\r\n");
+      size_t e = _s.find_last_not_of(" \t\r\n");
+      _s = b == std::string::npos ? std::string() : _s.substr(b, e - b + 1);
+    }
+    long toInt() const { return atol(c_str()); }
+    float toFloat() const { return atof(c_str()); }
+    void toCharArray(char *buf, unsigned int size, unsigned int index = 0) const {
+      if (!size || !buf) return;
+      size_t n = index < _s.length() ? std::min<size_t>(size - 1, _s.length() - index) : 0;
+      if (n) memcpy(buf, _s.data() + index, n);
+      buf[n] = 0;
+    }
+    void getBytes(unsigned char *buf, unsigned int size, unsigned int index = 0) const { toCharArray((char *)buf, size, index); }
+
+  private:
+    std::string _s;
+    void fromLong(long long v, unsigned char base) {
+      if (base == 10) _s = std::to_string(v);
+      else if (v < 0) { fromULong(-v, base); _s.insert(0, 1, '-'); }
+      else fromULong(v, base);
+    }
+    void fromULong(unsigned long long v, unsigned char base) {
+      if (base == 10) { _s = std::to_string(v); return; }
+      char buf[66]; int i = 65; buf[i] = 0;
+      do { unsigned d = v % base; buf[--i] = d < 10 ? '0' + d : 'a' + d - 10; v /= base; } while (v);
+      _s = &buf[i];
+    }
+    void fromDouble(double v, unsigned char decimals) {
+      char buf[64]; snprintf(buf, sizeof(buf), "%.*f", decimals, v); _s = buf;
+    }
+};
+
+class StringSumHelper : public String {
+  public:
+    StringSumHelper(const String &s) : String(s) {}
+    StringSumHelper(const char *p) : String(p) {}
+};
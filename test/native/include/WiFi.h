@@ -0,0 +1,58 @@
+#pragma once
+// WiFi for the native build: always connected to a fixed network (192.168.1.100/24)
+
+#include "Arduino.h"
+
+typedef enum {
+  WL_NO_SHIELD = 255, WL_IDLE_STATUS = 0, WL_NO_SSID_AVAIL, WL_SCAN_COMPLETED,
+  WL_CONNECTED, WL_CONNECT_FAILED, WL_CONNECTION_LOST, WL_DISCONNECTED
+} wl_status_t;
+
+typedef enum { WIFI_OFF = 0, WIFI_STA, WIFI_AP, WIFI_AP_STA } wifi_mode_t;
+typedef int WiFiEvent_t;
+typedef enum { WIFI_AUTH_OPEN = 0, WIFI_AUTH_WEP, WIFI_AUTH_WPA_PSK, WIFI_AUTH_WPA2_PSK } wifi_auth_mode_t;
+#define WIFI_MODE_NULL WIFI_OFF
+#define WIFI_MODE_STA  WIFI_STA
+#define WIFI_MODE_AP   WIFI_AP
+#define WIFI_MODE_APSTA WIFI_AP_STA
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED  (-2)
+
+class WiFiClass {
+  public:
+    wl_status_t status() { return WL_CONNECTED; }
+    IPAddress localIP() { return _ip; }
+    IPAddress subnetMask() { return IPAddress(255, 255, 255, 0); }
+    IPAddress gatewayIP() { return IPAddress(192, 168, 1, 1); }
+    IPAddress dnsIP(uint8_t n = 0) { return gatewayIP(); }
+    IPAddress softAPIP() { return IPAddress(4, 3, 2, 1); }
+    IPAddress broadcastIP() { return IPAddress(192, 168, 1, 255); }
+    String macAddress() { return String("AA:BB:CC:DD:EE:FF"); }
+    uint8_t *macAddress(uint8_t *mac) { static const uint8_t m[6] = {0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF}; memcpy(mac, m, 6); return mac; }
+    String softAPmacAddress() { return macAddress(); }
+    String SSID() { return String("host"); }
+    String BSSIDstr() { return String("00:00:00:00:00:00"); }
+    int8_t RSSI() { return -50; }
+    int32_t channel() { return 1; }
+    bool isConnected() { return true; }
+    wifi_mode_t getMode() { return WIFI_STA; }
+    bool mode(wifi_mode_t) { return true; }
+    bool setSleep(bool) { return true; }
+    bool disconnect(bool = false, bool = false) { return true; }
+    bool softAPdisconnect(bool = false) { return true; }
+    uint8_t softAPgetStationNum() { return 0; }
+    bool hostByName(const char *host, IPAddress &ip) { return ip.fromString(host); }
+    int scanComplete() { return WIFI_SCAN_FAILED; }
+    int16_t scanNetworks(bool async = false) { return WIFI_SCAN_FAILED; }
+    void scanDelete() {}
+    String SSID(uint8_t) { return SSID(); }
+    int32_t RSSI(uint8_t) { return RSSI(); }
+    String BSSIDstr(uint8_t) { return BSSIDstr(); }
+    int32_t channel(uint8_t) { return channel(); }
+    uint8_t encryptionType(uint8_t) { return 0; }
+    void hostSetLocalIP(IPAddress ip) { _ip = ip; }
+  private:
+    IPAddress _ip = IPAddress(192, 168, 1, 100);
+};
+
+extern WiFiClass WiFi;
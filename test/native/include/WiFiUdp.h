@@ -0,0 +1,42 @@
+#pragma once
+// UDP for the native build: all sockets share an in-process loopback network (see HostNet.h)
+
+#include "Arduino.h"
+#include <vector>
+
+class WiFiUDP : public Stream {
+  public:
+    uint8_t begin(uint16_t port) { _port = port; return 1; }
+    uint8_t begin(IPAddress, uint16_t port) { return begin(port); }
+    uint8_t beginMulticast(IPAddress, uint16_t port) { return begin(port); }
+    void stop() { _port = 0; }
+    int beginPacket(IPAddress ip, uint16_t port) { _txIP = ip; _txPort = port; _tx.clear(); return 1; }
+    int beginPacket(const char *host, uint16_t port) { IPAddress ip; ip.fromString(host); return beginPacket(ip, port); }
+    int beginMulticastPacket() { return 1; }
+    int endPacket();
+    size_t write(uint8_t c) override { _tx.push_back(c); return 1; }
+    size_t write(const uint8_t *buf, size_t size) override { size_t n = _tx.size(); _tx.resize(n + size); if (size) memcpy(&_tx[n], buf, size); return size; }
+    int parsePacket();
+    int available() override { return _rx.size() - _rxPos; }
+    int read() override { return _rxPos < _rx.size() ? _rx[_rxPos++] : -1; }
+    int read(unsigned char *buf, size_t len) {
+      size_t n = std::min(len, _rx.size() - _rxPos);
+      memcpy(buf, _rx.data() + _rxPos, n);
+      _rxPos += n;
+      return n;
+    }
+    int read(char *buf, size_t len) { return read((unsigned char *)buf, len); }
+    int peek() override { return _rxPos < _rx.size() ? _rx[_rxPos] : -1; }
+    void flush() override { _rxPos = _rx.size(); }
+    IPAddress remoteIP() { return _rxIP; }
+    uint16_t remotePort() { return _rxPort; }
+  private:
+    uint16_t _port = 0;
+    IPAddress _txIP;
+    uint16_t _txPort = 0;
+    std::vector<uint8_t> _tx;
+    std::vector<uint8_t> _rx;
+    size_t _rxPos = 0;
+    IPAddress _rxIP;
+    uint16_t _rxPort = 0;
+};
@@ -0,0 +1,16 @@
+#pragma once
+// I2C for the native build (no-op)
+#include "Arduino.h"
+class TwoWire {
+  public:
+    bool begin(int8_t sda = -1, int8_t scl = -1, uint32_t freq = 0) { return true; }
+    void setClock(uint32_t) {}
+    bool setPins(int8_t sda, int8_t scl) { return true; }
+    void beginTransmission(uint8_t) {}
+    uint8_t endTransmission(bool = true) { return 2; }
+    size_t write(uint8_t) { return 1; }
+    uint8_t requestFrom(uint8_t, uint8_t) { return 0; }
+    int available() { return 0; }
+    int read() { return -1; }
+};
+extern TwoWire Wire;
@@ -0,0 +1,8 @@
+#pragma once
+// task watchdog for the native build (no-op)
+#include <stdint.h>
+typedef int esp_err_t;
+static inline esp_err_t esp_task_wdt_init(uint32_t, bool) { return 0; }
+static inline esp_err_t esp_task_wdt_add(void *) { return 0; }
+static inline esp_err_t esp_task_wdt_delete(void *) { return 0; }
+static inline esp_err_t esp_task_wdt_reset() { return 0; }
@@ -0,0 +1,5 @@
+#pragma once
+// ESP-IDF WiFi driver for the native build (not used)
+#include <stdint.h>
+typedef int esp_err_t;
+#define ESP_OK 0
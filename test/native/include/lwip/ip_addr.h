@@ -0,0 +1,7 @@
+#pragma once
+// lwIP address types for the native build
+#include <stdint.h>
+#include <arpa/inet.h> // htonl/htons, provided by lwIP on the device
+typedef struct ip4_addr { uint32_t addr; } ip4_addr_t;
+typedef ip4_addr_t ip_addr_t;
+#define LWIP_VERSION_MAJOR 2
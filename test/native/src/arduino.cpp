@@ -0,0 +1,192 @@
+/*
+ * Arduino/ESP32 core functions for the native build
+ */
+#include <Arduino.h>
+#include <WiFi.h>
+#include <ETH.h>
+#include <ESPmDNS.h>
+#include <Wire.h>
+#include <SPI.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <thread>
+
+HardwareSerial Serial;
+EspClass ESP;
+WiFiClass WiFi;
+ETHClass ETH;
+MDNSResponder MDNS;
+TwoWire Wire;
+SPIClass SPI;
+
+// time
+
+static const auto hostStart = std::chrono::steady_clock::now();
+static bool     hostTimeFrozen = false;
+static uint64_t hostFrozenUs = 0;
+
+uint64_t micros64() {
+  if (hostTimeFrozen) return hostFrozenUs;
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - hostStart).count();
+}
+unsigned long micros() { return (unsigned long)(uint32_t)micros64(); }
+unsigned long millis() { return (unsigned long)(uint32_t)(micros64() / 1000); }
+int64_t esp_timer_get_time() { return micros64(); }
+
+void hostSetTime(uint64_t us) { hostTimeFrozen = true; hostFrozenUs = us; }
+void hostAdvanceTime(uint64_t us) {
+  if (!hostTimeFrozen) hostSetTime(micros64());
+  hostFrozenUs += us;
+}
+void hostRealTime() { hostTimeFrozen = false; }
+
+void delay(unsigned long ms) {
+  if (hostTimeFrozen) hostFrozenUs += ms * 1000ULL;
+  else std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+void delayMicroseconds(unsigned int us) {
+  if (hostTimeFrozen) hostFrozenUs += us;
+  else std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+void yield() {}
+
+uint32_t EspClass::getCycleCount() { return (uint32_t)(micros64() * getCpuFreqMHz()); }
+
+// random numbers (fixed seed so benchmark runs are repeatable)
+
+static std::mt19937 hostRng(0x574C4544);
+
+long random(long howbig) { return howbig > 0 ? (long)(hostRng() % (uint32_t)howbig) : 0; }
+long random(long howsmall, long howbig) { return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall); }
+void randomSeed(unsigned long seed) { if (seed) hostRng.seed(seed); }
+uint32_t esp_random() { return hostRng(); }
+
+long map(long x, long in_min, long in_max, long out_min, long out_max) {
+  const long dividend = out_max - out_min;
+  const long divisor = in_max - in_min;
+  const long delta = x - in_min;
+  if (divisor == 0) return -1;
+  return (delta * dividend + (divisor / 2)) / divisor + out_min;
+}
+
+size_t strlcpy(char *dst, const char *src, size_t size) {
+  size_t len = strlen(src);
+  if (size) {
+    size_t n = len >= size ? size - 1 : len;
+    memcpy(dst, src, n);
+    dst[n] = 0;
+  }
+  return len;
+}
+size_t strlcat(char *dst, const char *src, size_t size) {
+  size_t dlen = strnlen(dst, size);
+  if (dlen == size) return size + strlen(src);
+  return dlen + strlcpy(dst + dlen, src, size - dlen);
+}
+
+char *ultoa(unsigned long value, char *str, int base) {
+  char buf[8 * sizeof(long) + 1];
+  int i = 0;
+  do { unsigned d = value % base; buf[i++] = d < 10 ? '0' + d : 'a' + d - 10; value /= base; } while (value);
+  for (int j = 0; j < i; j++) str[j] = buf[i - 1 - j];
+  str[i] = 0;
+  return str;
+}
+char *ltoa(long value, char *str, int base) {
+  if (value < 0 && base == 10) { str[0] = '-'; ultoa(-(unsigned long)value, str + 1, base); return str; }
+  return ultoa((unsigned long)value, str, base);
+}
+char *utoa(unsigned value, char *str, int base) { return ultoa(value, str, base); }
+char *itoa(int value, char *str, int base) { return base == 10 ? ltoa(value, str, base) : ultoa((unsigned)value, str, base); }
+char *dtostrf(double val, signed char width, unsigned char prec, char *sout) { sprintf(sout, "%*.*f", width, prec, val); return sout; }
+
+// GPIO, PWM and ADC
+
+void pinMode(uint8_t pin, uint8_t mode) {}
+void digitalWrite(uint8_t pin, uint8_t val) {}
+int digitalRead(uint8_t pin) { return HIGH; }
+int analogRead(uint8_t pin) { return 0; }
+void analogWrite(uint8_t pin, int val) {}
+double ledcSetup(uint8_t channel, double freq, uint8_t resolution_bits) { return freq; }
+void ledcWrite(uint8_t channel, uint32_t duty) {}
+void ledcAttachPin(uint8_t pin, uint8_t channel) {}
+void ledcDetachPin(uint8_t pin) {}
+bool digitalPinIsValid(int8_t pin) { return pin >= 0 && pin < 40; }
+
+// memory
+
+bool psramFound() { return false; }
+void *ps_malloc(size_t size) { return malloc(size); }
+void *ps_calloc(size_t n, size_t size) { return calloc(n, size); }
+void *ps_realloc(void *ptr, size_t size) { return realloc(ptr, size); }
+size_t heap_caps_get_free_size(uint32_t caps) { return ESP.getFreeHeap(); }
+size_t heap_caps_get_largest_free_block(uint32_t caps) { return ESP.getMaxAllocHeap(); }
+
+// FreeRTOS: tasks are threads, all critical sections share one (nesting) lock
+
+static std::recursive_mutex hostCritical;
+void vPortEnterCritical(portMUX_TYPE *mux) { hostCritical.lock(); mux->count++; }
+void vPortExitCritical(portMUX_TYPE *mux) { if (mux->count) { mux->count--; hostCritical.unlock(); } }
+
+struct HostSemaphore {
+  std::mutex m;
+  std::condition_variable cv;
+  unsigned count = 0;
+};
+
+struct HostTask {
+  HostSemaphore notify;
+  std::thread thread;
+  BaseType_t core;
+};
+
+static BaseType_t hostTake(HostSemaphore *s, TickType_t wait, bool clear) {
+  std::unique_lock<std::mutex> lock(s->m);
+  if (wait == portMAX_DELAY) s->cv.wait(lock, [s] { return s->count > 0; });
+  else if (!s->cv.wait_for(lock, std::chrono::milliseconds(wait), [s] { return s->count > 0; })) return 0;
+  unsigned n = s->count;
+  s->count = clear ? 0 : n - 1;
+  return n;
+}
+
+static void hostGive(HostSemaphore *s, unsigned max) {
+  std::lock_guard<std::mutex> lock(s->m);
+  if (s->count < max) s->count++;
+  s->cv.notify_one();
+}
+
+static thread_local HostTask *hostCurrentTask = nullptr;
+
+BaseType_t xPortGetCoreID() { return hostCurrentTask ? hostCurrentTask->core : CONFIG_FREERTOS_UNICORE ? 0 : 1; } // loop() runs on core 1
+
+void vTaskDelay(TickType_t ticks) { delay(ticks * portTICK_PERIOD_MS); }
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack, void *param, UBaseType_t prio, TaskHandle_t *handle, BaseType_t core) {
+  HostTask *task = new HostTask;
+  task->core = core;
+  if (handle) *handle = task;
+  task->thread = std::thread([task, fn, param] { hostCurrentTask = task; fn(param); });
+  task->thread.detach();
+  return pdPASS;
+}
+void vTaskDelete(TaskHandle_t handle) {} // tasks of the engine never end
+void xTaskNotifyGive(TaskHandle_t handle) { hostGive(&static_cast<HostTask *>(handle)->notify, UINT32_MAX); }
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait) { return hostCurrentTask ? hostTake(&hostCurrentTask->notify, wait, clear) : 0; }
+
+SemaphoreHandle_t xSemaphoreCreateBinary() { return new HostSemaphore; }
+SemaphoreHandle_t xSemaphoreCreateMutex() { HostSemaphore *s = new HostSemaphore; s->count = 1; return s; }
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t wait) { return hostTake(static_cast<HostSemaphore *>(sem), wait, false) ? pdTRUE : pdFALSE; }
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) { hostGive(static_cast<HostSemaphore *>(sem), 1); return pdTRUE; }
+void vSemaphoreDelete(SemaphoreHandle_t sem) { delete static_cast<HostSemaphore *>(sem); }
+
+// NeoPixelBus
+
+uint32_t hostBusShowCount = 0;
+uint32_t hostBusPixelUs = 0;
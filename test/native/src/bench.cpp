@@ -0,0 +1,322 @@
+/*
+ * Effect benchmark of the native build
+ * Renders every effect on a 300 and a 1024 pixel strip and a 64x64 matrix and prints the
+ * host time per frame and pixel throughput, then a few effects on grouped, mirrored,
+ * reversed and ledmapped segments, palette heavy effects, the color math of colors.cpp, preset
+ * lookup in presets.json, the ABL power estimate and realtime ingest (E1.31, Art-Net, DDP, Adalight). Absolute numbers depend on the host, compare runs of
+ * the same binary (before/after a change) only.
+ *
+ * pio run -e native && .pio/build/native/program [frames]
+ * pio run -e native_nolut && .pio/build/native_nolut/program [frames]   (without palette table, WLED_DISABLE_PALETTE_LUT)
+ */
+#ifndef PIO_UNIT_TESTING
+#include "wled.h"
+#include <HostStrip.h>
+#include <ColorsRef.h>
+
+#include <chrono>
+
+static void benchEffects(const char *layout, unsigned frames) {
+  uint16_t len = strip.getLengthTotal();
+  printf("\n%s (%u pixels, %u frames per effect)\n", layout, len, frames);
+  printf("%3s  %-24s %12s %14s\n", "id", "effect", "us/frame", "pixels/s");
+  uint64_t totalNs = 0;
+  for (uint8_t m = 0; m < strip.getModeCount(); m++) {
+    char name[25];
+    extractModeName(m, JSON_mode_names, name, sizeof(name));
+    if (!strncmp_P(name, PSTR("RSVD"), 4)) continue;
+    uint64_t ns = hostStripBench(m, frames);
+    totalNs += ns;
+    double usPerFrame = ns / 1000.0 / frames;
+    printf("%3u  %-24s %12.2f %14.0f\n", m, name, usPerFrame, len * 1e6 / usPerFrame);
+  }
+  printf("%3s  %-24s %12.2f\n", "", "all effects", totalNs / 1000.0 / frames);
+}
+
+// segment mapping (grouping, spacing, mirror, reverse/offset, ledmap) with direct strip writes and segment frame buffers,
+// each with per-pixel index math (useMappingPlans off) and with compiled mapping plan
+static void benchMapping(unsigned frames) {
+  static const struct { const char *name; uint8_t grp, spc; bool mirror, reverse; uint16_t ofs; bool ledmap; } variants[] = {
+    {"plain",               1, 0, false, false,   0, false},
+    {"grouping 3 spacing 1",3, 1, false, false,   0, false},
+    {"mirror",              1, 0, true,  false,   0, false},
+    {"reverse offset 100",  1, 0, false, true,  100, false},
+    {"ledmap",              1, 0, false, false,   0, true },
+    {"grouping 2 mirror ledmap", 2, 0, true, false, 0, true },
+  };
+  static const uint8_t modes[] = {FX_MODE_RAINBOW_CYCLE, FX_MODE_RUNNING_LIGHTS, FX_MODE_FILLNOISE8};
+
+  hostStripSetup(1024);
+  const uint16_t len = strip.getLengthTotal();
+  printf("\nsegment mapping (%u pixels, %u frames per effect)\n", len, frames);
+  printf("%-26s %-16s %12s %12s %12s %12s\n", "segment", "effect", "direct us", "direct plan", "buffered us", "buf. plan");
+  for (const auto &v : variants) {
+    if (v.ledmap) { // reversed order, written like a user supplied ledmap.json
+      File f = WLED_FS.open("/ledmap.json", "w");
+      f.print("{\"map\":[");
+      for (int i = 0; i < len; i++) f.printf(i ? ",%d" : "%d", len - 1 - i);
+      f.print("]}");
+      f.close();
+    } else {
+      WLED_FS.remove("/ledmap.json");
+    }
+    strip.deserializeMap(0);
+    Segment &seg = strip.getMainSegment();
+    seg.setUp(0, len, v.grp, v.spc, v.ofs, 0, 1);
+    seg.mirror  = v.mirror;
+    seg.reverse = v.reverse;
+    for (uint8_t m : modes) {
+      char name[17];
+      extractModeName(m, JSON_mode_names, name, sizeof(name));
+      double us[4];
+      for (int buffered = 0; buffered < 2; buffered++) for (int plan = 0; plan < 2; plan++) {
+        useSegmentBuffers = buffered;
+        useMappingPlans   = plan;
+        us[buffered * 2 + plan] = hostStripBench(m, frames) / 1000.0 / frames;
+      }
+      printf("%-26s %-16s %12.2f %12.2f %12.2f %12.2f\n", v.name, name, us[0], us[1], us[2], us[3]);
+    }
+  }
+  WLED_FS.remove("/ledmap.json");
+  strip.deserializeMap(0);
+  useSegmentBuffers = true;
+  useMappingPlans   = true;
+}
+
+// effects doing a palette lookup per pixel (color_from_palette()), with palette blending and without (NOBLEND)
+static void benchPalettes(unsigned frames) {
+  static const uint8_t modes[] = {FX_MODE_COLORWAVES, FX_MODE_PACIFICA, FX_MODE_NOISE16_1};
+  static const uint8_t palettes[] = {3, 6, 11, 40}; // colors 1&2, party, rainbow, a gradient palette
+
+  hostStripSetup(1024);
+  const uint16_t len = strip.getLengthTotal();
+#ifdef WLED_PALETTE_LUT
+  printf("\npalette lookup with palette table (%u pixels, %u frames per effect)\n", len, frames);
+#else
+  printf("\npalette lookup without palette table (%u pixels, %u frames per effect)\n", len, frames);
+#endif
+  printf("%-16s %-24s %12s %12s\n", "effect", "palette", "blend us", "noblend us");
+  Segment &seg = strip.getMainSegment();
+  for (uint8_t m : modes) for (uint8_t pal : palettes) {
+    char name[17], palName[25];
+    extractModeName(m, JSON_mode_names, name, sizeof(name));
+    extractModeName(pal, JSON_palette_names, palName, sizeof(palName));
+    seg.setPalette(pal);
+    double us[2];
+    for (int noblend = 0; noblend < 2; noblend++) {
+      strip.paletteBlend = noblend ? 3 : 0;
+      us[noblend] = hostStripBench(m, frames) / 1000.0 / frames;
+    }
+    printf("%-16s %-24s %12.2f %12.2f\n", name, palName, us[0], us[1]);
+  }
+  strip.paletteBlend = 0;
+  seg.setPalette(0);
+}
+
+// color_blend/add/fade (packed channel math) against the per-channel reference, single calls and _span() variants
+static uint32_t benchSink;
+
+template <typename F> static double benchColorNs(F fn, uint32_t *buf, const uint32_t *src, size_t len, unsigned reps) {
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned r = 0; r < reps; r++) fn(buf, src, len, r);
+  double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+  benchSink += buf[len / 2];
+  return ns / reps / len;
+}
+
+static void benchColors(unsigned frames) {
+  const size_t len = 1024;
+  const unsigned reps = frames * 20;
+  static uint32_t src[len], buf[len];
+  for (size_t i = 0; i < len; i++) { src[i] = esp_random(); buf[i] = esp_random(); }
+  printf("\ncolor math (%u pixels, %u passes)\n", (unsigned)len, reps);
+  printf("%-24s %12s %12s %12s\n", "function", "ref ns/px", "ns/px", "span ns/px");
+  #define BENCH_COLOR(name, ref, fn, span) { \
+    double t[3]; \
+    t[0] = benchColorNs([](uint32_t *d, const uint32_t *s, size_t n, unsigned r) { for (size_t i = 0; i < n; i++) d[i] = ref; }, buf, src, len, reps); \
+    t[1] = benchColorNs([](uint32_t *d, const uint32_t *s, size_t n, unsigned r) { for (size_t i = 0; i < n; i++) d[i] = fn; }, buf, src, len, reps); \
+    t[2] = benchColorNs([](uint32_t *d, const uint32_t *s, size_t n, unsigned r) { span; }, buf, src, len, reps); \
+    printf("%-24s %12.3f %12.3f %12.3f\n", name, t[0], t[1], t[2]); \
+  }
+  // blend amounts avoid 0 and max (early returns), fade amounts 255 (no-op in span)
+  BENCH_COLOR("color_blend",         ref_color_blend(d[i], s[i], 1 + r % 254),               color_blend(d[i], s[i], 1 + r % 254),               color_blend_span(d, s, n, 1 + r % 254));
+  BENCH_COLOR("color_blend b16",     ref_color_blend(d[i], s[i], 1 + r * 97 % 65534, true),  color_blend(d[i], s[i], 1 + r * 97 % 65534, true),  color_blend_span(d, s, n, 1 + r * 97 % 65534, true));
+  BENCH_COLOR("color_add",           ref_color_add(d[i] >> 1, s[i]),                          color_add(d[i] >> 1, s[i]),                          color_add_span(d, s, n));
+  BENCH_COLOR("color_add fast",      ref_color_add(d[i] >> 1, s[i], true),                    color_add(d[i] >> 1, s[i], true),                    color_add_span(d, s, n, true));
+  BENCH_COLOR("color_fade",          ref_color_fade(d[i] ^ s[i], r % 255),                    color_fade(d[i] ^ s[i], r % 255),                    (memcpy(d, s, n * 4), color_fade_span(d, n, r % 255)));
+  BENCH_COLOR("color_fade video",    ref_color_fade(d[i] ^ s[i], r % 255, true),              color_fade(d[i] ^ s[i], r % 255, true),              (memcpy(d, s, n * 4), color_fade_span(d, n, r % 255, true)));
+  #undef BENCH_COLOR
+}
+
+// preset lookup in presets.json: offset index (readObjectFromFileUsingId()) against scanning for the "id": key
+// (readObjectFromFile() with key), both include parsing the preset; file reads are served from the host page cache
+static void benchPresets(unsigned frames) {
+  static const unsigned counts[] = {10, 100, 250};
+  const unsigned reps = frames < 10 ? 1 : frames / 10;
+  DynamicJsonDocument pdoc(2048);
+  printf("\npreset lookup (%u passes over all presets)\n", reps);
+  printf("%8s %10s %14s %14s %14s\n", "presets", "file kB", "scan us", "indexed us", "index build us");
+  for (unsigned n : counts) {
+    WLED_FS.remove("/presets.json");
+    invalidatePresetIndex();
+    for (unsigned id = 1; id <= n; id++) { // typical single segment preset, ~400 bytes
+      char json[512];
+      snprintf(json, sizeof(json), "{\"n\":\"Preset %u\",\"on\":true,\"bri\":%u,\"transition\":7,\"mainseg\":0,\"seg\":[{\"id\":0,"
+        "\"start\":0,\"stop\":300,\"grp\":1,\"spc\":0,\"of\":0,\"on\":true,\"frz\":false,\"bri\":255,\"cct\":127,\"set\":0,"
+        "\"col\":[[255,%u,0],[0,0,0],[0,0,0]],\"fx\":%u,\"sx\":128,\"ix\":128,\"pal\":%u,\"c1\":128,\"c2\":128,\"c3\":16,"
+        "\"sel\":true,\"rev\":false,\"mi\":false,\"o1\":false,\"o2\":false,\"o3\":false,\"si\":0,\"m12\":0}]}",
+        id, id, id, id % 100, id % 50);
+      deserializeJson(pdoc, json);
+      writeObjectToFileUsingId("/presets.json", id, &pdoc);
+    }
+    closeFile();
+    File pf = WLED_FS.open("/presets.json", "r");
+    size_t fileSize = pf.size();
+    pf.close();
+
+    std::vector<uint16_t> order(n);
+    for (unsigned i = 0; i < n; i++) order[i] = 1 + (i * 37) % n; // all ids in scattered order (37 is prime)
+    char key[10];
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned r = 0; r < reps; r++) for (uint16_t id : order) {
+      sprintf(key, "\"%d\":", id);
+      readObjectFromFile("/presets.json", key, &pdoc);
+    }
+    double scanUs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / 1000.0 / reps / n;
+    invalidatePresetIndex();
+    start = std::chrono::steady_clock::now();
+    readObjectFromFileUsingId("/presets.json", order[0], &pdoc); // builds index
+    double firstUs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / 1000.0;
+    start = std::chrono::steady_clock::now();
+    for (unsigned r = 0; r < reps; r++) for (uint16_t id : order) readObjectFromFileUsingId("/presets.json", id, &pdoc);
+    double indexUs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / 1000.0 / reps / n;
+    printf("%8u %10.1f %14.2f %14.2f %14.2f\n", n, fileSize / 1024.0, scanUs, indexUs, firstUs - indexUs);
+  }
+  WLED_FS.remove("/presets.json");
+  invalidatePresetIndex();
+}
+
+// realtime ingest: E1.31/Art-Net universes and DDP packets through the frame assembler and Adalight frames
+// from serial, each frame is output (strip.show()); universes/s counts 170 pixels (510 channels) as one universe
+static void benchRealtime(unsigned frames) {
+  static e131_packet_t pkt;
+  const uint16_t len = strip.getLengthTotal();
+  const unsigned universes = (len + 169) / 170;
+  const IPAddress sender(192, 168, 1, 10);
+  printf("\nrealtime ingest (%u pixels, %u frames)\n", len, frames);
+  printf("%-10s %10s %14s %14s %14s\n", "protocol", "px/packet", "us/frame", "packets/s", "universes/s");
+  auto report = [&](const char *name, unsigned pxPerPacket, unsigned packets, uint64_t ns) {
+    double usPerFrame = ns / 1000.0 / frames;
+    printf("%-10s %10u %14.2f %14.0f %14.0f\n", name, pxPerPacket, usPerFrame,
+      packets * 1e6 / usPerFrame, len / 170.0 * 1e6 / usPerFrame);
+  };
+
+  for (byte protocol : {P_E131, P_ARTNET}) {
+    memset(&pkt, 0, sizeof(pkt));
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned f = 0; f < frames; f++) {
+      for (unsigned u = 0; u < universes; u++) {
+        uint8_t *dmx;
+        if (protocol == P_E131) {
+          pkt.universe = htons(e131Universe + u);
+          pkt.sequence_number = f;
+          pkt.priority = 100;
+          pkt.property_value_count = htons(511);
+          dmx = pkt.property_values + 1;
+        } else {
+          pkt.art_opcode = ARTNET_OPCODE_OPDMX;
+          pkt.art_universe = e131Universe + u;
+          pkt.art_sequence_number = f;
+          pkt.art_length = htons(510);
+          dmx = pkt.art_data;
+        }
+        for (unsigned c = 0; c < 510; c++) dmx[c] = f + u + c;
+        handleE131Packet(&pkt, sender, protocol);
+      }
+      handleRealtimeFrame();
+    }
+    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    report(protocol == P_E131 ? "E1.31" : "Art-Net", 170, universes, ns);
+    exitRealtime();
+  }
+
+  const unsigned ddpPixels = 480; // 1440 bytes of RGB data, largest DDP packet
+  const unsigned ddpPackets = (len + ddpPixels - 1) / ddpPixels;
+  memset(&pkt, 0, sizeof(pkt));
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned f = 0; f < frames; f++) {
+    for (unsigned n = 0; n < ddpPackets; n++) {
+      unsigned px = MIN(ddpPixels, len - n * ddpPixels);
+      pkt.flags = 0x40 | (n == ddpPackets - 1 ? DDP_PUSH_FLAG : 0); // version 1, push with last packet of frame
+      pkt.dataType = DDP_TYPE_RGB24;
+      pkt.sequenceNum = 1 + f % 15;
+      pkt.channelOffset = htonl(n * ddpPixels * 3);
+      pkt.dataLen = htons(px * 3);
+      for (unsigned c = 0; c < px * 3; c++) pkt.data[c] = f + n + c;
+      handleE131Packet(&pkt, sender, P_DDP);
+    }
+    handleRealtimeFrame();
+  }
+  uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+  report("DDP", ddpPixels, ddpPackets, ns);
+  exitRealtime();
+
+  // Adalight: header "Ada", pixel count - 1 (high, low), checksum, RGB data
+  std::vector<uint8_t> ada(6 + len * 3);
+  ada[0] = 'A'; ada[1] = 'd'; ada[2] = 'a';
+  ada[3] = (len - 1) >> 8; ada[4] = (len - 1) & 0xFF; ada[5] = ada[3] ^ ada[4] ^ 0x55;
+  start = std::chrono::steady_clock::now();
+  for (unsigned f = 0; f < frames; f++) {
+    for (unsigned c = 0; c < len * 3u; c++) ada[6 + c] = f + c;
+    Serial.hostInput(ada.data(), ada.size());
+    handleSerial();
+  }
+  ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+  report("Adalight", len, 1, ns);
+  Serial.hostInput(nullptr, 0);
+  exitRealtime();
+}
+
+// ABL power estimate (estimateCurrentAndLimitBri() in show()) on busses with and without pixel buffer, for effects writing
+// pixels directly and through segment frame buffers (spans); the limit is low enough that brightness is always reduced
+static void benchPower(unsigned frames) {
+  static const uint8_t mode = FX_MODE_RAINBOW_CYCLE;
+  printf("\nABL power estimate (1024 pixels, %u frames)\n", frames);
+  printf("%-24s %12s %12s %12s\n", "bus", "ABL off us", "ABL on us", "ABL us");
+  for (bool buffered : {false, true}) for (bool spans : {false, true}) {
+    hostStripSetup(1024, 0, 1, buffered);
+    useSegmentBuffers = spans;
+    double us[2];
+    for (int abl = 0; abl < 2; abl++) {
+      strip.ablMilliampsMax = abl ? 1500 : 0;
+      us[abl] = hostStripBench(mode, frames) / 1000.0 / frames;
+    }
+    char name[25];
+    snprintf(name, sizeof(name), "%s %s", buffered ? "buffered" : "unbuffered", spans ? "span" : "direct");
+    printf("%-24s %12.2f %12.2f %12.2f\n", name, us[0], us[1], us[1] - us[0]);
+  }
+  strip.ablMilliampsMax = ABL_MILLIAMPS_DEFAULT;
+  useSegmentBuffers = true;
+}
+
+int main(int argc, char **argv) {
+  unsigned frames = argc > 1 ? atoi(argv[1]) : 100;
+  if (!frames) frames = 100;
+  Serial.hostQuiet(true);
+
+  hostStripSetup(300);
+  benchEffects("strip 300", frames);
+  hostStripSetup(1024);
+  benchEffects("strip 1024", frames);
+  hostMatrixSetup(64, 64);
+  benchEffects("matrix 64x64", frames);
+  benchMapping(frames);
+  benchPalettes(frames);
+  benchColors(frames);
+  benchPresets(frames);
+  benchPower(frames);
+  hostStripSetup(1024);
+  benchRealtime(frames);
+  return 0;
+}
+#endif
@@ -0,0 +1,142 @@
+/*
+ * LittleFS for the native build, backed by a directory on the host
+ */
+#include <LittleFS.h>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+fs::FS LittleFS;
+
+static std::string hostRoot;
+
+const char *hostFsRoot() {
+  if (hostRoot.empty()) {
+    char tmpl[] = "/tmp/wled-fs-XXXXXX";
+    const char *dir = mkdtemp(tmpl);
+    hostRoot = dir ? dir : ".";
+  }
+  return hostRoot.c_str();
+}
+
+void hostFsSetRoot(const char *dir) {
+  hostRoot = dir;
+  ::mkdir(dir, 0755);
+}
+
+static std::string hostPath(const char *path) {
+  std::string p(hostFsRoot());
+  if (path && path[0] != '/') p += '/';
+  if (path) p += path;
+  return p;
+}
+
+namespace fs {
+
+class FileImpl {
+  public:
+    FILE *f = nullptr;
+    DIR *dir = nullptr;
+    std::string path;   // path on the LittleFS (starts with '/')
+    std::string name;
+    ~FileImpl() { close(); }
+    void close() {
+      if (f) fclose(f);
+      if (dir) closedir(dir);
+      f = nullptr; dir = nullptr;
+    }
+};
+
+size_t File::write(uint8_t c) { return write(&c, 1); }
+size_t File::write(const uint8_t *buf, size_t size) { return _p && _p->f ? fwrite(buf, 1, size, _p->f) : 0; }
+int File::available() { return _p && _p->f ? (int)(size() - position()) : 0; }
+int File::read() { return _p && _p->f ? fgetc(_p->f) : -1; }
+int File::peek() {
+  if (!_p || !_p->f) return -1;
+  int c = fgetc(_p->f);
+  if (c >= 0) ungetc(c, _p->f);
+  return c;
+}
+size_t File::read(uint8_t *buf, size_t size) { return _p && _p->f ? fread(buf, 1, size, _p->f) : 0; }
+void File::flush() { if (_p && _p->f) fflush(_p->f); }
+bool File::seek(uint32_t pos, SeekMode mode) {
+  if (!_p || !_p->f) return false;
+  return fseek(_p->f, pos, mode == SeekSet ? SEEK_SET : mode == SeekCur ? SEEK_CUR : SEEK_END) == 0;
+}
+size_t File::position() const { return _p && _p->f ? ftell(_p->f) : 0; }
+size_t File::size() const {
+  if (!_p || !_p->f) return 0;
+  long pos = ftell(_p->f);
+  fseek(_p->f, 0, SEEK_END);
+  long len = ftell(_p->f);
+  fseek(_p->f, pos, SEEK_SET);
+  return len;
+}
+void File::close() { if (_p) _p->close(); _p.reset(); }
+File::operator bool() const { return _p && (_p->f || _p->dir); }
+const char *File::name() const { return _p ? _p->name.c_str() : ""; }
+const char *File::path() const { return _p ? _p->path.c_str() : ""; }
+bool File::isDirectory() const { return _p && _p->dir; }
+void File::rewindDirectory() { if (_p && _p->dir) rewinddir(_p->dir); }
+
+File File::openNextFile(const char *mode) {
+  if (!_p || !_p->dir) return File();
+  struct dirent *e;
+  while ((e = readdir(_p->dir))) {
+    if (!strcmp(e->d_name, ".") || !strcmp(e->d_name, "..")) continue;
+    std::string p = _p->path;
+    if (p.empty() || p.back() != '/') p += '/';
+    return LittleFS.open((p + e->d_name).c_str(), mode);
+  }
+  return File();
+}
+
+File FS::open(const char *path, const char *mode, bool create) {
+  std::string hp = hostPath(path);
+  auto impl = std::make_shared<FileImpl>();
+  impl->path = path;
+  impl->name = impl->path.substr(impl->path.find_last_of('/') + 1);
+  struct stat st;
+  if (stat(hp.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+    impl->dir = opendir(hp.c_str());
+    return impl->dir ? File(impl) : File();
+  }
+  const char *m = mode[0] == 'w' ? (mode[1] == '+' ? "w+b" : "wb") : mode[0] == 'a' ? (mode[1] == '+' ? "a+b" : "ab") : (mode[1] == '+' ? "r+b" : "rb");
+  impl->f = fopen(hp.c_str(), m);
+  return impl->f ? File(impl) : File();
+}
+
+bool FS::exists(const char *path) { struct stat st; return stat(hostPath(path).c_str(), &st) == 0; }
+bool FS::remove(const char *path) { return ::remove(hostPath(path).c_str()) == 0; }
+bool FS::rename(const char *from, const char *to) { return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0; }
+bool FS::mkdir(const char *path) { return ::mkdir(hostPath(path).c_str(), 0755) == 0; }
+bool FS::rmdir(const char *path) { return ::rmdir(hostPath(path).c_str()) == 0; }
+
+bool FS::format() {
+  DIR *d = opendir(hostFsRoot());
+  if (!d) return false;
+  std::vector<std::string> names;
+  struct dirent *e;
+  while ((e = readdir(d))) if (strcmp(e->d_name, ".") && strcmp(e->d_name, "..")) names.push_back(e->d_name);
+  closedir(d);
+  for (auto &n : names) ::remove(hostPath(("/" + n).c_str()).c_str());
+  return true;
+}
+
+size_t FS::usedBytes() {
+  DIR *d = opendir(hostFsRoot());
+  if (!d) return 0;
+  size_t used = 0;
+  struct dirent *e;
+  struct stat st;
+  while ((e = readdir(d))) {
+    if (stat(hostPath((std::string("/") + e->d_name).c_str()).c_str(), &st) == 0 && S_ISREG(st.st_mode)) used += st.st_size;
+  }
+  closedir(d);
+  return used;
+}
+
+} // namespace fs
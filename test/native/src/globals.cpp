@@ -0,0 +1,5 @@
+/*
+ * Global variables of the firmware for the native build (wled.cpp is not part of it)
+ */
+#define WLED_DEFINE_GLOBAL_VARS
+#include "wled.h"
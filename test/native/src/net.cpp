@@ -0,0 +1,76 @@
+/*
+ * UDP for the native build
+ * Sent packets are recorded (see HostNet.h) and, with loopback enabled, queued for WiFiUDP
+ * receivers of the destination port. AsyncUDP listeners are called by hostUdpDeliver().
+ */
+#include <WiFiUdp.h>
+#include <AsyncUDP.h>
+#include <HostNet.h>
+#include <WiFi.h>
+
+#include <algorithm>
+#include <deque>
+
+static std::vector<HostUdpPacket> hostSent;
+static std::deque<HostUdpPacket>  hostQueue;
+static bool hostLoopback = true;
+
+// AsyncUDP objects are globals of WLED, the list must exist before and outlive them
+static std::vector<AsyncUDP *> &listeners() {
+  static std::vector<AsyncUDP *> *list = new std::vector<AsyncUDP *>;
+  return *list;
+}
+
+std::vector<HostUdpPacket> &hostUdpSent() { return hostSent; }
+void hostUdpReset() { hostSent.clear(); hostQueue.clear(); }
+void hostUdpLoopback(bool enable) { hostLoopback = enable; }
+void hostUdpInject(const HostUdpPacket &p) { hostQueue.push_back(p); }
+
+size_t hostUdpDeliver(const HostUdpPacket &p) {
+  size_t n = 0;
+  for (AsyncUDP *udp : std::vector<AsyncUDP *>(listeners())) {
+    if (udp->port() != p.dstPort) continue;
+    AsyncUDPPacket packet(p.data.data(), p.data.size(), p.src, p.srcPort, p.dstPort, p.dst[3] == 255, p.dst[0] >= 224 && p.dst[0] <= 239);
+    udp->deliver(packet);
+    n++;
+  }
+  return n;
+}
+
+static void hostSend(const IPAddress &dst, uint16_t dstPort, const uint8_t *data, size_t len) {
+  HostUdpPacket p;
+  p.src = WiFi.localIP();
+  p.srcPort = dstPort;
+  p.dst = dst;
+  p.dstPort = dstPort;
+  p.data.assign(data, data + len);
+  hostSent.push_back(p);
+  if (hostLoopback) hostQueue.push_back(p);
+}
+
+int WiFiUDP::endPacket() {
+  hostSend(_txIP, _txPort, _tx.data(), _tx.size());
+  _tx.clear();
+  return 1;
+}
+
+int WiFiUDP::parsePacket() {
+  _rx.clear();
+  _rxPos = 0;
+  if (!_port) return 0;
+  auto it = std::find_if(hostQueue.begin(), hostQueue.end(), [this](const HostUdpPacket &p) { return p.dstPort == _port; });
+  if (it == hostQueue.end()) return 0;
+  _rx = it->data;
+  _rxIP = it->src;
+  _rxPort = it->srcPort;
+  hostQueue.erase(it);
+  return _rx.size();
+}
+
+AsyncUDP::AsyncUDP() { listeners().push_back(this); }
+AsyncUDP::~AsyncUDP() { listeners().erase(std::remove(listeners().begin(), listeners().end(), this), listeners().end()); }
+
+size_t AsyncUDP::writeTo(const uint8_t *data, size_t len, const IPAddress &addr, uint16_t port) {
+  hostSend(addr, port, data, len);
+  return len;
+}
@@ -0,0 +1,76 @@
+/*
+ * LED setup and frame rendering for the native build (see HostStrip.h)
+ */
+#include "wled.h"
+#include <HostStrip.h>
+
+#include <chrono>
+
+static void hostBeginStrip() {
+  strip.finalizeInit();
+#ifndef WLED_DISABLE_2D
+  if (strip.isMatrix) strip.setUpMatrix();
+#endif
+  strip.makeAutoSegments(true);
+  strip.setTransition(0);
+  bri = briS = 255;
+  strip.setBrightness(255, true);
+  hostAdvanceTime(0); // freeze the clock, frames advance it
+}
+
+void hostStripSetup(uint16_t length, uint8_t type, uint8_t numBusses, bool buffered) {
+  busses.removeAll();
+  for (uint16_t b = 0, start = 0; b < numBusses; b++) {
+    uint16_t len = (length - start) / (numBusses - b);
+    uint8_t pins[5] = {uint8_t(2 + b), 255, 255, 255, 255};
+    BusConfig bc(type ? type : TYPE_WS2812_RGB, pins, start, len, COL_ORDER_GRB, false, 0, RGBW_MODE_MANUAL_ONLY, 0, buffered);
+    busses.add(bc);
+    start += len;
+  }
+  strip.isMatrix = false;
+#ifndef WLED_DISABLE_2D
+  strip.panel.clear();
+  strip.panels = 0;
+#endif
+  hostBeginStrip();
+}
+
+void hostMatrixSetup(uint8_t width, uint8_t height) {
+  busses.removeAll();
+  uint8_t pins[5] = {2, 255, 255, 255, 255};
+  BusConfig bc(TYPE_WS2812_RGB, pins, 0, width * height, COL_ORDER_GRB);
+  busses.add(bc);
+#ifndef WLED_DISABLE_2D
+  strip.isMatrix = true;
+  strip.panel.clear();
+  strip.panels = 1;
+  WS2812FX::Panel p;
+  p.width = width;
+  p.height = height;
+  p.xOffset = p.yOffset = 0;
+  p.options = 0;
+  strip.panel.push_back(p);
+#endif
+  hostBeginStrip();
+}
+
+void hostStripFrame() {
+  // service() may wait for the bus to finish sending the previous frame (long busses), keep the clock going until it shows
+  const uint32_t shows = hostBusShowCount;
+  hostAdvanceTime(strip.getFrameTime() * 1000UL);
+  strip.trigger();
+  strip.service();
+  for (unsigned ms = 0; hostBusShowCount == shows && ms < 1000; ms++) {
+    hostAdvanceTime(1000);
+    strip.service();
+  }
+}
+
+uint64_t hostStripBench(uint8_t mode, unsigned frames) {
+  Segment &seg = strip.getMainSegment();
+  seg.setMode(mode, true);
+  for (unsigned i = 0; i < 4; i++) hostStripFrame(); // let the effect allocate its data and settle
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < frames; i++) hostStripFrame();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,104 @@
+/*
+ * Packed channel math of color_blend(), color_add(), color_fade() and their _span() variants
+ * has to be bit-exact with the per-channel reference (ColorsRef.h)
+ */
+#include <unity.h>
+#include "wled.h"
+#include <ColorsRef.h>
+
+void setUp() {}
+void tearDown() {}
+
+// colors with different values in every channel, so carries between lanes would show up
+static inline uint32_t colorA(unsigned a, unsigned b) { return RGBW32(a, b, 255 - a, a ^ b); }
+static inline uint32_t colorB(unsigned a, unsigned b) { return RGBW32(b, 255 - b, a, (a + b) & 0xFF); }
+
+void test_blend_exhaustive() {
+  for (unsigned blend = 0; blend < 256; blend++) for (unsigned a = 0; a < 256; a++) for (unsigned b = 0; b < 256; b++) {
+    uint32_t c1 = colorA(a, b), c2 = colorB(a, b);
+    if (color_blend(c1, c2, blend) != ref_color_blend(c1, c2, blend)) {
+      char msg[64];
+      snprintf(msg, sizeof(msg), "blend %u a %u b %u", blend, a, b);
+      TEST_FAIL_MESSAGE(msg);
+    }
+  }
+}
+
+void test_blend16_random() {
+  static const uint16_t edges[] = {0, 1, 255, 256, 0x7FFF, 0x8000, 0xFF00, 0xFFFE, 0xFFFF};
+  for (uint16_t blend : edges) for (unsigned a = 0; a < 256; a++) {
+    uint32_t c1 = colorA(a, 255 - a), c2 = colorB(a, a);
+    TEST_ASSERT_EQUAL_HEX32(ref_color_blend(c1, c2, blend, true), color_blend(c1, c2, blend, true));
+  }
+  for (unsigned i = 0; i < 2000000; i++) {
+    uint32_t c1 = esp_random(), c2 = esp_random();
+    uint16_t blend = esp_random();
+    TEST_ASSERT_EQUAL_HEX32(ref_color_blend(c1, c2, blend, true), color_blend(c1, c2, blend, true));
+  }
+}
+
+void test_add_exhaustive() {
+  for (unsigned a = 0; a < 256; a++) for (unsigned b = 0; b < 256; b++) {
+    uint32_t c1 = colorA(a, b), c2 = colorB(a, b);
+    TEST_ASSERT_EQUAL_HEX32(ref_color_add(c1, c2, true),  color_add(c1, c2, true));
+    TEST_ASSERT_EQUAL_HEX32(ref_color_add(c1, c2, false), color_add(c1, c2, false));
+    c2 = RGBW32(a, a, b, b); // only some channels overflow
+    TEST_ASSERT_EQUAL_HEX32(ref_color_add(c1, c2, true),  color_add(c1, c2, true));
+    TEST_ASSERT_EQUAL_HEX32(ref_color_add(c1, c2, false), color_add(c1, c2, false));
+  }
+  for (unsigned i = 0; i < 2000000; i++) {
+    uint32_t c1 = esp_random(), c2 = esp_random() & 0x7F7F7F7F; // about half of the sums overflow
+    TEST_ASSERT_EQUAL_HEX32(ref_color_add(c1, c2, true),  color_add(c1, c2, true));
+    TEST_ASSERT_EQUAL_HEX32(ref_color_add(c1, c2, false), color_add(c1, c2, false));
+  }
+}
+
+void test_fade_exhaustive() {
+  for (unsigned amount = 0; amount < 256; amount++) for (unsigned a = 0; a < 256; a++) for (unsigned b = 0; b < 256; b += 17) {
+    uint32_t c = colorA(a, b);
+    TEST_ASSERT_EQUAL_HEX32(ref_color_fade(c, amount, false), color_fade(c, amount, false));
+    TEST_ASSERT_EQUAL_HEX32(ref_color_fade(c, amount, true),  color_fade(c, amount, true));
+    c = RGBW32(0, a, 0, b); // zero channels next to non-zero ones (video adds 1 to non-zero channels only)
+    TEST_ASSERT_EQUAL_HEX32(ref_color_fade(c, amount, true),  color_fade(c, amount, true));
+  }
+}
+
+// span functions against the scalar reference on every element, odd length to catch tail handling
+void test_spans() {
+  const size_t len = 333;
+  uint32_t src[len], dst[len], ref[len];
+  static const uint16_t blends[] = {0, 1, 128, 254, 255};
+  static const uint16_t blends16[] = {0, 1, 255, 0x8000, 0xFFFE, 0xFFFF};
+  for (auto &c : src) c = esp_random();
+
+  for (uint16_t blend : blends) {
+    for (size_t i = 0; i < len; i++) ref[i] = ref_color_blend(dst[i] = esp_random(), src[i], blend);
+    color_blend_span(dst, src, len, blend);
+    TEST_ASSERT_EQUAL_HEX32_ARRAY(ref, dst, len);
+  }
+  for (uint16_t blend : blends16) {
+    for (size_t i = 0; i < len; i++) ref[i] = ref_color_blend(dst[i] = esp_random(), src[i], blend, true);
+    color_blend_span(dst, src, len, blend, true);
+    TEST_ASSERT_EQUAL_HEX32_ARRAY(ref, dst, len);
+  }
+  for (bool fast : {false, true}) {
+    for (size_t i = 0; i < len; i++) ref[i] = ref_color_add(dst[i] = esp_random(), src[i], fast);
+    color_add_span(dst, src, len, fast);
+    TEST_ASSERT_EQUAL_HEX32_ARRAY(ref, dst, len);
+  }
+  for (unsigned amount = 0; amount < 256; amount++) for (bool video : {false, true}) {
+    for (size_t i = 0; i < len; i++) ref[i] = ref_color_fade(dst[i] = esp_random() & (i & 1 ? 0xFF00FF00 : 0xFFFFFFFF), amount, video);
+    color_fade_span(dst, len, amount, video);
+    TEST_ASSERT_EQUAL_HEX32_ARRAY(ref, dst, len);
+  }
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_blend_exhaustive);
+  RUN_TEST(test_blend16_random);
+  RUN_TEST(test_add_exhaustive);
+  RUN_TEST(test_fade_exhaustive);
+  RUN_TEST(test_spans);
+  return UNITY_END();
+}
@@ -0,0 +1,96 @@
+/*
+ * Frame sync follower: frame time and timebase of the master are used only while locked,
+ * target FPS (saved in cfg.json) is never changed and local frame time and timebase are restored
+ */
+#include <unity.h>
+#include "wled.h"
+#include <HostStrip.h>
+#include <HostNet.h>
+
+static const IPAddress master(192, 168, 1, 60);
+
+static void put32(byte *p, uint32_t v) { p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v; }
+static void put64(byte *p, uint64_t v) { put32(p, v >> 32); put32(p + 4, v); }
+
+static void header(byte *buf, byte type) {
+  buf[0] = FRAME_SYNC_ID;
+  buf[1] = 1; // version
+  buf[2] = type;
+  buf[3] = 1; // sync groups
+}
+
+static void announce(uint32_t frameUs) {
+  byte buf[28] = {0};
+  header(buf, 0);
+  put64(buf + 4, frameSyncMicros());
+  put32(buf + 12, frameUs);
+  handleFrameSyncPacket(buf, sizeof(buf), master, frameSyncMicros());
+}
+
+// delay response of master with same clock as ours, 200us round trip
+static void respond(uint32_t frameUs) {
+  byte buf[47] = {0};
+  uint64_t now = frameSyncMicros();
+  header(buf, 2);
+  put64(buf + 4, now - 200);
+  put64(buf + 12, now - 100);
+  put64(buf + 20, now - 100);
+  put32(buf + 28, frameUs);
+  put32(buf + 32, 5000); // effect time offset
+  handleFrameSyncPacket(buf, sizeof(buf), master, now);
+}
+
+static void lock(uint32_t frameUs) {
+  announce(frameUs);
+  for (int i = 0; i < 4; i++) {
+    respond(frameUs);
+    hostAdvanceTime(10000);
+  }
+}
+
+void setUp() {
+  hostStripSetup(30);
+  hostUdpLoopback(false);
+  udpConnected = notifierUdp.begin(udpPort);
+  receiveGroups = 1;
+  frameSyncMode = FRAME_SYNC_FOLLOWER;
+  strip.setTargetFps(42);
+  strip.timebase = 1234;
+}
+void tearDown() {
+  frameSyncMode = FRAME_SYNC_OFF;
+  handleFrameSync();
+  hostUdpLoopback(true);
+}
+
+void test_master_timeout() {
+  lock(20000);
+  TEST_ASSERT_EQUAL(20000, strip.getTargetFrameTime());
+  TEST_ASSERT_EQUAL(42, strip.getTargetFps());
+  TEST_ASSERT_TRUE(strip.timebase != 1234); // time base of master
+  hostAdvanceTime(6000000);                  // no announce, lock lost
+  handleFrameSync();
+  TEST_ASSERT_EQUAL(1000000 / 42, strip.getTargetFrameTime());
+  TEST_ASSERT_EQUAL(42, strip.getTargetFps());
+  TEST_ASSERT_EQUAL(1234, strip.timebase);
+}
+
+void test_mode_off() {
+  lock(25000);
+  TEST_ASSERT_EQUAL(25000, strip.getTargetFrameTime());
+  strip.setTargetFps(30); // user changes FPS while following
+  TEST_ASSERT_EQUAL(25000, strip.getTargetFrameTime());
+  frameSyncMode = FRAME_SYNC_OFF;
+  handleFrameSync();
+  TEST_ASSERT_EQUAL(1000000 / 30, strip.getTargetFrameTime());
+  TEST_ASSERT_EQUAL(30, strip.getTargetFps());
+  TEST_ASSERT_EQUAL(1234, strip.timebase);
+}
+
+int main(int argc, char **argv) {
+  hostSetTime(1000000);
+  UNITY_BEGIN();
+  RUN_TEST(test_master_timeout);
+  RUN_TEST(test_mode_off);
+  return UNITY_END();
+}
@@ -0,0 +1,110 @@
+/*
+ * JSON API responses: effect names and palettes are streamed in chunks from flash,
+ * output has to be the same as serializing everything at once
+ * JSON command queue: loop() does not wait for the JSON buffer, invalid commands are counted
+ */
+#include <unity.h>
+#include "wled.h"
+#include "palettes.h"
+#include <HostStrip.h>
+
+static DynamicJsonDocument rdoc(32768);
+
+static void get(const char *url, String &content) {
+  AsyncWebServerRequest request;
+  request.hostSetUrl(url);
+  serveJson(&request);
+  TEST_ASSERT_EQUAL(200, request.hostCode());
+  TEST_ASSERT_TRUE(requestJSONBufferLock(99)); // released before response is sent
+  releaseJSONBufferLock();
+  content = request.hostSent();
+}
+
+static String printed(void (*serialize)(Print &)) {
+  AsyncResponseStream stream;
+  serialize(stream);
+  return stream.hostContent();
+}
+
+void setUp() {
+  hostStripSetup(30);
+}
+void tearDown() {}
+
+void test_effects() {
+  String names;
+  get("/json/eff", names);
+  TEST_ASSERT_TRUE(names == printed(serializeModeNames));
+  TEST_ASSERT_FALSE(deserializeJson(rdoc, names));
+  TEST_ASSERT_TRUE(rdoc[0] == "Solid");
+  size_t count = rdoc.size();
+  TEST_ASSERT_TRUE(count > 100);
+
+  String data;
+  get("/json/fxda", data);
+  TEST_ASSERT_TRUE(data == printed(serializeModeData));
+  TEST_ASSERT_FALSE(deserializeJson(rdoc, data));
+  TEST_ASSERT_EQUAL(count, rdoc.size());
+}
+
+void test_full() {
+  briLast = 77; // reported brightness
+  String full;
+  get("/json", full);
+  TEST_ASSERT_FALSE(deserializeJson(rdoc, full));
+  TEST_ASSERT_EQUAL(77, rdoc["state"]["bri"].as<int>());
+  TEST_ASSERT_TRUE(rdoc["info"]["leds"]["count"].as<int>() == 30);
+  String effects, palettes;
+  serializeJson(rdoc["effects"], effects);
+  serializeJson(rdoc["palettes"], palettes);
+  TEST_ASSERT_TRUE(effects == printed(serializeModeNames));
+  TEST_ASSERT_TRUE(palettes.length() > 0);
+  TEST_ASSERT_TRUE(full.endsWith(String(",\"palettes\":") + JSON_palette_names + "}"));
+
+  String si;
+  get("/json/si", si);
+  TEST_ASSERT_FALSE(deserializeJson(rdoc, si));
+  TEST_ASSERT_EQUAL(77, rdoc["state"]["bri"].as<int>());
+  TEST_ASSERT_TRUE(rdoc["info"].is<JsonObject>());
+  TEST_ASSERT_FALSE(rdoc.containsKey("effects"));
+}
+
+static uint32_t queueInfo(const char *key) {
+  StaticJsonDocument<256> info;
+  serializeJsonQueueInfo(info.to<JsonObject>());
+  return info["jq"][key];
+}
+
+void test_queue_buffer_busy() {
+  const char cmd[] = "{\"bri\":33}";
+  bri = 10;
+  TEST_ASSERT_TRUE(requestJSONBufferLock(99)); // e.g. held by an async web handler
+  TEST_ASSERT_TRUE(queueJsonCommand(cmd, strlen(cmd), JSON_SOURCE_HTTP));
+  hostSetTime(5000000);
+  handleJsonQueue();
+  TEST_ASSERT_EQUAL(5000, millis()); // did not wait for the buffer
+  TEST_ASSERT_EQUAL(10, bri);
+  TEST_ASSERT_EQUAL(1, queueInfo("len"));
+  releaseJSONBufferLock();
+  handleJsonQueue();
+  TEST_ASSERT_EQUAL(33, bri);
+  TEST_ASSERT_EQUAL(0, queueInfo("len"));
+}
+
+void test_queue_invalid() {
+  const char cmd[] = "{\"bri\":";
+  uint32_t err = queueInfo("err");
+  TEST_ASSERT_TRUE(queueJsonCommand(cmd, strlen(cmd), JSON_SOURCE_HTTP));
+  handleJsonQueue();
+  TEST_ASSERT_EQUAL(err + 1, queueInfo("err"));
+  TEST_ASSERT_EQUAL(0, queueInfo("len"));
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_effects);
+  RUN_TEST(test_full);
+  RUN_TEST(test_queue_buffer_busy);
+  RUN_TEST(test_queue_invalid);
+  return UNITY_END();
+}
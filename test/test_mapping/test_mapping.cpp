@@ -0,0 +1,69 @@
+/*
+ * 1D segment mapping: output written through the compiled mapping plan has to match per-pixel index math
+ */
+#include <unity.h>
+#include "wled.h"
+#include <HostStrip.h>
+
+static const uint16_t LEN = 150;
+
+void setUp() {
+  hostStripSetup(LEN, 0, 2); // plan entries hold bus and bus pixel, so use more than one bus
+  strip.ablMilliampsMax = 0;
+}
+void tearDown() {
+  WLED_FS.remove("/ledmap.json");
+  strip.deserializeMap(0);
+  useMappingPlans = true;
+  useSegmentBuffers = true;
+}
+
+static void writeLedmap() { // reversed order with every 7th LED unmapped
+  File f = WLED_FS.open("/ledmap.json", "w");
+  f.print("{\"map\":[");
+  for (int i = 0; i < LEN; i++) f.printf(i ? ",%d" : "%d", i % 7 ? LEN - 1 - i : -1);
+  f.print("]}");
+  f.close();
+  strip.deserializeMap(0);
+}
+
+static void renderBusPixels(bool plan, uint32_t *out) {
+  useMappingPlans = plan;
+  busses.fill(0, LEN, 0);
+  hostStripFrame();
+  hostStripFrame();
+  busses.getPixels(0, out, LEN);
+}
+
+static void checkVariant(uint8_t grp, uint8_t spc, bool mirror, bool reverse, uint16_t ofs) {
+  Segment &seg = strip.getMainSegment();
+  seg.setUp(0, LEN, grp, spc, ofs, 0, 1);
+  seg.mirror  = mirror;
+  seg.reverse = reverse;
+  seg.setMode(FX_MODE_PALETTE);
+  seg.speed = 0; // no movement, output only depends on pixel index
+  seg.setPalette(11);
+  for (int buffered = 0; buffered < 2; buffered++) {
+    useSegmentBuffers = buffered;
+    uint32_t indexMath[LEN], planned[LEN];
+    renderBusPixels(false, indexMath);
+    renderBusPixels(true, planned);
+    TEST_ASSERT_EQUAL_HEX32_ARRAY(indexMath, planned, LEN);
+  }
+}
+
+void test_mapping_plain()    { checkVariant(1, 0, false, false,  0); }
+void test_mapping_grouping() { checkVariant(3, 1, false, false,  0); }
+void test_mapping_mirror()   { checkVariant(1, 0, true,  false,  0); }
+void test_mapping_reverse()  { checkVariant(2, 0, true,  true,  40); }
+void test_mapping_ledmap()   { writeLedmap(); checkVariant(2, 1, true, false, 10); }
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_mapping_plain);
+  RUN_TEST(test_mapping_grouping);
+  RUN_TEST(test_mapping_mirror);
+  RUN_TEST(test_mapping_reverse);
+  RUN_TEST(test_mapping_ledmap);
+  return UNITY_END();
+}
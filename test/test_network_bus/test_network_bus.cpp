@@ -0,0 +1,76 @@
+/*
+ * Network busses: unchanged busses are not sent, E1.31/Art-Net send all universes of a changed bus
+ * (receivers wait for a complete frame), DDP only the packets with changed pixels
+ */
+#include <unity.h>
+#include "wled.h"
+#include <HostNet.h>
+
+static const uint16_t LEN = 400; // 3 universes (170 RGB pixels each), 1 DDP packet (480 pixels)
+
+static Bus *addBus(uint8_t type) {
+  busses.removeAll();
+  uint8_t ip[5] = {192, 168, 1, 60, 255};
+  BusConfig bc(type, ip, 0, LEN);
+  busses.add(bc);
+  return busses.getBus(0);
+}
+
+// packets sent by show() after pixel pix was changed
+static size_t showChanged(Bus *bus, uint16_t pix) {
+  bus->setPixelColor(pix, bus->getPixelColor(pix) + 1);
+  hostUdpReset();
+  bus->show();
+  return hostUdpSent().size();
+}
+
+void setUp() {
+  interfacesInited = true;
+  hostUdpLoopback(false);
+  hostAdvanceTime(0);
+}
+void tearDown() {
+  busses.removeAll();
+  hostUdpLoopback(true);
+}
+
+static void checkUniverses(uint8_t type) {
+  Bus *bus = addBus(type);
+  TEST_ASSERT_NOT_NULL(bus);
+  bus->show(); // first full frame
+  hostUdpReset();
+  bus->show();
+  TEST_ASSERT_EQUAL(0, hostUdpSent().size()); // nothing changed
+  TEST_ASSERT_EQUAL(3, showChanged(bus, 200));
+}
+
+void test_e131()   { checkUniverses(TYPE_NET_E131_RGB); }
+void test_artnet() { checkUniverses(TYPE_NET_ARTNET_RGB); }
+
+void test_ddp_partial() {
+  Bus *bus = addBus(TYPE_NET_DDP_RGB);
+  TEST_ASSERT_NOT_NULL(bus);
+  bus->show();
+  TEST_ASSERT_EQUAL(1, showChanged(bus, 200));
+}
+
+// changes are kept when sending fails and go out with the next show()
+void test_send_failed() {
+  Bus *bus = addBus(TYPE_NET_E131_RGB);
+  bus->show();
+  interfacesInited = false;
+  TEST_ASSERT_EQUAL(0, showChanged(bus, 10));
+  interfacesInited = true;
+  hostUdpReset();
+  bus->show();
+  TEST_ASSERT_EQUAL(3, hostUdpSent().size());
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_e131);
+  RUN_TEST(test_artnet);
+  RUN_TEST(test_ddp_partial);
+  RUN_TEST(test_send_failed);
+  return UNITY_END();
+}
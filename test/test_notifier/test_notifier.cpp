@@ -0,0 +1,200 @@
+/*
+ * Delta notifier protocol: packets sent by notify() are recorded and replayed into the receive path
+ * (loopback replay), with losses, duplicates and reordering the reconstructed state has to match the sender
+ */
+#include <unity.h>
+#include "wled.h"
+#include <HostStrip.h>
+#include <HostNet.h>
+
+struct SentState {
+  HostUdpPacket packet;
+  byte bri;
+  uint32_t color;
+};
+
+static std::vector<SentState> sent;
+
+// changes state and sends it like a change from the UI would
+static void send(byte b, uint32_t color) {
+  bri = b;
+  strip.getMainSegment().setColor(0, color);
+  size_t n = hostUdpSent().size();
+  notify(CALL_MODE_DIRECT_CHANGE);
+  TEST_ASSERT_EQUAL(n + 1, hostUdpSent().size());
+  sent.push_back({hostUdpSent().back(), b, color});
+  hostAdvanceTime(20000);
+}
+
+static bool isKeyframe(const HostUdpPacket &p) { return p.data[0] == 0; }
+static uint16_t seqOf(const HostUdpPacket &p) {
+  size_t i = isKeyframe(p) ? p.data.size() - 2 : 3; // keyframe trailer or delta header
+  return (p.data[i] << 8) | p.data[i+1];
+}
+
+// receiver side: state of the sender is overwritten, only replayed packets may restore it
+static void startReplay() {
+  hostAdvanceTime(1100000); // notifications within a second after sending are ignored
+  bri = 1;
+  strip.getMainSegment().setColor(0, BLACK);
+}
+
+// replays a recorded packet as if it came from another node (own broadcasts are ignored)
+static void replay(HostUdpPacket p, uint8_t node = 50) {
+  p.src = IPAddress(192, 168, 1, node);
+  hostUdpInject(p);
+  handleNotifications();
+}
+
+static void checkState(const SentState &s) {
+  TEST_ASSERT_EQUAL(s.bri, bri);
+  TEST_ASSERT_EQUAL_HEX32(s.color, strip.getMainSegment().colors[0]);
+}
+
+static uint32_t stat(const char *key) {
+  StaticJsonDocument<256> doc;
+  serializeNotifierInfo(doc.to<JsonObject>());
+  return doc["nd"][key];
+}
+
+void setUp() {
+  hostStripSetup(30);
+  hostUdpLoopback(false);
+  hostUdpReset();
+  hostAdvanceTime(6000000); // keyframe interval passed, first notification is a keyframe
+  udpConnected = notifierUdp.begin(udpPort);
+  notifyDirect = true;
+  notifyDelta = true;
+  udpNumRetries = 0;
+  receiveNotifications = true;
+  receiveNotificationBrightness = true;
+  receiveNotificationColor = true;
+  receiveNotificationEffects = false;
+  receiveSegmentOptions = false;
+  receiveSegmentBounds = false;
+  sent.clear();
+}
+void tearDown() {
+  hostUdpLoopback(true);
+  notifyDelta = false;
+}
+
+// keyframe followed by deltas, every delta applied in order
+void test_delta_in_order() {
+  for (int i = 0; i < 8; i++) send(10 + i * 20, RGBW32(i * 30, 255 - i, i, 0));
+  TEST_ASSERT_TRUE(isKeyframe(sent[0].packet));
+  for (size_t i = 1; i < sent.size(); i++) {
+    TEST_ASSERT_FALSE(isKeyframe(sent[i].packet));
+    TEST_ASSERT_LESS_THAN(64, sent[i].packet.data.size()); // header and a few runs, not a full packet
+    TEST_ASSERT_EQUAL(seqOf(sent[i-1].packet) + 1, seqOf(sent[i].packet));
+  }
+  uint32_t rxk = stat("rxk"), rx = stat("rx"), lost = stat("lost");
+  startReplay();
+  for (const auto &s : sent) {
+    replay(s.packet);
+    checkState(s);
+  }
+  TEST_ASSERT_EQUAL(rxk + 1, stat("rxk"));
+  TEST_ASSERT_EQUAL(rx + 7, stat("rx"));
+  TEST_ASSERT_EQUAL(lost, stat("lost"));
+}
+
+// deltas are cumulative: a lost delta is repaired by the next one, late and repeated deltas are dropped
+void test_delta_loss_reorder() {
+  for (int i = 0; i < 5; i++) send(100 + i, RGBW32(0, i * 50, 0, 0));
+  uint32_t rx = stat("rx"), lost = stat("lost");
+  startReplay();
+  replay(sent[0].packet);
+  replay(sent[1].packet);
+  checkState(sent[1]);
+  replay(sent[4].packet); // 2 and 3 lost
+  checkState(sent[4]);
+  TEST_ASSERT_EQUAL(lost + 2, stat("lost"));
+  replay(sent[3].packet); // late
+  replay(sent[4].packet); // duplicate
+  checkState(sent[4]);
+  TEST_ASSERT_EQUAL(rx + 2, stat("rx"));
+}
+
+// deltas of a keyframe the receiver did not get are not applied
+void test_delta_stale() {
+  send(50, RED);
+  send(60, BLUE);
+  uint32_t stale = stat("stale");
+  startReplay();
+  replay(sent[1].packet);
+  TEST_ASSERT_EQUAL(stale + 1, stat("stale"));
+  TEST_ASSERT_EQUAL(1, bri);
+  replay(sent[0].packet);
+  replay(sent[1].packet);
+  checkState(sent[1]);
+}
+
+// retries (udpNumRetries) repeat the sequence number, a receiver that got the original drops them
+void test_retry_same_seq() {
+  udpNumRetries = 1;
+  std::vector<HostUdpPacket> packets;
+  for (int i = 0; i < 2; i++) {
+    send(70 + i, RGBW32(i, 0, 200, 0));
+    hostAdvanceTime(300000);
+    handleNotifications(); // sends retry
+    packets.push_back(sent.back().packet);
+    packets.push_back(hostUdpSent().back());
+    TEST_ASSERT_EQUAL(seqOf(packets[packets.size()-2]), seqOf(packets.back()));
+  }
+  TEST_ASSERT_TRUE(isKeyframe(packets[0]));
+  TEST_ASSERT_TRUE(isKeyframe(packets[1])); // retry of a keyframe is a keyframe, a delta would be stale if it was lost
+  TEST_ASSERT_FALSE(isKeyframe(packets[3]));
+  udpNumRetries = 0;
+
+  uint32_t rx = stat("rx"), lost = stat("lost"), stale = stat("stale");
+  startReplay();
+  for (const auto &p : packets) replay(p);
+  checkState(sent[1]);
+  TEST_ASSERT_EQUAL(rx + 1, stat("rx"));
+  TEST_ASSERT_EQUAL(lost, stat("lost"));
+
+  // original delta lost, retry applies it
+  send(90, GREEN);
+  udpNumRetries = 1;
+  hostAdvanceTime(300000);
+  handleNotifications();
+  udpNumRetries = 0;
+  startReplay();
+  replay(packets[0]);
+  replay(hostUdpSent().back());
+  checkState(sent.back());
+  TEST_ASSERT_EQUAL(stale, stat("stale"));
+}
+
+// two nodes sending deltas: each delta is applied to the keyframe of its own sender
+void test_delta_two_senders() {
+  for (int i = 0; i < 3; i++) send(20 + i, RGBW32(i * 40, 0, 0, 0));
+  hostAdvanceTime(6000000); // keyframe interval passed
+  for (int i = 0; i < 2; i++) send(120 + i, RGBW32(0, 0, i * 40, 0));
+  TEST_ASSERT_TRUE(isKeyframe(sent[3].packet));
+  TEST_ASSERT_FALSE(isKeyframe(sent[4].packet));
+  uint32_t stale = stat("stale");
+  startReplay();
+  replay(sent[0].packet, 50); // keyframe of node 50
+  replay(sent[3].packet, 51); // keyframe of node 51
+  checkState(sent[3]);
+  replay(sent[1].packet, 50);
+  checkState(sent[1]);
+  replay(sent[4].packet, 51);
+  checkState(sent[4]);
+  replay(sent[2].packet, 50);
+  checkState(sent[2]);
+  TEST_ASSERT_EQUAL(stale, stat("stale"));
+}
+
+int main(int argc, char **argv) {
+  hostSetTime(1000000);
+  UNITY_BEGIN();
+  RUN_TEST(test_delta_in_order);
+  RUN_TEST(test_delta_loss_reorder);
+  RUN_TEST(test_delta_stale);
+  RUN_TEST(test_retry_same_seq);
+  RUN_TEST(test_delta_two_senders);
+  return UNITY_END();
+}
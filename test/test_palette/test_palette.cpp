@@ -0,0 +1,91 @@
+/*
+ * Palette used by effects while rendering (SEGPALETTE and the expanded palette table)
+ */
+#include <unity.h>
+#include "wled.h"
+#include <HostStrip.h>
+
+void setUp() {
+  hostStripSetup(100);
+  strip.paletteFade = false;
+  strip.paletteBlend = 0;
+  strip.ablMilliampsMax = 0; // pixels are read back from the bus, no brightness limit
+}
+void tearDown() {
+  strip.setTransition(0);
+}
+
+// effect output has to match color_from_palette() outside of rendering (no table, palette loaded on each call)
+void test_palette_table() {
+  static const uint8_t palettes[] = {2, 3, 6, 11, 13, 40};
+  Segment &seg = strip.getMainSegment();
+  seg.setMode(FX_MODE_PALETTE);
+  seg.speed = 0; // no movement, pixel i shows palette index i*255/len
+  seg.setColor(0, RED);
+  seg.setColor(1, BLUE);
+  for (uint8_t pal : palettes) for (uint8_t blend : {0, 3}) {
+    strip.paletteBlend = blend;
+    seg.setPalette(pal);
+    hostStripFrame();
+    hostStripFrame();
+    for (int i = 0; i < 100; i++) {
+      bool wrap = blend != 0; // PALETTE_MOVING_WRAP of FX.cpp with speed 0
+      uint32_t expected = seg.color_from_palette(i * 255 / 100, false, wrap, 255);
+      TEST_ASSERT_EQUAL_HEX32(expected, strip.getPixelColor(i));
+    }
+  }
+}
+
+// while effects are blended the previous effect has to use its own colors for color palettes
+void test_palette_mode_blend() {
+  Segment &seg = strip.getMainSegment();
+  seg.setPalette(2); // primary color
+  seg.setColor(0, RED);
+  seg.setMode(FX_MODE_PALETTE);
+  hostStripFrame();
+  TEST_ASSERT_EQUAL_HEX32(RED, strip.getPixelColor(50));
+
+  strip.setTransition(10000);
+  seg.setColor(0, BLUE);             // starts transition
+  seg.setMode(FX_MODE_COLORWAVES);   // new effect, same palette
+  TEST_ASSERT_TRUE(seg.isInTransition());
+  hostStripFrame();
+  // progress is tiny, so the output is (almost) the previous effect with its palette
+  uint32_t c = strip.getPixelColor(50);
+  TEST_ASSERT_GREATER_THAN(240, R(c));
+  TEST_ASSERT_LESS_THAN(16, B(c));
+}
+
+// segments may be rendered in different contexts (loop() and FX render task with WLED_FX_CORES 2),
+// each has to use the palette of its own segment
+void test_palette_segments() {
+  useSegmentBuffers = true; // buffered segments can be handed to the render task
+  strip.setSegment(0, 0, 50);
+  strip.setSegment(1, 50, 100);
+  const uint8_t palettes[] = {2, 11};
+  for (int s = 0; s < 2; s++) {
+    Segment &seg = strip.getSegment(s);
+    seg.setMode(FX_MODE_PALETTE);
+    seg.speed = 0;
+    seg.setColor(0, s ? BLUE : RED);
+    seg.setPalette(palettes[s]);
+  }
+  for (int f = 0; f < 4; f++) {
+    hostStripFrame();
+    for (int s = 0; s < 2; s++) {
+      Segment &seg = strip.getSegment(s);
+      for (int i = 0; i < 50; i++) {
+        uint32_t expected = seg.color_from_palette(i * 255 / 50, false, false, 255);
+        TEST_ASSERT_EQUAL_HEX32(expected, strip.getPixelColor(s * 50 + i));
+      }
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_palette_table);
+  RUN_TEST(test_palette_mode_blend);
+  RUN_TEST(test_palette_segments);
+  return UNITY_END();
+}
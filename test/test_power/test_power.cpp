@@ -0,0 +1,170 @@
+/*
+ * ABL power model: Bus::getPowerSum() against the per-pixel loop estimateCurrentAndLimitBri() used before
+ */
+#include <unity.h>
+#include "wled.h"
+#include <HostStrip.h>
+
+#define MA_FOR_ESP 100 // as in FX_fcn.cpp
+
+void setUp() {}
+void tearDown() {}
+
+// the previous model of estimateCurrentAndLimitBri()
+static uint32_t oldPowerSum(Bus *bus, bool ws2815) {
+  uint32_t busPowerSum = 0;
+  for (unsigned i = 0; i < bus->getLength(); i++) {
+    uint32_t c = bus->getPixelColor(i);
+    byte r = R(c), g = G(c), b = B(c), w = W(c);
+    if (ws2815) busPowerSum += (MAX(MAX(r,g),b)) * 3;
+    else        busPowerSum += (r + g + b + w);
+  }
+  return busPowerSum;
+}
+
+static Bus *addBus(uint8_t type, uint16_t len, uint8_t colorOrder, bool buffered, bool reversed = false, uint8_t skip = 0) {
+  busses.removeAll();
+  uint8_t pins[5] = {2, 255, 255, 255, 255};
+  BusConfig bc(type, pins, 0, len, colorOrder, reversed, skip, RGBW_MODE_MANUAL_ONLY, 0, buffered);
+  busses.add(bc);
+  return busses.getBus(0);
+}
+
+static void fillRandom(Bus *bus, unsigned from, unsigned to) {
+  for (unsigned i = from; i < to; i++) bus->setPixelColor(i, esp_random());
+}
+
+// buffered busses keep the sum up to date when pixels change, it has to match the full loop exactly
+static void checkBuffered(uint8_t type, uint8_t colorOrder) {
+  Bus *bus = addBus(type, 300, colorOrder, true);
+  TEST_ASSERT_NOT_NULL(bus);
+  TEST_ASSERT_EQUAL_UINT32(0, bus->getPowerSum(false));
+  fillRandom(bus, 0, 300);
+  TEST_ASSERT_EQUAL_UINT32(oldPowerSum(bus, false), bus->getPowerSum(false));
+  TEST_ASSERT_EQUAL_UINT32(oldPowerSum(bus, true),  bus->getPowerSum(true));
+  fillRandom(bus, 50, 120);                         // overwrite part of the strip
+  bus->setPixelColor(7, bus->getPixelColor(7));     // unchanged pixel
+  uint32_t span[20];
+  for (auto &c : span) c = esp_random();
+  bus->setPixels(200, span, 20);
+  bus->fill(250, 30, RGBW32(10, 200, 30, 99));
+  TEST_ASSERT_EQUAL_UINT32(oldPowerSum(bus, false), bus->getPowerSum(false));
+  TEST_ASSERT_EQUAL_UINT32(oldPowerSum(bus, true),  bus->getPowerSum(true));
+  bus->fill(0, 300, 0);
+  TEST_ASSERT_EQUAL_UINT32(0, bus->getPowerSum(false));
+  TEST_ASSERT_EQUAL_UINT32(0, bus->getPowerSum(true));
+}
+
+void test_buffered_rgb()  { checkBuffered(TYPE_WS2812_RGB, COL_ORDER_GRB); }
+void test_buffered_rgbw() { checkBuffered(TYPE_SK6812_RGBW, COL_ORDER_RGB | 0x30); }
+
+// unbuffered busses read NeoPixelBus, at full brightness nothing is lost
+static void checkUnbuffered(uint8_t type, uint8_t colorOrder) {
+  Bus *bus = addBus(type, 300, colorOrder, false, true, 1);
+  TEST_ASSERT_NOT_NULL(bus);
+  fillRandom(bus, 0, 300);
+  TEST_ASSERT_EQUAL_UINT32(oldPowerSum(bus, false), bus->getPowerSum(false));
+  TEST_ASSERT_EQUAL_UINT32(oldPowerSum(bus, true),  bus->getPowerSum(true));
+}
+
+void test_unbuffered_rgb()  { checkUnbuffered(TYPE_WS2812_RGB, COL_ORDER_BRG); }
+void test_unbuffered_rgbw() { checkUnbuffered(TYPE_SK6812_RGBW, COL_ORDER_GRB); }
+
+// W swapped with an RGB channel: white must still be ignored by the WS2815 model
+void test_unbuffered_wswap() {
+  for (uint8_t swap = 1; swap <= 3; swap++) checkUnbuffered(TYPE_SK6812_RGBW, COL_ORDER_GRB | (swap << 4));
+  Bus *bus = addBus(TYPE_SK6812_RGBW, 10, COL_ORDER_GRB | 0x10, false);
+  bus->fill(0, 10, RGBW32(0, 0, 0, 255));           // white only
+  TEST_ASSERT_EQUAL_UINT32(0, bus->getPowerSum(true));
+  TEST_ASSERT_EQUAL_UINT32(2550, bus->getPowerSum(false));
+}
+
+// dimmed unbuffered busses: the sum is taken of the colors getPixelColor() restores from NeoPixelBus,
+// also when brightness changes after pixels were written (NeoPixelBus pixels are repainted)
+void test_unbuffered_dimmed() {
+  static const uint8_t bris[] = {1, 17, 128, 254};
+  for (uint8_t bri : bris) {
+    Bus *bus = addBus(TYPE_SK6812_RGBW, 300, COL_ORDER_GRB | 0x20, false, true, 2);
+    bus->setBrightness(bri);
+    fillRandom(bus, 0, 300);
+    uint32_t span[20];
+    for (auto &c : span) c = esp_random();
+    bus->setPixels(100, span, 20);
+    bus->fill(250, 30, RGBW32(10, 200, 30, 99));
+    for (bool ws2815 : {false, true}) TEST_ASSERT_EQUAL_UINT32(oldPowerSum(bus, ws2815), bus->getPowerSum(ws2815));
+    bus->setBrightness(255 - bri);
+    fillRandom(bus, 10, 40);
+    for (bool ws2815 : {false, true}) TEST_ASSERT_EQUAL_UINT32(oldPowerSum(bus, ws2815), bus->getPowerSum(ws2815));
+    bus->setBrightness(bri);
+    for (bool ws2815 : {false, true}) TEST_ASSERT_EQUAL_UINT32(oldPowerSum(bus, ws2815), bus->getPowerSum(ws2815));
+  }
+}
+
+// the ABL estimate itself (currentMilliamps after show()), WS2815 (milliampsPerLed 255) included
+// copy of estimateCurrentAndLimitBri() before bus power sums
+static size_t oldCurrentMilliamps() {
+  bool useWackyWS2815PowerModel = false;
+  byte actualMilliampsPerLed = strip.milliampsPerLed;
+  if (strip.milliampsPerLed == 255) {
+    useWackyWS2815PowerModel = true;
+    actualMilliampsPerLed = 12;
+  }
+  size_t powerBudget = (strip.ablMilliampsMax - MA_FOR_ESP);
+  size_t pLen = 0;
+  size_t powerSum = 0;
+  for (uint_fast8_t bNum = 0; bNum < busses.getNumBusses(); bNum++) {
+    Bus *bus = busses.getBus(bNum);
+    if (!IS_DIGITAL(bus->getType())) continue;
+    pLen += bus->getLength();
+    uint32_t busPowerSum = oldPowerSum(bus, useWackyWS2815PowerModel);
+    if (bus->hasWhite()) {
+      busPowerSum *= 3;
+      busPowerSum >>= 2;
+    }
+    powerSum += busPowerSum;
+  }
+  if (powerBudget > pLen) powerBudget -= pLen;
+  else                    powerBudget = 0;
+  powerSum = (powerSum * actualMilliampsPerLed) / 765;
+  uint8_t bri = strip.getBrightness();
+  uint8_t newBri = bri;
+  if (powerSum * bri / 255 > powerBudget) {
+    float scale = (float)(powerBudget * 255) / (float)(powerSum * bri);
+    uint16_t scaleI = scale * 255;
+    uint8_t scaleB = (scaleI > 255) ? 255 : scaleI;
+    newBri = scale8(bri, scaleB) + 1;
+  }
+  return (powerSum * newBri) / 255 + MA_FOR_ESP + pLen;
+}
+
+static void checkAbl(uint8_t type) {
+  static const uint8_t models[] = {30, 55, 255};
+  static const uint16_t limits[] = {500, 2000, 20000};
+  hostStripSetup(300, type);
+  for (uint8_t mA : models) for (uint16_t max : limits) {
+    strip.milliampsPerLed = mA;
+    strip.ablMilliampsMax = max;
+    fillRandom(busses.getBus(0), 0, 300);
+    size_t expected = oldCurrentMilliamps(); // before show() as the bus is dimmed while sending
+    strip.show();
+    TEST_ASSERT_EQUAL_UINT32(expected, strip.currentMilliamps);
+  }
+  strip.ablMilliampsMax = 0;
+}
+
+void test_abl_rgb()  { checkAbl(TYPE_WS2812_RGB); }
+void test_abl_rgbw() { checkAbl(TYPE_SK6812_RGBW); }
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_buffered_rgb);
+  RUN_TEST(test_buffered_rgbw);
+  RUN_TEST(test_unbuffered_rgb);
+  RUN_TEST(test_unbuffered_rgbw);
+  RUN_TEST(test_unbuffered_wswap);
+  RUN_TEST(test_unbuffered_dimmed);
+  RUN_TEST(test_abl_rgb);
+  RUN_TEST(test_abl_rgbw);
+  busses.removeAll();
+  return UNITY_END();
+}
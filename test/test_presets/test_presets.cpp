@@ -0,0 +1,113 @@
+/*
+ * Offset index of presets.json: indexed reads have to return the same as scanning the file for the "id": key
+ * Preset cache: playlist entries are read ahead, cached presets apply without presets.json
+ */
+#include <unity.h>
+#include "wled.h"
+#include <HostStrip.h>
+
+static DynamicJsonDocument pdoc(2048);
+
+static void writePreset(unsigned id, unsigned size) {
+  char json[1024];
+  int len = snprintf(json, sizeof(json), "{\"n\":\"Preset %u\",\"bri\":%u,\"pad\":\"", id, id);
+  while (len < (int)size && len < (int)sizeof(json) - 3) json[len++] = 'a' + id % 26;
+  strcpy(json + len, "\"}");
+  deserializeJson(pdoc, json);
+  writeObjectToFileUsingId("/presets.json", id, &pdoc);
+}
+
+static void deletePresetId(unsigned id) {
+  StaticJsonDocument<24> empty;
+  writeObjectToFileUsingId("/presets.json", id, &empty);
+}
+
+// read every id both ways and compare (missing presets must be missing in both)
+static void checkAll() {
+  closeFile();
+  DynamicJsonDocument scanned(2048);
+  char key[10];
+  for (unsigned id = 1; id <= 250; id++) {
+    sprintf(key, "\"%d\":", id);
+    bool foundScan = readObjectFromFile("/presets.json", key, &scanned);
+    bool foundIndex = readObjectFromFileUsingId("/presets.json", id, &pdoc);
+    char msg[24];
+    snprintf(msg, sizeof(msg), "preset %u", id);
+    TEST_ASSERT_EQUAL_MESSAGE(foundScan, foundIndex, msg);
+    if (!foundScan) continue;
+    String a, b;
+    serializeJson(scanned, a);
+    serializeJson(pdoc, b);
+    TEST_ASSERT_TRUE_MESSAGE(a == b, msg);
+    TEST_ASSERT_EQUAL_MESSAGE(id, pdoc["bri"].as<unsigned>(), msg);
+  }
+}
+
+void setUp() {
+  WLED_FS.remove("/presets.json");
+  invalidatePresetIndex();
+}
+void tearDown() {
+  closeFile();
+}
+
+void test_index_writes() {
+  for (unsigned id = 1; id <= 120; id++) writePreset(id, 50 + id % 200);
+  checkAll();
+  for (unsigned id = 1; id <= 120; id += 7) deletePresetId(id);
+  checkAll();
+  for (unsigned id = 3; id <= 120; id += 5) writePreset(id, 600); // larger, moves to free space or end of file
+  for (unsigned id = 8; id <= 120; id += 9) writePreset(id, 20);  // smaller, rewritten in place
+  writePreset(250, 100);
+  checkAll();
+}
+
+// file replaced without invalidatePresetIndex() (size changes), index is rebuilt
+void test_index_file_replaced() {
+  for (unsigned id = 1; id <= 50; id++) writePreset(id, 100);
+  checkAll();
+  closeFile();
+  File pf = WLED_FS.open("/presets.json", "w");
+  pf.print("{\"0\":{},\"7\":{\"bri\":7},\"3\":{\"bri\":3,\"n\":\"x\"}}");
+  pf.close();
+  checkAll();
+  TEST_ASSERT_TRUE(readObjectFromFileUsingId("/presets.json", 3, &pdoc));
+  TEST_ASSERT_FALSE(readObjectFromFileUsingId("/presets.json", 4, &pdoc));
+}
+
+static bool apply(byte id) {
+  applyPreset(id);
+  handlePresets();
+  return errorFlag == ERR_NONE;
+}
+
+void test_cache_playlist() {
+  hostStripSetup(30); // applying presets updates segments
+  for (unsigned id = 1; id <= 5; id++) writePreset(id, 100);
+  deserializeJson(pdoc, "{\"n\":\"List\",\"playlist\":{\"ps\":[2,3,4],\"dur\":[100],\"transition\":[0],\"repeat\":0}}");
+  writeObjectToFileUsingId("/presets.json", 10, &pdoc);
+  closeFile();
+  invalidatePresetCache();
+
+  TEST_ASSERT_TRUE(apply(10));      // loads playlist
+  for (int i = 0; i < 5; i++) handlePresets(); // idle loop reads playlist entries into cache
+  WLED_FS.remove("/presets.json");  // behind our back, entries have to come from cache now
+  invalidatePresetIndex();
+  for (byte id : {2, 3, 4}) {
+    bri = 0;
+    TEST_ASSERT_TRUE(apply(id));
+    TEST_ASSERT_EQUAL(id, bri);
+  }
+  TEST_ASSERT_FALSE(apply(5));      // not in playlist, not cached
+  markPresetCacheDirty();           // e.g. presets.json deleted using /edit, from web server task
+  TEST_ASSERT_FALSE(apply(3));      // cache is dropped in handlePresets() before the preset is read
+  unloadPlaylist();
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_index_writes);
+  RUN_TEST(test_index_file_replaced);
+  RUN_TEST(test_cache_playlist);
+  return UNITY_END();
+}
@@ -0,0 +1,89 @@
+/*
+ * Frame scheduler: micros() based pacing has to survive long pauses of service() and report slow frame rates
+ */
+#include <unity.h>
+#include "wled.h"
+#include <HostStrip.h>
+
+void setUp() {
+  hostStripSetup(60);
+  strip.ablMilliampsMax = 0;
+  strip.getMainSegment().setMode(FX_MODE_RAINBOW);
+}
+void tearDown() {
+  strip.setTargetFps(WLED_FPS);
+}
+
+// renders for up to ms (1 ms steps) and returns number of frames shown
+static unsigned serviceFor(unsigned ms) {
+  const uint32_t shows = hostBusShowCount;
+  for (unsigned i = 0; i < ms; i++) {
+    hostAdvanceTime(1000);
+    strip.service();
+  }
+  return hostBusShowCount - shows;
+}
+
+// loop() does not call service() while lights are off or in realtime mode, pauses of 35.8-71.6 min wrap micros() differences
+void test_resume_after_pause() {
+  for (unsigned pauseMin : {1U, 40U, 70U}) {
+    TEST_ASSERT_GREATER_THAN(0, serviceFor(100));
+    hostAdvanceTime(pauseMin * 60ULL * 1000000ULL);
+    TEST_ASSERT_GREATER_THAN(0, serviceFor(2 * strip.getFrameTime() + 1));
+  }
+}
+
+// frame intervals of slow frame rates are not capped
+void test_slow_frame_interval() {
+  strip.setTargetFps(10);
+  serviceFor(2000);
+  uint32_t ft = strip.getFrameInterval(50);
+  TEST_ASSERT_GREATER_THAN(90000, ft);
+  TEST_ASSERT_LESS_THAN(110000, ft);
+}
+
+// frames keep being paced while micros() wraps (every 71.6 min), also on 64 bit hosts with 64 bit unsigned long
+void test_micros_wrap() {
+  hostSetTime(0x100000000ULL - 100000);
+  TEST_ASSERT_GREATER_THAN(0, serviceFor(100)); // up to the wrap
+  TEST_ASSERT_GREATER_THAN(2, serviceFor(100)); // after it
+}
+
+// busses send asynchronously (2x slower than getWireTime() estimates, so frames have to wait for the long bus):
+// next frame is rendered while previous one is still being sent, each bus reports how long it blocked a frame
+void test_async_output() {
+  busses.removeAll();
+  uint8_t pins0[5] = {2, 255, 255, 255, 255}, pins1[5] = {3, 255, 255, 255, 255};
+  BusConfig bc0(TYPE_WS2812_RGB, pins0, 0, 100);
+  BusConfig bc1(TYPE_WS2812_RGB, pins1, 100, 1000);
+  busses.add(bc0);
+  busses.add(bc1);
+  strip.finalizeInit();
+  strip.makeAutoSegments(true);
+  strip.getMainSegment().setMode(FX_MODE_RAINBOW);
+  hostBusPixelUs = 60;
+  serviceFor(500);
+  bool renderedWhileSending = false;
+  for (unsigned i = 0; i < 500; i++) {
+    uint16_t call = strip.getMainSegment().call;
+    uint32_t shows = hostBusShowCount;
+    serviceFor(1);
+    if (strip.getMainSegment().call != call && hostBusShowCount == shows && !busses.getBus(1)->canShow()) renderedWhileSending = true;
+  }
+  hostBusPixelUs = 0;
+  TEST_ASSERT_TRUE(renderedWhileSending);
+  TEST_ASSERT_LESS_THAN(2000, busses.getBus(0)->getWaitTime());    // short bus was done long before
+  TEST_ASSERT_GREATER_THAN(25000, busses.getBus(1)->getWaitTime()); // 60ms transfer, frame rendered after ~30ms
+  TEST_ASSERT_LESS_THAN(32000, busses.getBus(1)->getWaitTime());
+  TEST_ASSERT_GREATER_THAN(busses.getBus(1)->getWaitTime() - 1, strip.getDeferTime());
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_resume_after_pause);
+  RUN_TEST(test_slow_frame_interval);
+  RUN_TEST(test_micros_wrap);
+  RUN_TEST(test_async_output);
+  busses.removeAll();
+  return UNITY_END();
+}
@@ -0,0 +1,139 @@
+/*
+ * Binary WebSocket protocol (ws.cpp): malformed commands from the network must be rejected without
+ * applying partial operations, deltas sent to subscribers applied as commands restore the same state
+ */
+#include <unity.h>
+#include "wled.h"
+#include <HostStrip.h>
+
+#define OP_ON      0x01
+#define OP_BRI     0x02
+#define OP_SEG_ON  0x10
+#define OP_SEG_COL 0x12
+#define OP_SEG_SX  0x15
+#define OP_SEG_BOUNDS 0x17
+#define OP_SUB     0x7F
+
+static AsyncWebSocketClient *client;
+
+static void command(std::vector<uint8_t> ops, AsyncWebSocketClient *c = nullptr) {
+  if (!c) c = client;
+  ops.insert(ops.begin(), {'C', 1});
+  handleWsBinaryCommand(ops.data(), ops.size(), c->id());
+}
+
+static size_t errors(AsyncWebSocketClient *c) {
+  size_t n = 0;
+  for (const String &t : c->hostTexts()) if (t == "{\"error\":9}") n++;
+  return n;
+}
+
+void setUp() {
+  hostStripSetup(30);
+  client = ws.hostAddClient();
+  bri = briLast = 128;
+  strip.getSegment(0).setColor(0, BLACK);
+  strip.getSegment(0).speed = 10;
+}
+void tearDown() {}
+
+// operation without (complete) payload is an error, operations before it are applied, the truncated one is not
+void test_truncated() {
+  std::vector<std::vector<uint8_t>> bad = {
+    {OP_BRI},
+    {OP_SEG_SX, 0},
+    {OP_SEG_COL, 0, 0, 255, 255},
+    {OP_SEG_BOUNDS, 0, 0, 0, 5},
+    {0x55, 1}, // unknown opcode
+  };
+  for (auto &ops : bad) {
+    size_t n = errors(client);
+    command(ops);
+    TEST_ASSERT_EQUAL(n + 1, errors(client));
+  }
+  TEST_ASSERT_EQUAL(128, bri);
+  TEST_ASSERT_EQUAL(10, strip.getSegment(0).speed);
+  TEST_ASSERT_EQUAL_HEX32(BLACK, strip.getSegment(0).colors[0]);
+  TEST_ASSERT_EQUAL(30, strip.getSegment(0).stop);
+
+  command({OP_BRI, 60, OP_SEG_SX, 0});
+  TEST_ASSERT_EQUAL(60, bri);
+  TEST_ASSERT_EQUAL(10, strip.getSegment(0).speed);
+
+  size_t n = errors(client);
+  const uint8_t shortMsg[] = {'C'};
+  handleWsBinaryCommand(shortMsg, sizeof(shortMsg), client->id());
+  const uint8_t version[] = {'C', 99, OP_BRI, 1};
+  handleWsBinaryCommand(version, sizeof(version), client->id());
+  TEST_ASSERT_EQUAL(n + 2, errors(client));
+  TEST_ASSERT_EQUAL(60, bri);
+}
+
+// segment ids beyond the segments in use (and MAX_NUM_SEGMENTS) are ignored, 255 (selected) not for bounds
+void test_segment_range() {
+  size_t segs = strip.getSegmentsNum();
+  for (uint8_t id : {uint8_t(segs), uint8_t(MAX_NUM_SEGMENTS), uint8_t(200), uint8_t(254)}) {
+    command({OP_SEG_SX, id, 99, OP_SEG_COL, id, 0, 1, 2, 3, 4, OP_SEG_BOUNDS, id, 0, 0, 5, 0});
+  }
+  command({OP_SEG_BOUNDS, 255, 0, 0, 5, 0});
+  TEST_ASSERT_EQUAL(segs, strip.getSegmentsNum());
+  TEST_ASSERT_EQUAL(10, strip.getSegment(0).speed);
+  TEST_ASSERT_EQUAL(30, strip.getSegment(0).stop);
+  TEST_ASSERT_EQUAL(0, errors(client));
+
+  command({OP_SEG_SX, 255, 99}); // all selected segments
+  TEST_ASSERT_EQUAL(99, strip.getSegment(0).speed);
+}
+
+// delta of a subscriber contains the change, full state delta applied as command restores state
+void test_delta_round_trip() {
+  AsyncWebSocketClient *sub = ws.hostAddClient();
+  command({OP_SUB}, sub);
+  TEST_ASSERT_EQUAL(1, sub->hostBinaries().size()); // full state
+  TEST_ASSERT_EQUAL('D', sub->hostBinaries()[0][0]);
+
+  command({OP_ON, 1, OP_BRI, 77, OP_SEG_COL, 0, 0, 10, 20, 30, 40, OP_SEG_SX, 0, 123});
+  TEST_ASSERT_EQUAL(2, sub->hostBinaries().size());
+  std::vector<uint8_t> delta = sub->hostBinaries()[1];
+  std::vector<uint8_t> expect = {'D', 1, OP_BRI, 77, OP_SEG_SX, 0, 123, OP_SEG_COL, 0, 0, 10, 20, 30, 40};
+  TEST_ASSERT_EQUAL(expect.size(), delta.size());
+  TEST_ASSERT_TRUE(delta == expect);
+
+  AsyncWebSocketClient *sub2 = ws.hostAddClient();
+  command({OP_SUB}, sub2);
+  std::vector<uint8_t> full = sub2->hostBinaries().back();
+  bri = 5;
+  strip.getSegment(0).setColor(0, BLACK);
+  strip.getSegment(0).speed = 1;
+  full[0] = 'C';
+  handleWsBinaryCommand(full.data(), full.size(), client->id());
+  TEST_ASSERT_EQUAL(0, errors(client));
+  TEST_ASSERT_EQUAL(77, bri);
+  TEST_ASSERT_EQUAL_HEX32(RGBW32(10, 20, 30, 40), strip.getSegment(0).colors[0]);
+  TEST_ASSERT_EQUAL(123, strip.getSegment(0).speed);
+  sub->close();
+  sub2->close();
+}
+
+// resubscribing after an earlier slot was freed must not add the client twice
+void test_resubscribe() {
+  AsyncWebSocketClient *a = ws.hostAddClient();
+  AsyncWebSocketClient *b = ws.hostAddClient();
+  command({OP_SUB}, a);
+  command({OP_SUB}, b);
+  a->close();
+  command({OP_SUB}, b); // slot of a is free now
+  b->hostBinaries().clear();
+  command({OP_BRI, 33});
+  TEST_ASSERT_EQUAL(1, b->hostBinaries().size());
+  b->close();
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_truncated);
+  RUN_TEST(test_segment_range);
+  RUN_TEST(test_delta_round_trip);
+  RUN_TEST(test_resubscribe);
+  return UNITY_END();
+}
@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+"""
+Converts WLED ledmap JSON files (ledmapN.json, 2d-gaps.json) into compact
+binary ledmaps (.lmb) which WLED streams directly into its mapping table.
+
+usage: ledmap2lmb.py [--no-rle] input.json [output.lmb]
+
+ledmapN.json is {"n":"name","map":[...]}, 2d-gaps.json is a plain array.
+Negative values (no LED) are stored as 0xFFFF.
+Run length encoding of monotone runs is used if it makes the file smaller.
+See readLedmapFile() in wled00/file.cpp for the format description.
+"""
+
+import json
+import os
+import struct
+import sys
+
+LMB_VERSION = 1
+LMB_FLAG_RLE = 0x01
+MAX_RUN = 0x3FFF
+STEP_INC, STEP_DEC, STEP_SAME = 0, 1, 2
+
+
+def encode_runs(values):
+    runs = []
+    i = 0
+    while i < len(values):
+        first = values[i]
+        step = STEP_SAME
+        if i + 1 < len(values):
+            diff = (values[i + 1] - first) & 0xFFFF
+            step = {1: STEP_INC, 0xFFFF: STEP_DEC, 0: STEP_SAME}.get(diff, STEP_INC)
+        delta = {STEP_INC: 1, STEP_DEC: -1, STEP_SAME: 0}[step]
+        run = 1
+        while i + run < len(values) and run < MAX_RUN and values[i + run] == (first + run * delta) & 0xFFFF:
+            run += 1
+        runs.append(struct.pack("<HH", first, run | (step << 14)))
+        i += run
+    return b"".join(runs)
+
+
+def convert(doc, rle=True):
+    if isinstance(doc, dict):
+        name = doc.get("n", "")
+        values = doc.get("map", [])
+    else:
+        name = ""
+        values = doc
+    if len(values) > 0xFFFF:
+        raise ValueError("ledmap has more than 65535 entries")
+    values = [0xFFFF if v < 0 else int(v) & 0xFFFF for v in values]
+    name = name.encode("utf-8")[:32]
+
+    flags = 0
+    data = struct.pack("<%dH" % len(values), *values)
+    if rle:
+        packed = encode_runs(values)
+        if len(packed) < len(data):
+            flags |= LMB_FLAG_RLE
+            data = packed
+
+    header = b"LMB" + struct.pack("<BHBB", LMB_VERSION, len(values), flags, len(name))
+    return header + name + data
+
+
+def main(argv):
+    rle = "--no-rle" not in argv
+    args = [a for a in argv if a != "--no-rle"]
+    if not args or len(args) > 2:
+        print(__doc__.strip())
+        return 1
+    src = args[0]
+    dst = args[1] if len(args) > 1 else os.path.splitext(src)[0] + ".lmb"
+    with open(src, "r") as f:
+        doc = json.load(f)
+    out = convert(doc, rle)
+    with open(dst, "wb") as f:
+        f.write(out)
+    print("%s -> %s (%d bytes, %s)" % (src, dst, len(out), "RLE" if out[6] & LMB_FLAG_RLE else "raw"))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
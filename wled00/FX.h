@@ -79,20 +79,68 @@
   #endif
 #endif
 
+/* Segment runtime data is allocated from a fixed arena (allocated once) to avoid heap fragmentation.
+  Arena holds MAX_SEGMENT_DATA plus block headers and alignment for data and transition copy of each segment.
+  Transition copies are accounted against MAX_SEGMENT_DATA, so both always fit. */
+#ifndef SEGMENT_ARENA_SIZE
+  #define SEGMENT_ARENA_SIZE (((MAX_SEGMENT_DATA + 3) & ~3) + 16*MAX_NUM_SEGMENTS)
+#endif
+
 /* How much data bytes each segment should max allocate to leave enough space for other segments,
   assuming each segment uses the same amount of data. 256 for ESP8266, 640 for ESP32. */
 #define FAIR_DATA_PER_SEG (MAX_SEGMENT_DATA / strip.getMaxSegments())
 
 #define MIN_SHOW_DELAY   (_frametime < 16 ? 8 : 15)
 
+/* number of recent frame intervals kept for jitter statistics (see WS2812FX::getFrameInterval()) */
+#ifndef WLED_FRAME_STATS
+  #define WLED_FRAME_STATS 64
+#endif
+
+/* dual core ESP32 can run effects of independent segments on both cores (see WS2812FX::service())
+   each render context has its own effect environment (SEGMENT, SEGLEN, SEGCOLOR, SEGPALETTE):
+   loop() (FX_CTX_LOOP), the FX render task (FX_CTX_WORKER) and one shared by all other tasks (FX_CTX_OTHER,
+   e.g. async web server callbacks using setPixelSegment()) so they never change the environment of a running effect */
+#if defined(ARDUINO_ARCH_ESP32) && !CONFIG_FREERTOS_UNICORE
+  #define WLED_FX_CORES    2 // render contexts running effects
+  #define FX_CTX_LOOP      0
+  #define FX_CTX_WORKER    1
+  #define FX_CTX_OTHER     2
+  #define WLED_FX_CONTEXTS 3
+  // render context of the calling task (set by WS2812FX::service() and WS2812FX::renderTask(), FX_CTX_OTHER elsewhere)
+  extern __thread uint8_t fxContext;
+  #define FX_CTX           fxContext
+  #include "freertos/FreeRTOS.h"
+  #include "freertos/task.h"
+  #include "freertos/semphr.h"
+#else
+  #define WLED_FX_CORES    1
+  #define WLED_FX_CONTEXTS 1
+  #define FX_CTX           0
+#endif
+
+/* lazily expanded 256 entry palette (color_from_palette() lookup table) for each rendering core (2kB per core) */
+#if !defined(ESP8266) && !defined(WLED_DISABLE_PALETTE_LUT)
+  #define WLED_PALETTE_LUT
+#endif
+
+/* number of finished transitions (and their previous effect frame buffers) kept for reuse */
+#ifndef TRANSITION_POOL_SIZE
+  #ifdef ESP8266
+    #define TRANSITION_POOL_SIZE 2
+  #else
+    #define TRANSITION_POOL_SIZE 4
+  #endif
+#endif
+
 #define NUM_COLORS       3 /* number of colors per segment */
 #define SEGMENT          strip._segments[strip.getCurrSegmentId()]
 #define SEGENV           strip._segments[strip.getCurrSegmentId()]
 //#define SEGCOLOR(x)      strip._segments[strip.getCurrSegmentId()].currentColor(x, strip._segments[strip.getCurrSegmentId()].colors[x])
 //#define SEGLEN           strip._segments[strip.getCurrSegmentId()].virtualLength()
 #define SEGCOLOR(x)      strip.segColor(x) /* saves us a few kbytes of code */
-#define SEGPALETTE       strip._currentPalette
-#define SEGLEN           strip._virtualSegmentLength /* saves us a few kbytes of code */
+#define SEGPALETTE       strip._currentPalette[FX_CTX]
+#define SEGLEN           strip._virtualSegmentLength[FX_CTX] /* saves us a few kbytes of code */
 #define SPEED_FORMULA_L  (5U + (50U*(255U - SEGMENT.speed))/SEGLEN)
 
 // some common colors
@@ -414,19 +462,46 @@ typedef struct Segment {
     uint16_t        _dataLen;
     static uint16_t _usedSegmentData;
 
+    // optional working frame buffer (virtual pixels, before opacity/grouping/mirroring is applied)
+    uint32_t       *_pixels;
+    uint16_t        _pixelsLen;
+    bool            _pixelsDirty; // buffer has changed since last flushPixelBuffer()
+
+    // compiled 1D mapping plan: for each virtual pixel _mapStride bus pixels (bus 0xFF = skip)
+    // with grouping, spacing, reverse, mirror, offset, ledmap and bus lookup already applied
+    typedef struct {
+      uint16_t pix;             // pixel index within bus
+      uint8_t  bus;             // BusManager bus number
+    } mappedpixel_t;
+    mappedpixel_t  *_map;
+    uint16_t        _mapLen;
+    uint8_t         _mapStride;
+    struct {                    // segment parameters the plan was compiled for
+      uint16_t _start, _stop, _offset;
+      uint8_t  _grouping, _spacing;
+      bool     _reverse : 1;
+      bool     _mirror  : 1;
+      bool     _valid   : 1;    // plan compiled (_map may still be nullptr if allocation failed)
+      bool     _inUse   : 1;    // plan checked current for the frame being rendered/flushed (see useMappingPlan())
+      uint32_t _gen;            // WS2812FX::_mappingGen at compile time
+    } _mapKey;
+
     // perhaps this should be per segment, not static
     static CRGBPalette16 _randomPalette;      // actual random palette
     static CRGBPalette16 _newRandomPalette;   // target random palette
     static unsigned long _lastPaletteChange;  // last random palette change time in millis()
     #ifndef WLED_DISABLE_MODE_BLEND
-    static bool          _modeBlend;          // mode/effect blending semaphore
+    static bool          _modeBlend[WLED_FX_CONTEXTS]; // mode/effect blending semaphore (one for each render context)
     #endif
 
-    // transition data, valid only if transitional==true, holds values during transition (72 bytes)
+    // transition data, valid only if transitional==true, holds values during transition
     struct Transition {
       #ifndef WLED_DISABLE_MODE_BLEND
       tmpsegd_t     _segT;        // previous segment environment
       uint8_t       _modeT;       // previous mode/effect
+      uint32_t     *_pixT;        // frame buffer of previous mode (kept when transition is returned to pool)
+      uint16_t      _pixTCap;     // allocated size of _pixT (in pixels)
+      uint16_t      _pixTLen;     // pixels in use, 0 if previous mode is not rendered into _pixT (yet)
       #else
       uint32_t      _colorT[NUM_COLORS];
       #endif
@@ -437,13 +512,25 @@ typedef struct Segment {
       unsigned long _start;       // must accommodate millis()
       uint16_t      _dur;
       Transition(uint16_t dur=750)
+        #ifndef WLED_DISABLE_MODE_BLEND
+        : _pixT(nullptr)
+        , _pixTCap(0)
+        , _pixTLen(0)
+        , _palT(CRGBPalette16(CRGB::Black))
+        #else
         : _palT(CRGBPalette16(CRGB::Black))
+        #endif
         , _prevPaletteBlends(0)
         , _start(millis())
         , _dur(dur)
       {}
     } *_t;
 
+    static Transition *_transitionPool[TRANSITION_POOL_SIZE]; // finished transitions ready for reuse
+    static uint8_t     _transitionPoolLen;
+    static Transition *newTransition(uint16_t dur);
+    static void        releaseTransition(Transition *t);
+
   public:
 
     Segment(uint16_t sStart=0, uint16_t sStop=30) :
@@ -477,6 +564,13 @@ typedef struct Segment {
       data(nullptr),
       _capabilities(0),
       _dataLen(0),
+      _pixels(nullptr),
+      _pixelsLen(0),
+      _pixelsDirty(false),
+      _map(nullptr),
+      _mapLen(0),
+      _mapStride(0),
+      _mapKey(),
       _t(nullptr)
     {
       #ifdef WLED_DEBUG
@@ -502,13 +596,15 @@ typedef struct Segment {
       if (name) { delete[] name; name = nullptr; }
       stopTransition();
       deallocateData();
+      deallocatePixelBuffer();
+      deallocateMappingPlan();
     }
 
     Segment& operator= (const Segment &orig); // copy assignment
     Segment& operator= (Segment &&orig) noexcept; // move assignment
 
 #ifdef WLED_DEBUG
-    size_t getSize() const { return sizeof(Segment) + (data?_dataLen:0) + (name?strlen(name):0) + (_t?sizeof(Transition):0); }
+    size_t getSize() const { return sizeof(Segment) + (data?_dataLen:0) + (name?strlen(name):0) + (_t?sizeof(Transition):0) + (_pixels?_pixelsLen*sizeof(uint32_t):0) + (_map?_mapLen*_mapStride*sizeof(mappedpixel_t):0); }
 #endif
 
     inline bool     getOption(uint8_t n) const { return ((options >> n) & 0x01); }
@@ -527,10 +623,27 @@ typedef struct Segment {
 
     static uint16_t getUsedSegmentData(void)    { return _usedSegmentData; }
     static void     addUsedSegmentData(int len) { _usedSegmentData += len; }
+
+    // segment data arena
+    typedef struct ArenaStats {
+      uint32_t size;        // arena size in bytes (0 if not allocated)
+      uint32_t used;        // bytes in used blocks (including headers)
+      uint32_t free;        // sum of free block payloads
+      uint32_t maxFree;     // largest free block payload
+      uint16_t blocks;      // number of used blocks
+      uint16_t fails;       // allocations that did not fit into arena and were served from heap
+      uint16_t compactions; // number of arena compactions
+      uint16_t transition;  // segment data duplicated for mode blending (included in used segment data)
+    } arenastats_t;
+    static byte *allocSegmentData(size_t len);
+    static void  freeSegmentData(byte *ptr);
+    static void  compactSegmentData(void);
+    static void  getArenaStats(arenastats_t &st);
     #ifndef WLED_DISABLE_MODE_BLEND
-    static void     modeBlend(bool blend)       { _modeBlend = blend; }
+    static void     modeBlend(bool blend)       { _modeBlend[FX_CTX] = blend; }
     #endif
     static void     handleRandomPalette();
+    static void     flushTransitionPool();      // frees finished transitions kept for reuse (and their frame buffers)
 
     void    setUp(uint16_t i1, uint16_t i2, uint8_t grp=1, uint8_t spc=0, uint16_t ofs=UINT16_MAX, uint16_t i1Y=0, uint16_t i2Y=1, uint8_t segId = 255);
     bool    setColor(uint8_t slot, uint32_t c); //returns true if changed
@@ -555,6 +668,20 @@ typedef struct Segment {
       */
     inline void markForReset(void) { reset = true; }  // setOption(SEG_OPTION_RESET, true)
 
+    // frame buffer functions (effects render into the buffer, it is composited to the strip in WS2812FX::show())
+    inline bool hasPixelBuffer(void) const { return _pixels != nullptr; }
+    bool allocatePixelBuffer(void);
+    void deallocatePixelBuffer(void);
+    void flushPixelBuffer(void);
+    static uint32_t transitionColor(uint32_t c1, uint32_t c2, unsigned i, bool wiped, uint16_t prog);
+
+    // compiled pixel mapping functions (1D segments only)
+    bool isMappingPlanCurrent(void) const;
+    void updateMappingPlan(void);
+    void deallocateMappingPlan(void);
+    // validity of the plan is checked once per frame instead of in each setPixelColor() (segment options may change between frames)
+    inline void useMappingPlan(bool use) { _mapKey._inUse = use && _map && isMappingPlanCurrent(); }
+
     // transition functions
     void     startTransition(uint16_t dur); // transition has to start before actual segment values change
     void     stopTransition(void);
@@ -562,6 +689,9 @@ typedef struct Segment {
     #ifndef WLED_DISABLE_MODE_BLEND
     void     swapSegenv(tmpsegd_t &tmpSegD);
     void     restoreSegenv(tmpsegd_t &tmpSegD);
+    bool     prepareTransitionBuffer(void); // previous mode renders into its own frame buffer (blended in flushPixelBuffer())
+    inline bool hasTransitionBuffer(void) const { return _t && _pixels && _t->_pixTLen && _t->_pixTLen == _pixelsLen; }
+    inline void swapTransitionBuffer(void) { std::swap(_pixels, _t->_pixT); }
     #endif
     uint16_t progress(void); //transition progression between 0-65535
     uint8_t  currentBri(bool useCct = false);
@@ -694,9 +824,8 @@ class WS2812FX {  // 96 bytes
       panels(1),
 #endif
       // semi-private (just obscured) used in effect functions through macros
-      _currentPalette(CRGBPalette16(CRGB::Black)),
-      _colors_t{0,0,0},
-      _virtualSegmentLength(0),
+      _colors_t(),
+      _virtualSegmentLength(),
       // true private variables
       _length(DEFAULT_LED_COUNT),
       _brightness(DEFAULT_BRIGHTNESS),
@@ -704,16 +833,31 @@ class WS2812FX {  // 96 bytes
       _targetFps(WLED_FPS),
       _frametime(FRAMETIME_FIXED),
       _cumulativeFps(2),
+      _frameUs(1000000UL/WLED_FPS),
+      _frameUsOverride(0),
+      _frameSlotUs(0),
+      _nextServiceUs(0),
+      _lastShowUs(0),
+      _lastServiceMs(0),
+      _frameIntervals(),
+      _frameIntervalPos(0),
+      _frameIntervalCnt(0),
+      _effectTime(0),
+      _showTime(0),
+      _deferTime(0),
+      _pendingUs(0),
       _isServicing(false),
       _isOffRefreshRequired(false),
       _hasWhiteChannel(false),
       _triggered(false),
+      _showPending(false),
       _modeCount(MODE_COUNT),
       _callback(nullptr),
       customMappingTable(nullptr),
       customMappingSize(0),
+      _mappingGen(0),
       _lastShow(0),
-      _segment_index(0),
+      _segment_index(),
       _mainSegment(0),
       _queuedChangesSegId(255),
       _qStart(0),
@@ -723,8 +867,20 @@ class WS2812FX {  // 96 bytes
       _qGrouping(0),
       _qSpacing(0),
       _qOffset(0)
+#if WLED_FX_CORES > 1
+      , _renderTask(nullptr)
+      , _renderDone(nullptr)
+      , _renderQueueLen(0)
+      , _renderNow(0)
+      , _renderWorkerTime(0)
+      , _renderTimeSaved(0)
+#endif
     {
       WS2812FX::instance = this;
+      for (auto &pal : _currentPalette) pal = CRGBPalette16(CRGB::Black);
+#ifdef WLED_PALETTE_LUT
+      memset(_paletteLUTValid, 0, sizeof(_paletteLUTValid));
+#endif
       _mode.reserve(_modeCount);     // allocate memory to prevent initial fragmentation (does not increase size())
       _modeData.reserve(_modeCount); // allocate memory to prevent initial fragmentation (does not increase size())
       if (_mode.capacity() <= 1 || _modeData.capacity() <= 1) _modeCount = 1; // memory allocation failed only show Solid
@@ -755,6 +911,7 @@ class WS2812FX {  // 96 bytes
       setCCT(uint16_t k),
       setBrightness(uint8_t b, bool direct = false),
       setRange(uint16_t i, uint16_t i2, uint32_t col),
+      setPixels(uint16_t start, const uint32_t *c, uint16_t count),
       setTransitionMode(bool t),
       purgeSegments(bool force = false),
       setSegment(uint8_t n, uint16_t start, uint16_t stop, uint8_t grouping = 1, uint8_t spacing = 0, uint16_t offset = UINT16_MAX, uint16_t startY=0, uint16_t stopY=1),
@@ -806,7 +963,7 @@ class WS2812FX {  // 96 bytes
     inline uint8_t getBrightness(void) { return _brightness; }
     inline uint8_t getMaxSegments(void) { return MAX_NUM_SEGMENTS; }  // returns maximum number of supported segments (fixed value)
     inline uint8_t getSegmentsNum(void) { return _segments.size(); }  // returns currently present segments
-    inline uint8_t getCurrSegmentId(void) { return _segment_index; }
+    inline uint8_t getCurrSegmentId(void) { return _segment_index[FX_CTX]; }
     inline uint8_t getMainSegmentId(void) { return _mainSegment; }
     inline uint8_t getPaletteCount() { return 13 + GRADIENT_PALETTE_COUNT; }  // will only return built-in palette count
     inline uint8_t getTargetFps() { return _targetFps; }
@@ -820,8 +977,21 @@ class WS2812FX {  // 96 bytes
       getFps();
 
     inline uint16_t getFrameTime(void) { return _frametime; }
+    inline uint32_t getEffectTime(void) { return _effectTime; } // average time (us) spent in effect functions per frame
+    inline uint32_t getShowTime(void) { return _showTime; }     // average time (us) spent in show() per frame
+    inline uint32_t getDeferTime(void) { return _deferTime; }   // average time (us) a rendered frame waited until busses could take it
+#if WLED_FX_CORES > 1
+    inline uint32_t getRenderTimeSaved(void) { return _renderTimeSaved; } // average time (us) per frame saved by rendering on both cores
+#else
+    inline uint32_t getRenderTimeSaved(void) { return 0; }
+#endif
     inline uint16_t getMinShowDelay(void) { return MIN_SHOW_DELAY; }
+    inline uint32_t getTargetFrameTime(void) { return _frameUs; } // target frame interval (us)
+    long alignFrames(uint32_t showUs); // align frame pacing to external clock (frame sync), showUs in micros()
+    void setFrameTimeOverride(uint32_t us); // frame interval of frame sync master (us, 0 = target FPS), target FPS is kept
+    uint32_t getFrameInterval(uint8_t percentile); // percentile of recent frame intervals (us)
     inline uint16_t getLength(void) { return _length; } // 2D matrix may have less pixels than W*H
+    inline uint16_t getMappedPixelIndex(uint16_t i) { if (i < customMappingSize) i = customMappingTable[i]; return i < _length ? i : 0xFFFFU; } // logical -> physical (0xFFFF if unmapped)
     inline uint16_t getTransition(void) { return _transitionDur; }
 
     uint32_t
@@ -830,7 +1000,7 @@ class WS2812FX {  // 96 bytes
       getPixelColor(uint16_t);
 
     inline uint32_t getLastShow(void) { return _lastShow; }
-    inline uint32_t segColor(uint8_t i) { return _colors_t[i]; }
+    inline uint32_t segColor(uint8_t i) { return _colors_t[FX_CTX][i]; }
 
     const char *
       getModeData(uint8_t id = 0) { return (id && id<_modeCount) ? _modeData[id] : PSTR("Solid"); }
@@ -889,13 +1059,17 @@ class WS2812FX {  // 96 bytes
   // end 2D support
 
     void loadCustomPalettes(void); // loads custom palettes from JSON
-    CRGBPalette16 _currentPalette; // palette used for current effect (includes transition)
+    CRGBPalette16 _currentPalette[WLED_FX_CONTEXTS]; // palette used for current effect (includes transition)
+#ifdef WLED_PALETTE_LUT
+    uint32_t _paletteLUT[WLED_FX_CORES][256];    // _currentPalette expanded to 256 colors (filled on demand by color_from_palette())
+    uint32_t _paletteLUTValid[WLED_FX_CORES][8]; // bitmap of valid _paletteLUT entries (cleared for each rendered segment)
+#endif
     std::vector<CRGBPalette16> customPalettes; // TODO: move custom palettes out of WS2812FX class
 
     // using public variables to reduce code size increase due to inline function getSegment() (with bounds checking)
     // and color transitions
-    uint32_t _colors_t[3]; // color used for effect (includes transition)
-    uint16_t _virtualSegmentLength;
+    uint32_t _colors_t[WLED_FX_CONTEXTS][3]; // color used for effect (includes transition)
+    uint16_t _virtualSegmentLength[WLED_FX_CONTEXTS];
 
     std::vector<segment> _segments;
     friend class Segment;
@@ -908,6 +1082,19 @@ class WS2812FX {  // 96 bytes
     uint8_t  _targetFps;
     uint16_t _frametime;
     uint16_t _cumulativeFps;
+    uint32_t _frameUs;            // target frame interval (us)
+    uint32_t _frameUsOverride;    // frame interval set by frame sync follower (0 = derived from _targetFps)
+    uint32_t _frameSlotUs;   // micros() time slot of last frame (frames are paced from slot to slot, not from actual show())
+    uint32_t _nextServiceUs; // micros() when service() has to do something next
+    uint32_t _lastShowUs;
+    unsigned long _lastServiceMs; // millis() of last service() call (loop() does not call it while off or in realtime mode)
+    uint32_t _frameIntervals[WLED_FRAME_STATS]; // recent intervals between show() calls (us, below 1s)
+    uint8_t  _frameIntervalPos;
+    uint8_t  _frameIntervalCnt;
+    uint32_t _effectTime; // running average of effect rendering time (us)
+    uint32_t _showTime;   // running average of show() time (us)
+    uint32_t _deferTime;  // running average of time (us) a rendered frame waited for busses before show()
+    uint32_t _pendingUs;  // micros() when pending frame was rendered
 
     // will require only 1 byte
     struct {
@@ -915,6 +1102,7 @@ class WS2812FX {  // 96 bytes
       bool _isOffRefreshRequired : 1; //periodic refresh is required for the strip to remain off.
       bool _hasWhiteChannel      : 1;
       bool _triggered            : 1;
+      bool _showPending          : 1; // frame is rendered but busses were still sending previous one
     };
 
     uint8_t                  _modeCount;
@@ -925,20 +1113,37 @@ class WS2812FX {  // 96 bytes
 
     uint16_t* customMappingTable;
     uint16_t  customMappingSize;
+    uint32_t  _mappingGen; // incremented whenever ledmap or strip length changes (invalidates Segment mapping plans)
 
     unsigned long _lastShow;
 
-    uint8_t _segment_index;
+    uint8_t _segment_index[WLED_FX_CONTEXTS]; // segment currently being rendered (or selected by setPixelSegment()) in each context
     uint8_t _mainSegment;
     uint8_t _queuedChangesSegId;
     uint16_t _qStart, _qStop, _qStartY, _qStopY;
     uint8_t _qGrouping, _qSpacing;
     uint16_t _qOffset;
 
+#if WLED_FX_CORES > 1
+    // render task running effects on the other core
+    TaskHandle_t      _renderTask;
+    SemaphoreHandle_t _renderDone;
+    uint8_t           _renderQueue[MAX_NUM_SEGMENTS]; // segments to be rendered by render task
+    uint8_t           _renderQueueLen;
+    unsigned long     _renderNow;        // millis() of the frame being rendered
+    uint32_t          _renderWorkerTime; // time (us) render task spent in last frame
+    uint32_t          _renderTimeSaved;  // running average of time saved by parallel rendering (us)
+
+    static void renderTask(void *parameter);
+#endif
+
     uint8_t
       estimateCurrentAndLimitBri(void);
 
     void
+      loadSegmentPalette(segment &seg, unsigned ctx),
+      renderSegment(uint8_t segId, unsigned long nowUp),
+      scheduleNextService(unsigned long nowUp, bool shown),
       setUpSegmentFromQueuedChanges(void);
 };
 
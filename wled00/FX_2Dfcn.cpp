@@ -40,6 +40,7 @@ void WS2812FX::setUpMatrix() {
   if (customMappingTable != nullptr) delete[] customMappingTable;
   customMappingTable = nullptr;
   customMappingSize = 0;
+  _mappingGen++; // invalidate segment mapping plans
 
   // isMatrix is set in cfg.cpp or set.cpp
   if (isMatrix) {
@@ -85,12 +86,29 @@ void WS2812FX::setUpMatrix() {
       // content of the file is just raw JSON array in the form of [val1,val2,val3,...]
       // there are no other "key":"value" pairs in it
       // allowed values are: -1 (missing pixel/no LED attached), 0 (inactive/unused pixel), 1 (active/used pixel)
-      char    fileName[32]; strcpy_P(fileName, PSTR("/2d-gaps.json")); // reduce flash footprint
-      bool    isFile = WLED_FS.exists(fileName);
+      // gap array may also be stored as binary "2d-gaps.lmb" (see tools/ledmap2lmb.py)
+      char    fileName[32]; strcpy_P(fileName, PSTR("/2d-gaps.lmb")); // reduce flash footprint
+      bool    isBinary = WLED_FS.exists(fileName);
+      if (!isBinary) strcpy_P(fileName, PSTR("/2d-gaps.json"));
+      bool    isFile = isBinary || WLED_FS.exists(fileName);
       size_t  gapSize = 0;
       int8_t *gapTable = nullptr;
 
-      if (isFile && requestJSONBufferLock(20)) {
+      uint16_t *gapMap = nullptr;
+      uint16_t  gapLen = 0;
+      if (isBinary && readLedmapFile(fileName, &gapMap, &gapLen)) {
+        DEBUG_PRINT(F("Reading LED gap from "));
+        DEBUG_PRINTLN(fileName);
+        gapSize = gapLen;
+        if (gapSize >= customMappingSize) {
+          gapTable = new int8_t[gapSize];
+          if (gapTable) for (size_t i = 0; i < gapSize; i++) {
+            gapTable[i] = constrain((int16_t)gapMap[i], -1, 1); // 0xFFFF is -1
+          }
+        }
+        delete[] gapMap;
+        DEBUG_PRINTLN(F("Gaps loaded."));
+      } else if (isFile && !isBinary && requestJSONBufferLock(20)) {
         DEBUG_PRINT(F("Reading LED gap from "));
         DEBUG_PRINTLN(fileName);
         // read the array into global JSON buffer
@@ -175,6 +193,17 @@ void IRAM_ATTR Segment::setPixelColorXY(int x, int y, uint32_t col)
   if (!isActive()) return; // not active
   if (x >= virtualWidth() || y >= virtualHeight() || x<0 || y<0) return;  // if pixel would fall out of virtual segment just exit
 
+  if (_pixels && is2D()) { // render into frame buffer
+    unsigned i = x + y * virtualWidth();
+    if (i >= _pixelsLen) return;
+#ifndef WLED_DISABLE_MODE_BLEND
+    if (_modeBlend[FX_CTX]) col = color_blend(_pixels[i], col, 0xFFFFU - progress(), true);
+#endif
+    _pixels[i] = col;
+    _pixelsDirty = true;
+    return;
+  }
+
   uint8_t _bri_t = currentBri();
   if (_bri_t < 255) {
     byte r = scale8(R(col), _bri_t);
@@ -200,7 +229,7 @@ void IRAM_ATTR Segment::setPixelColorXY(int x, int y, uint32_t col)
 
 #ifndef WLED_DISABLE_MODE_BLEND
       // if blending modes, blend with underlying pixel
-      if (_modeBlend) tmpCol = color_blend(strip.getPixelColorXY(start + xX, startY + yY), col, 0xFFFFU - progress(), true);
+      if (_modeBlend[FX_CTX]) tmpCol = color_blend(strip.getPixelColorXY(start + xX, startY + yY), col, 0xFFFFU - progress(), true);
 #endif
 
       strip.setPixelColorXY(start + xX, startY + yY, tmpCol);
@@ -268,6 +297,10 @@ void Segment::setPixelColorXY(float x, float y, uint32_t col, bool aa)
 uint32_t Segment::getPixelColorXY(uint16_t x, uint16_t y) {
   if (!isActive()) return 0; // not active
   if (x >= virtualWidth() || y >= virtualHeight() || x<0 || y<0) return 0;  // if pixel would fall out of virtual segment just exit
+  if (_pixels && is2D()) { // exact value from frame buffer
+    unsigned i = x + y * virtualWidth();
+    return i < _pixelsLen ? _pixels[i] : 0;
+  }
   if (reverse  ) x = virtualWidth()  - x - 1;
   if (reverse_y) y = virtualHeight() - y - 1;
   if (transpose) { uint16_t t = x; x = y; y = t; } // swap X & Y if segment transposed
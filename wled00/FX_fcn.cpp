@@ -31,6 +31,7 @@
   Custom per-LED mapping has moved!
 
   Create a file "ledmap.json" using the edit page.
+  Large maps can be converted to compact binary "ledmap.lmb" using tools/ledmap2lmb.py
 
   this is just an example (30 LEDs). It will first set all even, then all uneven LEDs.
   {"map":[
@@ -82,9 +83,180 @@ CRGBPalette16 Segment::_newRandomPalette = CRGBPalette16(DEFAULT_COLOR);
 unsigned long Segment::_lastPaletteChange = 0; // perhaps it should be per segment
 
 #ifndef WLED_DISABLE_MODE_BLEND
-bool Segment::_modeBlend = false;
+bool Segment::_modeBlend[WLED_FX_CONTEXTS] = {false};
 #endif
 
+Segment::Transition *Segment::_transitionPool[TRANSITION_POOL_SIZE] = {nullptr};
+uint8_t Segment::_transitionPoolLen = 0;
+
+#if WLED_FX_CORES > 1
+__thread uint8_t fxContext = FX_CTX_OTHER; // see FX_CTX
+
+// guards data shared by effects running on both cores (segment data accounting, random palette)
+static portMUX_TYPE fxMux = portMUX_INITIALIZER_UNLOCKED;
+  #define FX_LOCK()   portENTER_CRITICAL(&fxMux)
+  #define FX_UNLOCK() portEXIT_CRITICAL(&fxMux)
+#else
+  #define FX_LOCK()
+  #define FX_UNLOCK()
+#endif
+
+/*
+ * Segment runtime data arena
+ * All segment data (and its transition copies) is allocated from one fixed block of heap
+ * so that frequent effect and preset changes do not fragment the heap. Blocks are allocated
+ * first-fit, each has a 4 byte header (31 bit payload length, used flag) and 4 byte aligned payload;
+ * adjacent free blocks are merged. If a request does not fit due to fragmentation it is
+ * served from the heap and the arena is compacted before the next frame (compactSegmentData()).
+ */
+typedef struct ArenaHeader {
+  uint32_t len  : 31; // payload length (multiple of 4), arena may be larger than 64k (SEGMENT_ARENA_SIZE, PSRAM)
+  uint32_t used : 1;
+} arenahdr_t;
+static_assert(sizeof(arenahdr_t) == 4, "arena block header must keep payload 4 byte aligned");
+
+static byte    *segArena = nullptr;
+static bool     segArenaCompact = false; // compaction requested
+static uint16_t segArenaFails = 0;
+static uint16_t segArenaCompactions = 0;
+
+static inline bool inSegArena(const byte *ptr) { return segArena && ptr >= segArena && ptr < segArena + SEGMENT_ARENA_SIZE; }
+static inline arenahdr_t *segArenaBlock(size_t pos) { return (arenahdr_t*)(segArena + pos); }
+
+static void initSegArena() {
+  if (segArena) return;
+  byte *arena;
+#if defined(ARDUINO_ARCH_ESP32) && defined(BOARD_HAS_PSRAM) && defined(WLED_SEGMENT_DATA_PSRAM)
+  if (psramFound()) arena = (byte*) ps_malloc(SEGMENT_ARENA_SIZE); // opt-in: PSRAM is slower but saves internal RAM
+  else
+#endif
+  arena = (byte*) malloc(SEGMENT_ARENA_SIZE);
+  if (!arena) { DEBUG_PRINTLN(F("!!! Segment data arena allocation failed. !!!")); return; }
+  ((arenahdr_t*)arena)->len  = SEGMENT_ARENA_SIZE - sizeof(arenahdr_t);
+  ((arenahdr_t*)arena)->used = false;
+  FX_LOCK(); // publish initialised arena only (retry after failed boot allocation may run while effects render)
+  segArena = arena;
+  FX_UNLOCK();
+}
+
+// arena is allocated in WS2812FX::finalizeInit() (never here, malloc() is not allowed in FX_LOCK() critical section)
+byte *Segment::allocSegmentData(size_t len) {
+  len = (len + 3) & ~3U;
+  byte *ptr = nullptr;
+  size_t freeSum = 0;
+  FX_LOCK();
+  for (size_t pos = 0; segArena && pos < SEGMENT_ARENA_SIZE; ) {
+    arenahdr_t *h = segArenaBlock(pos);
+    if (!h->used) {
+      // merge following free blocks
+      size_t next = pos + sizeof(arenahdr_t) + h->len;
+      while (next < SEGMENT_ARENA_SIZE && !segArenaBlock(next)->used) {
+        h->len += sizeof(arenahdr_t) + segArenaBlock(next)->len;
+        next = pos + sizeof(arenahdr_t) + h->len;
+      }
+      if (h->len >= len) {
+        if (h->len >= len + sizeof(arenahdr_t)) { // split block
+          arenahdr_t *rest = segArenaBlock(pos + sizeof(arenahdr_t) + len);
+          rest->len  = h->len - len - sizeof(arenahdr_t);
+          rest->used = false;
+          h->len = len;
+        }
+        h->used = true;
+        ptr = segArena + pos + sizeof(arenahdr_t);
+        break;
+      }
+      freeSum += h->len;
+    }
+    pos += sizeof(arenahdr_t) + h->len;
+  }
+  if (!ptr && segArena) {
+    segArenaFails++;
+    if (freeSum >= len) segArenaCompact = true; // enough space but fragmented
+  }
+  FX_UNLOCK();
+  if (!ptr) ptr = (byte*) malloc(len); // arena full (or unavailable), use heap
+  return ptr;
+}
+
+void Segment::freeSegmentData(byte *ptr) {
+  if (!ptr) return;
+  if (!inSegArena(ptr)) { free(ptr); return; }
+  FX_LOCK();
+  segArenaBlock(ptr - segArena - sizeof(arenahdr_t))->used = false; // merged with neighbours on next allocation
+  FX_UNLOCK();
+}
+
+// moves all used arena blocks to the start of the arena (updating segment data pointers)
+// must not be called while effects are running
+void Segment::compactSegmentData() {
+  if (!segArena || !segArenaCompact) return;
+  segArenaCompact = false;
+  // collect owners of arena blocks
+  byte **owners[2*MAX_NUM_SEGMENTS];
+  size_t nOwners = 0;
+  for (segment &seg : strip._segments) {
+    if (inSegArena(seg.data)) owners[nOwners++] = &seg.data;
+    #ifndef WLED_DISABLE_MODE_BLEND
+    if (seg._t && inSegArena(seg._t->_segT._dataT)) owners[nOwners++] = &seg._t->_segT._dataT;
+    #endif
+  }
+  size_t wr = 0;
+  for (size_t rd = 0; rd < SEGMENT_ARENA_SIZE; ) {
+    arenahdr_t *h = segArenaBlock(rd);
+    const size_t blk = sizeof(arenahdr_t) + h->len;
+    if (h->used) {
+      byte **owner = nullptr;
+      for (size_t i = 0; i < nOwners; i++) if (*owners[i] == segArena + rd + sizeof(arenahdr_t)) { owner = owners[i]; break; }
+      if (!owner) {
+        // unknown owner, block can not be moved; leave a free block in front of it
+        if (wr < rd) {
+          segArenaBlock(wr)->len  = rd - wr - sizeof(arenahdr_t);
+          segArenaBlock(wr)->used = false;
+        }
+        wr = rd + blk;
+      } else {
+        if (wr < rd) {
+          memmove(segArena + wr, segArena + rd, blk);
+          *owner = segArena + wr + sizeof(arenahdr_t);
+        }
+        wr += blk;
+      }
+    }
+    rd += blk;
+  }
+  if (wr < SEGMENT_ARENA_SIZE) {
+    segArenaBlock(wr)->len  = SEGMENT_ARENA_SIZE - wr - sizeof(arenahdr_t);
+    segArenaBlock(wr)->used = false;
+  }
+  segArenaCompactions++;
+  DEBUG_PRINTLN(F("Segment data arena compacted."));
+}
+
+void Segment::getArenaStats(arenastats_t &st) {
+  memset(&st, 0, sizeof(st));
+  st.fails       = segArenaFails;
+  st.compactions = segArenaCompactions;
+  #ifndef WLED_DISABLE_MODE_BLEND
+  for (const segment &seg : strip._segments) if (seg._t) st.transition += seg._t->_segT._dataLenT;
+  #endif
+  if (!segArena) return;
+  st.size = SEGMENT_ARENA_SIZE;
+  size_t runFree = 0; // adjacent free blocks count as one
+  for (size_t pos = 0; pos < SEGMENT_ARENA_SIZE; ) {
+    arenahdr_t *h = segArenaBlock(pos);
+    if (h->used) {
+      st.used += sizeof(arenahdr_t) + h->len;
+      st.blocks++;
+      runFree = 0;
+    } else {
+      st.free += h->len;
+      runFree += (runFree ? sizeof(arenahdr_t) : 0) + h->len;
+      if (runFree > st.maxFree) st.maxFree = runFree;
+    }
+    pos += sizeof(arenahdr_t) + h->len;
+  }
+}
+
 // copy constructor
 Segment::Segment(const Segment &orig) {
   //DEBUG_PRINTF("-- Copy segment constructor: %p -> %p\n", &orig, this);
@@ -93,6 +265,11 @@ Segment::Segment(const Segment &orig) {
   name = nullptr;
   data = nullptr;
   _dataLen = 0;
+  _pixels = nullptr; // frame buffer is not copied, it will be re-allocated in service()
+  _pixelsLen = 0;
+  _map = nullptr;    // neither is mapping plan, it will be re-compiled in service()
+  _mapLen = 0;
+  _mapKey._valid = _mapKey._inUse = false;
   if (orig.name) { name = new char[strlen(orig.name)+1]; if (name) strcpy(name, orig.name); }
   if (orig.data) { if (allocateData(orig._dataLen)) memcpy(data, orig.data, orig._dataLen); }
 }
@@ -105,6 +282,11 @@ Segment::Segment(Segment &&orig) noexcept {
   orig.name = nullptr;
   orig.data = nullptr;
   orig._dataLen = 0;
+  orig._pixels = nullptr;
+  orig._pixelsLen = 0;
+  orig._map = nullptr;
+  orig._mapLen = 0;
+  orig._mapKey._valid = orig._mapKey._inUse = false;
 }
 
 // copy assignment
@@ -115,11 +297,18 @@ Segment& Segment::operator= (const Segment &orig) {
     if (name) { delete[] name; name = nullptr; }
     stopTransition();
     deallocateData();
+    deallocatePixelBuffer();
+    deallocateMappingPlan();
     // copy source
     memcpy((void*)this, (void*)&orig, sizeof(Segment));
     // erase pointers to allocated data
     data = nullptr;
     _dataLen = 0;
+    _pixels = nullptr;
+    _pixelsLen = 0;
+    _map = nullptr;
+    _mapLen = 0;
+    _mapKey._valid = _mapKey._inUse = false;
     // copy source data
     if (orig.name) { name = new char[strlen(orig.name)+1]; if (name) strcpy(name, orig.name); }
     if (orig.data) { if (allocateData(orig._dataLen)) memcpy(data, orig.data, orig._dataLen); }
@@ -134,10 +323,17 @@ Segment& Segment::operator= (Segment &&orig) noexcept {
     if (name) { delete[] name; name = nullptr; } // free old name
     stopTransition();
     deallocateData(); // free old runtime data
+    deallocatePixelBuffer();
+    deallocateMappingPlan();
     memcpy((void*)this, (void*)&orig, sizeof(Segment));
     orig.name = nullptr;
     orig.data = nullptr;
     orig._dataLen = 0;
+    orig._pixels = nullptr;
+    orig._pixelsLen = 0;
+    orig._map = nullptr;
+    orig._mapLen = 0;
+    orig._mapKey._valid = orig._mapKey._inUse = false;
     orig._t   = nullptr; // old segment cannot be in transition
   }
   return *this;
@@ -151,16 +347,24 @@ bool Segment::allocateData(size_t len) {
   //DEBUG_PRINTF("--   Allocating data (%d): %p\n", len, this);
   deallocateData();
   if (len == 0) return false; // nothing to do
+  FX_LOCK();
   if (Segment::getUsedSegmentData() + len > MAX_SEGMENT_DATA) {
+    FX_UNLOCK();
     // not enough memory
     DEBUG_PRINT(F("!!! Effect RAM depleted: "));
     DEBUG_PRINTF("%d/%d !!!\n", len, Segment::getUsedSegmentData());
     return false;
   }
-  // do not use SPI RAM on ESP32 since it is slow
-  data = (byte*) malloc(len);
-  if (!data) { DEBUG_PRINTLN(F("!!! Allocation failed. !!!")); return false; } //allocation failed
-  Segment::addUsedSegmentData(len);
+  Segment::addUsedSegmentData(len); // reserve before allocating, effect on other core may allocate too
+  FX_UNLOCK();
+  data = allocSegmentData(len);
+  if (!data) { //allocation failed
+    FX_LOCK();
+    Segment::addUsedSegmentData(-(int)len);
+    FX_UNLOCK();
+    DEBUG_PRINTLN(F("!!! Allocation failed. !!!"));
+    return false;
+  }
   //DEBUG_PRINTF("---  Allocated data (%p): %d/%d -> %p\n", this, len, Segment::getUsedSegmentData(), data);
   _dataLen = len;
   memset(data, 0, len);
@@ -171,7 +375,7 @@ void Segment::deallocateData() {
   if (!data) { _dataLen = 0; return; }
   //DEBUG_PRINTF("---  Released data (%p): %d/%d -> %p\n", this, _dataLen, Segment::getUsedSegmentData(), data);
   if ((Segment::getUsedSegmentData() > 0) && (_dataLen > 0)) { // check that we don't have a dangling / inconsistent data pointer
-    free(data);
+    freeSegmentData(data);
   } else {
     DEBUG_PRINT(F("---- Released data "));
     DEBUG_PRINTF("(%p): ", this);
@@ -180,10 +384,194 @@ void Segment::deallocateData() {
     DEBUG_PRINTLN(F(", cowardly refusing to free nothing."));
   }
   data = nullptr;
+  FX_LOCK();
   Segment::addUsedSegmentData(_dataLen <= Segment::getUsedSegmentData() ? -_dataLen : -Segment::getUsedSegmentData());
+  FX_UNLOCK();
   _dataLen = 0;
 }
 
+/**
+  * Allocates (or resizes) optional frame buffer holding one uint32_t for each
+  * virtual pixel of the segment (vW*vH for 2D segments, virtualLength() for 1D).
+  * Effects render into this buffer so that getPixelColor() returns exact values
+  * without reading back from the busses. Returns false if buffer is not available
+  * in which case pixels are written directly to the strip.
+  */
+bool Segment::allocatePixelBuffer() {
+  if (!isActive()) {
+    deallocatePixelBuffer();
+    return false;
+  }
+  size_t len = is2D() ? virtualWidth() * virtualHeight() : virtualLength();
+  if (_pixels && _pixelsLen == len) return true;
+  deallocatePixelBuffer();
+  if (len == 0 || len > UINT16_MAX) return false;
+  // do not use SPI RAM on ESP32 since it is slow
+  _pixels = (uint32_t*) malloc(len * sizeof(uint32_t));
+  if (!_pixels) { DEBUG_PRINTLN(F("!!! Pixel buffer allocation failed. !!!")); return false; }
+  memset(_pixels, 0, len * sizeof(uint32_t));
+  _pixelsLen = len;
+  _pixelsDirty = false;
+  return true;
+}
+
+void Segment::deallocatePixelBuffer() {
+  if (_pixels) free(_pixels);
+  _pixels = nullptr;
+  _pixelsLen = 0;
+  _pixelsDirty = false;
+}
+
+/**
+  * Composites frame buffer to the strip, applying opacity, grouping, spacing,
+  * reverse, mirroring and 1D->2D mapping the same way direct writes do.
+  * Only buffers that changed since last flush are written so pixels set
+  * directly on the strip (realtime, overlays) are not overwritten.
+  */
+void Segment::flushPixelBuffer() {
+  if (!_pixels || !_pixelsDirty || !isActive()) return;
+  uint32_t *pixels = _pixels;
+  // while effects are blended previous mode has its own frame buffer, both are blended here
+  const uint32_t *oldPixels = nullptr;
+  uint16_t prog = 0xFFFFU;
+#ifndef WLED_DISABLE_MODE_BLEND
+  if (hasTransitionBuffer() && currentMode() != mode) {
+    oldPixels = _t->_pixT;
+    prog = progress();
+    if (transitionCurve == TRANSITION_EASE) prog = ((uint64_t)prog * prog * (3U * 0xFFFFU - 2U * prog)) / (0xFFFFULL * 0xFFFFULL); // smoothstep
+  }
+#endif
+  _pixels = nullptr; // temporarily detach buffer so setPixelColor() writes to the strip
+  useMappingPlan(true);
+  if (is2D()) {
+    const uint16_t cols = virtualWidth();
+    const uint16_t rows = virtualHeight();
+    if (cols * rows == _pixelsLen) {
+      const unsigned edge = (cols * prog) >> 16; // wipe left to right
+      for (int y = 0; y < rows; y++) for (int x = 0; x < cols; x++) {
+        const unsigned i = x + y * cols;
+        setPixelColorXY(x, y, oldPixels ? transitionColor(oldPixels[i], pixels[i], i, x < edge, prog) : pixels[i]);
+      }
+    }
+  } else {
+    const uint16_t len = MIN(_pixelsLen, virtualLength());
+    const unsigned edge = (len * prog) >> 16;
+    if (oldPixels) for (int i = 0; i < len; i++) setPixelColor(i, transitionColor(oldPixels[i], pixels[i], i, i < edge, prog));
+    else           for (int i = 0; i < len; i++) setPixelColor(i, pixels[i]);
+  }
+  useMappingPlan(false);
+  _pixels = pixels;
+  _pixelsDirty = false;
+}
+
+/**
+  * Blends pixel i of previous (c1) and new (c2) effect according to transitionCurve.
+  * wiped tells if wipe transition has already passed the pixel, prog is (curve adjusted) progress.
+  */
+uint32_t Segment::transitionColor(uint32_t c1, uint32_t c2, unsigned i, bool wiped, uint16_t prog) {
+  switch (transitionCurve) {
+    case TRANSITION_WIPE    : return wiped ? c2 : c1;
+    case TRANSITION_DISSOLVE: return ((i * 2654435761U) >> 16) < prog ? c2 : c1; // multiplicative hash gives fixed random order
+    default                 : return color_blend(c1, c2, prog, true);
+  }
+}
+
+// bus and pixel within that bus of physical LED index (bus 0xFF if no bus has it)
+// returns false if more than one bus contains index (overlapping busses all have to be written)
+static bool findBusPixel(uint16_t index, uint8_t &bus, uint16_t &pix) {
+  bus = 0xFF;
+  pix = 0;
+  if (index == 0xFFFFU) return true;
+  for (uint8_t b = 0; b < busses.getNumBusses(); b++) {
+    Bus *bp = busses.getBus(b);
+    if (index < bp->getStart() || index >= bp->getStart() + bp->getLength()) continue;
+    if (bus != 0xFF) return false;
+    bus = b;
+    pix = index - bp->getStart();
+  }
+  return true;
+}
+
+/**
+  * Compiles 1D mapping plan: a table holding bus and bus pixel for each
+  * virtual pixel with grouping, spacing, reverse, mirror, offset and ledmap
+  * (customMappingTable) already applied, so setPixelColor() can skip the
+  * per-pixel index math and bus lookup. Plan is only rebuilt if segment
+  * parameters, ledmap or strip length (busses) changed since it was last compiled.
+  * Busses are created before WS2812FX::finalizeInit() which invalidates all plans.
+  */
+void Segment::updateMappingPlan() {
+  if (!useMappingPlans) { deallocateMappingPlan(); return; } // compare with per-pixel index math (benchmark)
+  if (isMappingPlanCurrent()) return; // up to date (or allocation failed for these parameters, do not retry each frame)
+  deallocateMappingPlan();
+  _mapKey._start    = start;
+  _mapKey._stop     = stop;
+  _mapKey._offset   = offset;
+  _mapKey._grouping = grouping;
+  _mapKey._spacing  = spacing;
+  _mapKey._reverse  = reverse;
+  _mapKey._mirror   = mirror;
+  _mapKey._gen      = strip._mappingGen;
+  _mapKey._valid    = true;
+
+  if (!isActive() || is2D()) return; // 2D segments are mapped in setPixelColorXY()
+#ifndef WLED_DISABLE_2D
+  if (Segment::maxHeight != 1 && start < Segment::maxWidth*Segment::maxHeight) return; // 1D segment on a matrix uses setPixelColorXY()
+#endif
+
+  const uint16_t vLen = virtualLength();
+  const uint8_t  stride = grouping * (mirror ? 2 : 1);
+  if (vLen == 0 || stride == 0) return;
+  _map = (mappedpixel_t*) malloc(vLen * stride * sizeof(mappedpixel_t));
+  if (!_map) { DEBUG_PRINTLN(F("!!! Mapping plan allocation failed. !!!")); return; }
+  _mapLen    = vLen;
+  _mapStride = stride;
+
+  // replicate index math of setPixelColor() and record resulting bus pixels
+  const uint16_t len = length();
+  mappedpixel_t *m = _map;
+  for (int v = 0; v < vLen; v++) {
+    int i = v * groupLength();
+    if (reverse) i = mirror ? (len - 1) / 2 - i : (len - 1) - i;
+    i += start;
+    for (int j = 0; j < grouping; j++) {
+      uint16_t indexSet = i + (reverse ? -j : j);
+      uint16_t indexMir = 0xFFFFU;
+      if (indexSet >= start && indexSet < stop) {
+        if (mirror) {
+          indexMir = stop - indexSet + start - 1 + offset;
+          if (indexMir >= stop) indexMir -= len;
+        }
+        indexSet += offset;
+        if (indexSet >= stop) indexSet -= len;
+      } else {
+        indexSet = 0xFFFFU;
+      }
+      bool single = !mirror || findBusPixel(strip.getMappedPixelIndex(indexMir), m->bus, m->pix); // mirrored pixel is set first
+      if (mirror) m++;
+      single = single && findBusPixel(strip.getMappedPixelIndex(indexSet), m->bus, m->pix);
+      m++;
+      if (!single) { deallocateMappingPlan(); _mapKey._valid = true; return; } // overlapping busses, keep using index math
+    }
+  }
+}
+
+// true if plan was compiled for current segment parameters, ledmap and strip length
+bool Segment::isMappingPlanCurrent() const {
+  return _mapKey._valid && _mapKey._gen == strip._mappingGen
+      && _mapKey._start == start && _mapKey._stop == stop && _mapKey._offset == offset
+      && _mapKey._grouping == grouping && _mapKey._spacing == spacing
+      && _mapKey._reverse == reverse && _mapKey._mirror == mirror;
+}
+
+void Segment::deallocateMappingPlan() {
+  if (_map) free(_map);
+  _map = nullptr;
+  _mapLen = 0;
+  _mapStride = 0;
+  _mapKey._valid = _mapKey._inUse = false;
+}
+
 /**
   * If reset of this segment was requested, clears runtime
   * settings of this segment.
@@ -220,18 +608,30 @@ CRGBPalette16 &Segment::loadPalette(CRGBPalette16 &targetPalette, uint8_t pal) {
     case 0: //default palette. Exceptions for specific effects above
       targetPalette = PartyColors_p; break;
     case 1: {//periodically replace palette with a random one
-      unsigned long timeSinceLastChange = millis() - _lastPaletteChange;
-      if (timeSinceLastChange > randomPaletteChangeTime * 1000U) {
-        _randomPalette = _newRandomPalette;
-        _newRandomPalette = CRGBPalette16(
+      // segments with random palette may be rendered on both cores: new palette is generated and blended
+      // outside of the lock, only copies and the swap are done under it
+      const unsigned long changeMs = randomPaletteChangeTime * 1000U;
+      if (millis() - _lastPaletteChange > changeMs) {
+        CRGBPalette16 newPalette = CRGBPalette16(
                         CHSV(random8(), random8(160, 255), random8(128, 255)),
                         CHSV(random8(), random8(160, 255), random8(128, 255)),
                         CHSV(random8(), random8(160, 255), random8(128, 255)),
                         CHSV(random8(), random8(160, 255), random8(128, 255)));
-        _lastPaletteChange = millis();
-        handleRandomPalette(); // do a 1st pass of blend
+        FX_LOCK();
+        CRGBPalette16 blended = _newRandomPalette;
+        FX_UNLOCK();
+        nblendPaletteTowardPalette(blended, newPalette, 48); // do a 1st pass of blend (see handleRandomPalette())
+        FX_LOCK();
+        if (millis() - _lastPaletteChange > changeMs) { // not changed by the other core meanwhile
+          _randomPalette     = blended;
+          _newRandomPalette  = newPalette;
+          _lastPaletteChange = millis();
+        }
+        FX_UNLOCK();
       }
+      FX_LOCK();
       targetPalette = _randomPalette;
+      FX_UNLOCK();
       break;}
     case 2: {//primary color only
       CRGB prim = gamma32(colors[0]);
@@ -290,7 +690,7 @@ void Segment::startTransition(uint16_t dur) {
   if (isInTransition()) return; // already in transition no need to store anything
 
   // starting a transition has to occur before change so we get current values 1st
-  _t = new Transition(dur); // no previous transition running
+  _t = newTransition(dur); // no previous transition running
   if (!_t) return; // failed to allocate data
 
   //DEBUG_PRINTF("-- Started transition: %p\n", this);
@@ -304,11 +704,20 @@ void Segment::startTransition(uint16_t dur) {
     _t->_segT._dataLenT = 0;
     _t->_segT._dataT    = nullptr;
     if (_dataLen > 0 && data) {
-      _t->_segT._dataT = (byte *)malloc(_dataLen);
+      // duplicate counts against MAX_SEGMENT_DATA like any other segment data (old effect runs without data if it does not fit)
+      FX_LOCK();
+      bool fits = Segment::getUsedSegmentData() + _dataLen <= MAX_SEGMENT_DATA;
+      if (fits) Segment::addUsedSegmentData(_dataLen);
+      FX_UNLOCK();
+      if (fits) _t->_segT._dataT = allocSegmentData(_dataLen);
       if (_t->_segT._dataT) {
         //DEBUG_PRINTF("--  Allocated duplicate data (%d): %p\n", _dataLen, _t->_segT._dataT);
         memcpy(_t->_segT._dataT, data, _dataLen);
         _t->_segT._dataLenT = _dataLen;
+      } else if (fits) {
+        FX_LOCK();
+        Segment::addUsedSegmentData(-(int)_dataLen);
+        FX_UNLOCK();
       }
     }
   } else {
@@ -325,16 +734,75 @@ void Segment::stopTransition() {
     #ifndef WLED_DISABLE_MODE_BLEND
     if (_t->_segT._dataT && _t->_segT._dataLenT > 0) {
       //DEBUG_PRINTF("--  Released duplicate data (%d): %p\n", _t->_segT._dataLenT, _t->_segT._dataT);
-      free(_t->_segT._dataT);
+      freeSegmentData(_t->_segT._dataT);
+      FX_LOCK();
+      Segment::addUsedSegmentData(_t->_segT._dataLenT <= Segment::getUsedSegmentData() ? -_t->_segT._dataLenT : -Segment::getUsedSegmentData());
+      FX_UNLOCK();
       _t->_segT._dataT = nullptr;
       _t->_segT._dataLenT = 0;
     }
     #endif
-    delete _t;
+    releaseTransition(_t);
     _t = nullptr;
   }
 }
 
+// get transition from pool (its frame buffer is reused too) or allocate a new one
+Segment::Transition *Segment::newTransition(uint16_t dur) {
+  Transition *t = nullptr;
+  FX_LOCK();
+  if (_transitionPoolLen > 0) t = _transitionPool[--_transitionPoolLen];
+  FX_UNLOCK();
+  if (!t) return new Transition(dur);
+#ifndef WLED_DISABLE_MODE_BLEND
+  uint32_t *pix = t->_pixT;
+  uint16_t  cap = t->_pixTCap;
+  *t = Transition(dur);
+  t->_pixT    = pix;
+  t->_pixTCap = cap;
+#else
+  *t = Transition(dur);
+#endif
+  return t;
+}
+
+// return finished transition to pool (or free it if pool is full)
+void Segment::releaseTransition(Transition *t) {
+  if (!t) return;
+#ifndef WLED_DISABLE_MODE_BLEND
+  if (!useSegmentBuffers && t->_pixT) { // frame buffer will not be needed
+    free(t->_pixT);
+    t->_pixT = nullptr;
+    t->_pixTCap = 0;
+  }
+#endif
+  FX_LOCK();
+  bool pooled = _transitionPoolLen < TRANSITION_POOL_SIZE;
+  if (pooled) _transitionPool[_transitionPoolLen++] = t;
+  FX_UNLOCK();
+  if (pooled) return;
+#ifndef WLED_DISABLE_MODE_BLEND
+  if (t->_pixT) free(t->_pixT);
+#endif
+  delete t;
+}
+
+// free pooled transitions and their frame buffers (segment buffers disabled, segments reset/purged or heap low)
+void Segment::flushTransitionPool() {
+  Transition *pool[TRANSITION_POOL_SIZE];
+  FX_LOCK();
+  size_t n = _transitionPoolLen;
+  memcpy(pool, _transitionPool, n * sizeof(Transition*));
+  _transitionPoolLen = 0;
+  FX_UNLOCK();
+  for (size_t i = 0; i < n; i++) {
+#ifndef WLED_DISABLE_MODE_BLEND
+    if (pool[i]->_pixT) free(pool[i]->_pixT);
+#endif
+    delete pool[i];
+  }
+}
+
 void Segment::handleTransition() {
   uint16_t _progress = progress();
   if (_progress == 0xFFFFU) stopTransition();
@@ -420,6 +888,37 @@ void Segment::restoreSegenv(tmpsegd_t &tmpSeg) {
   _dataLen  = tmpSeg._dataLenT;
   //DEBUG_PRINTF("--   temp seg data: %p (%d,%p)\n", this, _dataLen, data);
 }
+
+/**
+  * Sets up frame buffer the previous mode renders into while effects are blended.
+  * On first use it is initialised with the last frame of the previous mode (current
+  * frame buffer content) so effects reading back pixels continue seamlessly.
+  * Returns false if segment has no frame buffer or memory is not available, in which
+  * case previous mode is blended directly into the segment (old behaviour).
+  */
+bool Segment::prepareTransitionBuffer() {
+  if (!_t || !_pixels) return false;
+  if (_t->_pixTLen) return _t->_pixTLen == _pixelsLen; // segment dimensions changed during transition
+  if (_t->_pixTCap < _pixelsLen) {
+    if (_t->_pixT) free(_t->_pixT);
+    _t->_pixT = (uint32_t*) malloc(_pixelsLen * sizeof(uint32_t));
+    if (!_t->_pixT) { // buffers kept in transition pool may be what is missing
+      flushTransitionPool();
+      _t->_pixT = (uint32_t*) malloc(_pixelsLen * sizeof(uint32_t));
+    }
+    _t->_pixTCap = _t->_pixT ? _pixelsLen : 0;
+    if (!_t->_pixT) { DEBUG_PRINTLN(F("!!! Transition buffer allocation failed. !!!")); return false; }
+  } else if (_t->_pixTCap > _pixelsLen) { // pooled buffer of a larger segment, keep only what this one needs
+    uint32_t *pix = (uint32_t*) realloc(_t->_pixT, _pixelsLen * sizeof(uint32_t));
+    if (pix) {
+      _t->_pixT = pix;
+      _t->_pixTCap = _pixelsLen;
+    }
+  }
+  memcpy(_t->_pixT, _pixels, _pixelsLen * sizeof(uint32_t));
+  _t->_pixTLen = _pixelsLen;
+  return true;
+}
 #endif
 
 uint8_t Segment::currentBri(bool useCct) {
@@ -482,6 +981,8 @@ void Segment::setUp(uint16_t i1, uint16_t i2, uint8_t grp, uint8_t spc, uint16_t
 
   stateChanged = true; // send UDP/WS broadcast
 
+  deallocatePixelBuffer(); // buffer dimensions change, fill() below must also reach the strip
+  deallocateMappingPlan();
   if (stop) fill(BLACK); // turn old segment range off (clears pixels if changing spacing)
   if (grp) { // prevent assignment of 0
     grouping = grp;
@@ -669,6 +1170,16 @@ void IRAM_ATTR Segment::setPixelColor(int i, uint32_t col)
 
   if (i >= virtualLength() || i<0) return;  // if pixel would fall out of segment just exit
 
+  if (_pixels && !is2D()) { // render into frame buffer (2D segments are buffered in setPixelColorXY())
+    if (i >= _pixelsLen) return;
+#ifndef WLED_DISABLE_MODE_BLEND
+    if (_modeBlend[FX_CTX]) col = color_blend(_pixels[i], col, 0xFFFFU - progress(), true);
+#endif
+    _pixels[i] = col;
+    _pixelsDirty = true;
+    return;
+  }
+
 #ifndef WLED_DISABLE_2D
   if (is2D()) {
     uint16_t vH = virtualHeight();  // segment height in logical pixels
@@ -729,7 +1240,6 @@ void IRAM_ATTR Segment::setPixelColor(int i, uint32_t col)
   }
 #endif
 
-  uint16_t len = length();
   uint8_t _bri_t = currentBri();
   if (_bri_t < 255) {
     byte r = scale8(R(col), _bri_t);
@@ -739,6 +1249,20 @@ void IRAM_ATTR Segment::setPixelColor(int i, uint32_t col)
     col = RGBW32(r, g, b, w);
   }
 
+  if (_mapKey._inUse && i < _mapLen) { // use compiled mapping plan
+    const mappedpixel_t *m = _map + i * _mapStride;
+    for (int j = 0; j < _mapStride; j++) {
+      Bus *b = busses.getBus(m[j].bus);
+      if (!b) continue;
+#ifndef WLED_DISABLE_MODE_BLEND
+      if (_modeBlend[FX_CTX]) { b->setPixelColor(m[j].pix, color_blend(b->getPixelColor(m[j].pix), col, 0xFFFFU - progress(), true)); continue; }
+#endif
+      b->setPixelColor(m[j].pix, col);
+    }
+    return;
+  }
+
+  uint16_t len = length();
   // expand pixel (taking into account start, grouping, spacing [and offset])
   i = i * groupLength();
   if (reverse) { // is segment reversed?
@@ -760,14 +1284,14 @@ void IRAM_ATTR Segment::setPixelColor(int i, uint32_t col)
         indexMir += offset; // offset/phase
         if (indexMir >= stop) indexMir -= len; // wrap
 #ifndef WLED_DISABLE_MODE_BLEND
-        if (_modeBlend) tmpCol = color_blend(strip.getPixelColor(indexMir), col, 0xFFFFU - progress(), true);
+        if (_modeBlend[FX_CTX]) tmpCol = color_blend(strip.getPixelColor(indexMir), col, 0xFFFFU - progress(), true);
 #endif
         strip.setPixelColor(indexMir, tmpCol);
       }
       indexSet += offset; // offset/phase
       if (indexSet >= stop) indexSet -= len; // wrap
 #ifndef WLED_DISABLE_MODE_BLEND
-      if (_modeBlend) tmpCol = color_blend(strip.getPixelColor(indexSet), col, 0xFFFFU - progress(), true);
+      if (_modeBlend[FX_CTX]) tmpCol = color_blend(strip.getPixelColor(indexSet), col, 0xFFFFU - progress(), true);
 #endif
       strip.setPixelColor(indexSet, tmpCol);
     }
@@ -815,6 +1339,8 @@ uint32_t Segment::getPixelColor(int i)
 #endif
   i &= 0xFFFF;
 
+  if (_pixels && !is2D()) return i < _pixelsLen ? _pixels[i] : 0; // exact value from frame buffer
+
 #ifndef WLED_DISABLE_2D
   if (is2D()) {
     uint16_t vH = virtualHeight();  // segment height in logical pixels
@@ -928,6 +1454,22 @@ void Segment::refreshLightCapabilities() {
  */
 void Segment::fill(uint32_t c) {
   if (!isActive()) return; // not active
+  // plain 1D segment without spacing or ledmap: every physical pixel gets the same color regardless
+  // of grouping, reverse, mirror or offset so the whole run can be written to busses at once
+  if (!_pixels && !is2D() && spacing == 0 && strip.customMappingSize == 0
+#ifndef WLED_DISABLE_MODE_BLEND
+      && !_modeBlend[FX_CTX]
+#endif
+#ifndef WLED_DISABLE_2D
+      && (Segment::maxHeight == 1 || start >= Segment::maxWidth*Segment::maxHeight)
+#endif
+     ) {
+    uint8_t _bri_t = currentBri();
+    if (_bri_t < 255) c = RGBW32(scale8(R(c), _bri_t), scale8(G(c), _bri_t), scale8(B(c), _bri_t), scale8(W(c), _bri_t));
+    uint16_t len = stop > strip._length ? (start < strip._length ? strip._length - start : 0) : length();
+    busses.fill(start, len, c);
+    return;
+  }
   const uint16_t cols = is2D() ? virtualWidth() : virtualLength();
   const uint16_t rows = virtualHeight(); // will be 1 for 1D
   for (int y = 0; y < rows; y++) for (int x = 0; x < cols; x++) {
@@ -998,6 +1540,16 @@ void Segment::fadeToBlackBy(uint8_t fadeBy) {
   const uint16_t cols = is2D() ? virtualWidth() : virtualLength();
   const uint16_t rows = virtualHeight(); // will be 1 for 1D
 
+  if (_pixels && cols * rows == _pixelsLen
+#ifndef WLED_DISABLE_MODE_BLEND
+      && !_modeBlend[FX_CTX]
+#endif
+     ) { // fade whole frame buffer at once
+    color_fade_span(_pixels, _pixelsLen, 255-fadeBy);
+    _pixelsDirty = true;
+    return;
+  }
+
   for (int y = 0; y < rows; y++) for (int x = 0; x < cols; x++) {
     if (is2D()) setPixelColorXY(x, y, color_fade(getPixelColorXY(x,y), 255-fadeBy));
     else        setPixelColor(x, color_fade(getPixelColor(x), 255-fadeBy));
@@ -1078,11 +1630,34 @@ uint32_t Segment::color_from_palette(uint16_t i, bool mapping, bool wrap, uint8_
   uint8_t paletteIndex = i;
   if (mapping && virtualLength() > 1) paletteIndex = (i*255)/(virtualLength() -1);
   if (!wrap && strip.paletteBlend != 3) paletteIndex = scale8(paletteIndex, 240); //cut off blend at palette "end"
+  const TBlendType blendType = (strip.paletteBlend == 3)? NOBLEND:LINEARBLEND; // NOTE: paletteBlend should be global
+
+  // while an effect is running the palette of the segment has already been computed by renderSegment()
+  // (SEGPALETTE) so there is no need to reload (or blend transitioning) palette for every pixel
+  const uint8_t ctx = FX_CTX;
+  if (ctx < WLED_FX_CORES && strip._isServicing && strip._segment_index[ctx] < strip._segments.size() && &strip._segments[strip._segment_index[ctx]] == this) {
+#ifdef WLED_PALETTE_LUT
+    // expanded palette entries are filled on first use (at full brightness) and are valid until the next frame
+    // scaling by pbri afterwards yields the same result as FastLED's ColorFromPalette() (which uses scale8(c, pbri+1))
+    uint32_t &valid = strip._paletteLUTValid[ctx][paletteIndex >> 5];
+    const uint32_t bit = 1U << (paletteIndex & 31);
+    if (!(valid & bit)) {
+      CRGB fastled_col = ColorFromPalette(strip._currentPalette[ctx], paletteIndex, 255, blendType);
+      strip._paletteLUT[ctx][paletteIndex] = RGBW32(fastled_col.r, fastled_col.g, fastled_col.b, 0);
+      valid |= bit;
+    }
+    if (pbri == 255) return strip._paletteLUT[ctx][paletteIndex];
+    if (pbri == 0)   return 0;
+    return color_fade(strip._paletteLUT[ctx][paletteIndex], pbri + 1);
+#else
+    CRGB fastled_col = ColorFromPalette(strip._currentPalette[ctx], paletteIndex, pbri, blendType);
+    return RGBW32(fastled_col.r, fastled_col.g, fastled_col.b, 0);
+#endif
+  }
+
   CRGBPalette16 curPal;
   curPal = currentPalette(curPal, palette);
-  //if (isInTransition()) curPal = _t->_palT;
-  //else    loadPalette(curPal, palette);
-  CRGB fastled_col = ColorFromPalette(curPal, paletteIndex, pbri, (strip.paletteBlend == 3)? NOBLEND:LINEARBLEND); // NOTE: paletteBlend should be global
+  CRGB fastled_col = ColorFromPalette(curPal, paletteIndex, pbri, blendType);
 
   return RGBW32(fastled_col.r, fastled_col.g, fastled_col.b, 0);
 }
@@ -1095,6 +1670,10 @@ uint32_t Segment::color_from_palette(uint16_t i, bool mapping, bool wrap, uint8_
 //do not call this method from system context (network callback)
 void WS2812FX::finalizeInit(void)
 {
+#if WLED_FX_CORES > 1
+  fxContext = FX_CTX_LOOP; // called from setup() and loop()
+#endif
+  initSegArena(); // once, before the render task is started in service()
   //reset segment runtimes
   for (segment &seg : _segments) {
     seg.markForReset();
@@ -1127,6 +1706,7 @@ void WS2812FX::finalizeInit(void)
   }
 
   _length = 0;
+  _mappingGen++; // strip length may change, segment mapping plans must be re-compiled
   for (int i=0; i<busses.getNumBusses(); i++) {
     Bus *bus = busses.getBus(i);
     if (bus == nullptr) continue;
@@ -1159,82 +1739,276 @@ void WS2812FX::finalizeInit(void)
   deserializeMap();     // (re)load default ledmap
 }
 
+// runs effect function of a segment in the render context of the calling task (see WS2812FX::service())
+// palette of the segment for the effect about to run (SEGPALETTE), includes palette transition
+void WS2812FX::loadSegmentPalette(segment &seg, unsigned ctx) {
+  seg.currentPalette(_currentPalette[ctx], seg.palette); // we need to pass reference
+#ifdef WLED_PALETTE_LUT
+  memset(_paletteLUTValid[ctx], 0, sizeof(_paletteLUTValid[ctx])); // new palette (or transition step), invalidate expanded entries
+#endif
+}
+
+void WS2812FX::renderSegment(uint8_t segId, unsigned long nowUp) {
+  const unsigned ctx = FX_CTX;
+  segment &seg = _segments[segId];
+  uint16_t delay = FRAMETIME;
+  _segment_index[ctx] = segId;
+
+  if (!seg.freeze) { //only run effect function if not frozen
+    _virtualSegmentLength[ctx] = seg.virtualLength();
+    _colors_t[ctx][0] = seg.currentColor(0);
+    _colors_t[ctx][1] = seg.currentColor(1);
+    _colors_t[ctx][2] = seg.currentColor(2);
+    loadSegmentPalette(seg, ctx);
+
+    // CCT of buffered segments is applied when the buffer is composited in show()
+    if (!seg.hasPixelBuffer() && (!cctFromRgb || correctWB)) busses.setSegmentCCT(seg.currentBri(true), correctWB);
+    for (int c = 0; c < NUM_COLORS; c++) _colors_t[ctx][c] = gamma32(_colors_t[ctx][c]);
+
+    // Effect blending
+    // When two effects are being blended, each may have different segment data, this
+    // data needs to be saved first and then restored before running previous mode.
+    // Segments with frame buffer render previous mode into a separate (pooled) buffer and both
+    // are blended using selected transition curve when composited in show(). Without frame buffer
+    // previous mode is blended into the output of new mode, which depends on effect behaviour
+    // since actual output (LEDs) may be overwritten by later effect.
+    [[maybe_unused]] uint8_t tmpMode = seg.currentMode();  // this will return old mode while in transition
+#ifndef WLED_DISABLE_MODE_BLEND
+    bool compose = modeBlending && seg.mode != tmpMode && seg.prepareTransitionBuffer(); // before new mode overwrites last frame
+#endif
+    seg.useMappingPlan(true);
+    delay = (*_mode[seg.mode])();         // run new/current mode
+#ifndef WLED_DISABLE_MODE_BLEND
+    if (modeBlending && seg.mode != tmpMode) {
+      Segment::tmpsegd_t _tmpSegData;
+      if (!compose) Segment::modeBlend(true); // set semaphore
+      seg.swapSegenv(_tmpSegData);        // temporarily store new mode state (and swap it with transitional state)
+      if (compose) seg.swapTransitionBuffer(); // previous mode renders into its own buffer
+      _virtualSegmentLength[ctx] = seg.virtualLength(); // update SEGLEN (mapping may have changed)
+      loadSegmentPalette(seg, ctx);      // color palettes of old mode use its (swapped in) colors
+      seg.useMappingPlan(true);           // old mode may have other options (reverse, mirror)
+      uint16_t d2 = (*_mode[tmpMode])();  // run old mode
+      if (compose) seg.swapTransitionBuffer();
+      seg.restoreSegenv(_tmpSegData);     // restore mode state (will also update transitional state)
+      delay = MIN(delay,d2);              // use shortest delay
+      Segment::modeBlend(false);          // unset semaphore
+    }
+#endif
+    seg.useMappingPlan(false);            // pixels set outside of rendering use index math
+    if (seg.mode != FX_MODE_HALLOWEEN_EYES) seg.call++;
+    if (seg.isInTransition() && delay > FRAMETIME) delay = FRAMETIME; // force faster updates during transition
+  }
+
+  seg.next_time = nowUp + delay;
+}
+
+// determines when service() needs to run again: at the earliest segment deadline, but not before the next frame slot
+// (frames are paced with micros() precision to match target FPS) and not before busses can take the next frame.
+// service() still runs at least every MIN_SHOW_DELAY so that transitions and changes (e.g. effect resets) are picked up.
+void WS2812FX::scheduleNextService(unsigned long nowUp, bool shown) {
+  uint32_t nowUs = micros(); // 32 bit like on the ESP, so differences wrap the same on 64 bit hosts
+  if (shown) _frameSlotUs += _frameUs;
+  // fell behind by more than a frame, resync (also keeps slot close to now if nothing is shown for a long time,
+  // a slot lagging by more than 2^31 us would look like it is in the future)
+  if ((int32_t)(nowUs - _frameSlotUs) > (int32_t)_frameUs) _frameSlotUs = shown ? nowUs : nowUs - _frameUs;
+
+  long waitMs = MIN_SHOW_DELAY;
+  const long coalesceMs = _frametime >> 2;
+  for (segment &seg : _segments) {
+    if (!seg.isActive()) continue;
+    long dueIn = (long)(seg.next_time - nowUp) - coalesceMs;
+    if (dueIn < waitMs) waitMs = dueIn > 0 ? dueIn : 0;
+  }
+  uint32_t wakeUs = nowUs + waitMs * 1000UL;
+
+  uint32_t nextSlotUs = _frameSlotUs + _frameUs;
+  if ((int32_t)(nextSlotUs - wakeUs) > 0) wakeUs = nextSlotUs;
+  // rendering should end when busses have sent previous frame (async output), so start rendering effect time before that
+  uint32_t wireUs = busses.getWireTime();
+  if (wireUs > _frameUs && nowUs - _lastShowUs < wireUs) { // previous frame may still be on the wire
+    uint32_t busReadyUs = _lastShowUs + wireUs - (_effectTime < wireUs ? _effectTime : wireUs);
+    if ((int32_t)(busReadyUs - wakeUs) > 0) wakeUs = busReadyUs;
+  }
+  _nextServiceUs = wakeUs;
+}
+
+// aligns frame pacing to an external frame clock (frame sync): frames are rendered in time to be shown at showUs
+// (micros()) and multiples of target frame time from it; returns phase correction (us) relative to current pacing
+// pacing is shifted by at most half a frame, so aligning never skips or repeats a frame
+long WS2812FX::alignFrames(uint32_t showUs) {
+  uint32_t slotUs = showUs - (_effectTime < _frameUs ? _effectTime : 0);
+  long err = (int32_t)(slotUs - (_frameSlotUs + _frameUs)) % (long)_frameUs;
+  if (err >  (long)_frameUs/2) err -= _frameUs;
+  if (err < -(long)_frameUs/2) err += _frameUs;
+  _frameSlotUs   += err;
+  _nextServiceUs += err; // next frame moves with its slot
+  return err;
+}
+
+// returns given percentile (0-100) of the intervals between recent frames (us)
+uint32_t WS2812FX::getFrameInterval(uint8_t percentile) {
+  size_t n = _frameIntervalCnt;
+  if (!n || millis() - _lastShow > 2000) return 0;
+  uint32_t sorted[WLED_FRAME_STATS];
+  memcpy(sorted, _frameIntervals, n * sizeof(uint32_t));
+  for (size_t i = 1; i < n; i++) { // insertion sort, only a few dozen entries
+    uint32_t v = sorted[i];
+    size_t j = i;
+    for (; j > 0 && sorted[j-1] > v; j--) sorted[j] = sorted[j-1];
+    sorted[j] = v;
+  }
+  if (percentile > 100) percentile = 100;
+  return sorted[((n - 1) * percentile + 50) / 100];
+}
+
+#if WLED_FX_CORES > 1
+// runs effects of segments handed over by service() on the core not running loop()
+void WS2812FX::renderTask(void *parameter) {
+  WS2812FX *fx = (WS2812FX*)parameter;
+  fxContext = FX_CTX_WORKER;
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // wait for next frame
+    unsigned long start = micros();
+    for (size_t i = 0; i < fx->_renderQueueLen; i++) fx->renderSegment(fx->_renderQueue[i], fx->_renderNow);
+    fx->_virtualSegmentLength[FX_CTX_WORKER] = 0;
+    fx->_renderWorkerTime = micros() - start;
+    xSemaphoreGive(fx->_renderDone); // let service() continue with show()
+  }
+}
+#endif
+
 void WS2812FX::service() {
+#if WLED_FX_CORES > 1
+  fxContext = FX_CTX_LOOP; // service() is only called from loop()
+#endif
   unsigned long nowUp = millis(); // Be aware, millis() rolls over every 49 days
   now = nowUp + timebase;
-  if (nowUp - _lastShow < MIN_SHOW_DELAY) return;
+  if (nowUp - _lastServiceMs > _frametime) {
+    // service() was not called for a while (lights off or realtime mode), micros() deadlines are stale
+    // (after more than 2^31 us they would even look like they are in the future), so run now and resync frame slots
+    _nextServiceUs = micros();
+    _frameSlotUs   = _nextServiceUs - _frameUs;
+  }
+  _lastServiceMs = nowUp;
+  if (_showPending) { // previous frame was rendered while busses were busy, show it as soon as they are free
+    if (busses.canAllShow()) {
+      show();
+      scheduleNextService(nowUp, false); // frame slot was taken when it was rendered, next one should be ready when busses are free again
+    }
+    return;
+  }
+  uint32_t startUs = micros();
+  if ((int32_t)(startUs - _nextServiceUs) < 0) return; // nothing to do yet (see scheduleNextService())
   bool doShow = false;
+  // segments due within this tolerance are rendered now, so they share one show() instead of causing another one shortly after
+  const long coalesceMs = _frametime >> 2;
 
   _isServicing = true;
-  _segment_index = 0;
   Segment::handleRandomPalette(); // move it into for loop when each segment has individual random palette
-  for (segment &seg : _segments) {
+
+  Segment::compactSegmentData(); // if requested, before any effect runs
+
+  // find segments whose effect needs to run in this frame
+  uint8_t due[MAX_NUM_SEGMENTS];
+  size_t  dueLen = 0;
+  for (size_t i = 0; i < _segments.size(); i++) {
+    segment &seg = _segments[i];
     // process transition (mode changes in the middle of transition)
     seg.handleTransition();
     // reset the segment runtime data if needed
     seg.resetIfRequired();
+    // (re)compile 1D mapping plan if segment parameters or ledmap changed
+    seg.updateMappingPlan();
 
     if (!seg.isActive()) continue;
 
+    if (useSegmentBuffers) seg.allocatePixelBuffer(); // will fall back to direct strip access if allocation fails
+    else                   seg.deallocatePixelBuffer();
+
+    if ((long)(seg.next_time - nowUp) <= coalesceMs || _triggered) doShow = true;
+  }
+  for (size_t i = 0; doShow && i < _segments.size(); i++) {
+    segment &seg = _segments[i];
+    if (!seg.isActive()) continue;
     // last condition ensures all solid segments are updated at the same time
-    if (nowUp > seg.next_time || _triggered || (doShow && seg.mode == FX_MODE_STATIC))
-    {
-      doShow = true;
-      uint16_t delay = FRAMETIME;
-
-      if (!seg.freeze) { //only run effect function if not frozen
-        _virtualSegmentLength = seg.virtualLength();
-        _colors_t[0] = seg.currentColor(0);
-        _colors_t[1] = seg.currentColor(1);
-        _colors_t[2] = seg.currentColor(2);
-        seg.currentPalette(_currentPalette, seg.palette); // we need to pass reference
-
-        if (!cctFromRgb || correctWB) busses.setSegmentCCT(seg.currentBri(true), correctWB);
-        for (int c = 0; c < NUM_COLORS; c++) _colors_t[c] = gamma32(_colors_t[c]);
-
-        // Effect blending
-        // When two effects are being blended, each may have different segment data, this
-        // data needs to be saved first and then restored before running previous mode.
-        // The blending will largely depend on the effect behaviour since actual output (LEDs) may be
-        // overwritten by later effect. To enable seamless blending for every effect, additional LED buffer
-        // would need to be allocated for each effect and then blended together for each pixel.
-        [[maybe_unused]] uint8_t tmpMode = seg.currentMode();  // this will return old mode while in transition
-        delay = (*_mode[seg.mode])();         // run new/current mode
-#ifndef WLED_DISABLE_MODE_BLEND
-        if (modeBlending && seg.mode != tmpMode) {
-          Segment::tmpsegd_t _tmpSegData;
-          Segment::modeBlend(true);           // set semaphore
-          seg.swapSegenv(_tmpSegData);        // temporarily store new mode state (and swap it with transitional state)
-          _virtualSegmentLength = seg.virtualLength(); // update SEGLEN (mapping may have changed)
-          uint16_t d2 = (*_mode[tmpMode])();  // run old mode
-          seg.restoreSegenv(_tmpSegData);     // restore mode state (will also update transitional state)
-          delay = MIN(delay,d2);              // use shortest delay
-          Segment::modeBlend(false);          // unset semaphore
-        }
+    if ((long)(seg.next_time - nowUp) <= coalesceMs || _triggered || seg.mode == FX_MODE_STATIC) due[dueLen++] = i;
+  }
+
+  uint8_t mainQueue[MAX_NUM_SEGMENTS];
+  size_t  mainQueueLen = 0;
+#if WLED_FX_CORES > 1
+  // only segments with their own frame buffer can be rendered on the other core as busses are not thread safe
+  // segments are distributed by pixel count (render time of an effect is roughly proportional to it)
+  _renderQueueLen = 0;
+  if (multiCoreRender && dueLen > 1 && !_renderTask) {
+    if (!_renderDone) _renderDone = xSemaphoreCreateBinary();
+    if (_renderDone) xTaskCreatePinnedToCore(renderTask, "FXrender", 8192, this, 1, &_renderTask, !xPortGetCoreID());
+    DEBUG_PRINTF("FX render task %s.\n", _renderTask ? "started" : "failed");
+  }
+  bool   canOffload = multiCoreRender && _renderTask && dueLen > 1;
+  bool   toWorker[MAX_NUM_SEGMENTS] = {false}; // indexed by position in due[]
+  size_t mainLoad = 0, workerLoad = 0;
+  for (size_t i = 0; canOffload && i < dueLen; i++) {
+    segment &seg = _segments[due[i]];
+    if (!seg.hasPixelBuffer() && !seg.freeze) mainLoad += seg.length(); // these have to stay on this core
+  }
+  for (size_t i = 0; canOffload && i < dueLen; i++) {
+    segment &seg = _segments[due[i]];
+    if (!seg.hasPixelBuffer() || seg.freeze) continue;
+    if (workerLoad < mainLoad) { toWorker[i] = true; workerLoad += seg.length(); }
+    else                       mainLoad += seg.length();
+  }
+  for (size_t i = 0; i < dueLen; i++) {
+    if (toWorker[i]) _renderQueue[_renderQueueLen++] = due[i];
+    else             mainQueue[mainQueueLen++]      = due[i];
+  }
+  if (_renderQueueLen) {
+    _renderNow = nowUp;
+    xTaskNotifyGive(_renderTask);
+  }
+  uint32_t mainStartUs = micros();
+#else
+  memcpy(mainQueue, due, dueLen);
+  mainQueueLen = dueLen;
 #endif
-        if (seg.mode != FX_MODE_HALLOWEEN_EYES) seg.call++;
-        if (seg.isInTransition() && delay > FRAMETIME) delay = FRAMETIME; // force faster updates during transition
-      }
 
-      seg.next_time = nowUp + delay;
-    }
-    if (_segment_index == _queuedChangesSegId) setUpSegmentFromQueuedChanges();
-    _segment_index++;
+  for (size_t i = 0; i < mainQueueLen; i++) {
+    renderSegment(mainQueue[i], nowUp);
+    if (mainQueue[i] == _queuedChangesSegId) setUpSegmentFromQueuedChanges();
+  }
+#if WLED_FX_CORES > 1
+  if (_renderQueueLen) {
+    uint32_t mainTime = micros() - mainStartUs;
+    xSemaphoreTake(_renderDone, portMAX_DELAY); // barrier: all effects must finish before show()
+    uint32_t wallTime = micros() - mainStartUs;
+    unsigned long saved = mainTime + _renderWorkerTime > wallTime ? mainTime + _renderWorkerTime - wallTime : 0;
+    _renderTimeSaved = (3 * _renderTimeSaved + saved + 2) >> 2;
+  } else if (doShow) {
+    _renderTimeSaved = (3 * _renderTimeSaved + 2) >> 2;
   }
-  _virtualSegmentLength = 0;
+#endif
+  setUpSegmentFromQueuedChanges(); // change may have been queued for a segment rendered on the other core
+  _virtualSegmentLength[FX_CTX] = 0;
   busses.setSegmentCCT(-1);
   _isServicing = false;
   _triggered = false;
 
-  #ifdef WLED_DEBUG
-  if (millis() - nowUp > _frametime) DEBUG_PRINTLN(F("Slow effects."));
-  #endif
   if (doShow) {
+    uint32_t effectTime = micros() - startUs;
+    _effectTime = (3 * _effectTime + effectTime + 2) >> 2; // same smoothing as FPS
+    #ifdef WLED_DEBUG
+    if (effectTime > _frametime * 1000U) DEBUG_PRINTF("Slow effects: %luus\n", (unsigned long)effectTime);
+    #endif
     yield();
-    show();
+    // busses with asynchronous output (ESP32 RMT/I2S, ESP8266 UART/DMA) send from their own buffer, this frame was
+    // rendered (into segment frame buffers or NeoPixelBus editing buffer) while previous one was still being sent
+    // if that is not finished yet, do not block loop() and show this frame in a later call instead
+    if (busses.canAllShow()) show();
+    else                   { _showPending = true; _pendingUs = micros(); busses.deferShow(); }
   }
+  scheduleNextService(nowUp, doShow);
   #ifdef WLED_DEBUG
-  if (millis() - nowUp > _frametime) DEBUG_PRINTLN(F("Slow strip."));
+  if (millis() - nowUp > _frametime) DEBUG_PRINTF("Slow strip: %lums (show %uus)\n", millis() - nowUp, (unsigned)_showTime);
   #endif
 }
 
@@ -1291,17 +2065,7 @@ uint8_t WS2812FX::estimateCurrentAndLimitBri() {
     if (!IS_DIGITAL(bus->getType())) continue; //exclude non-digital network busses
     uint16_t len = bus->getLength();
     pLen += len;
-    uint32_t busPowerSum = 0;
-    for (uint_fast16_t i = 0; i < len; i++) { //sum up the usage of each LED
-      uint32_t c = bus->getPixelColor(i); // always returns original or restored color without brightness scaling
-      byte r = R(c), g = G(c), b = B(c), w = W(c);
-
-      if(useWackyWS2815PowerModel) { //ignore white component on WS2815 power calculation
-        busPowerSum += (MAX(MAX(r,g),b)) * 3;
-      } else {
-        busPowerSum += (r + g + b + w);
-      }
-    }
+    uint32_t busPowerSum = bus->getPowerSum(useWackyWS2815PowerModel); // sum up the usage of each LED (WS2815 ignores white component)
 
     if (bus->hasWhite()) { //RGBW led total output with white LEDs enabled is still 50mA, so each channel uses less
       busPowerSum *= 3;
@@ -1333,10 +2097,22 @@ uint8_t WS2812FX::estimateCurrentAndLimitBri() {
 }
 
 void WS2812FX::show(void) {
+  _deferTime = (3 * _deferTime + (_showPending ? micros() - _pendingUs : 0) + 2) >> 2;
+  _showPending = false;
+
+  // composite segment frame buffers (in segment order so upper segments overwrite lower ones)
+  for (segment &seg : _segments) {
+    if (!seg.hasPixelBuffer()) continue;
+    if (!cctFromRgb || correctWB) busses.setSegmentCCT(seg.currentBri(true), correctWB); // same as in service()
+    seg.flushPixelBuffer();
+  }
+  busses.setSegmentCCT(-1);
+
   // avoid race condition, capture _callback value
   show_callback callback = _callback;
   if (callback) callback();
 
+  uint32_t startUs = micros();
   uint8_t newBri = estimateCurrentAndLimitBri();
   busses.setBrightness(newBri); // "repaints" all pixels if brightness changed
 
@@ -1350,12 +2126,21 @@ void WS2812FX::show(void) {
   // or async show has a separate buffer (ESP32 RMT and I2S are ok)
   if (newBri < _brightness) busses.setBrightness(_brightness);
 
+  uint32_t showTime = micros() - startUs;
+  _showTime = (3 * _showTime + showTime + 2) >> 2;
+
   unsigned long showNow = millis();
-  size_t diff = showNow - _lastShow;
+  uint32_t diff = startUs - _lastShowUs;
   size_t fpsCurr = 200;
-  if (diff > 0) fpsCurr = 1000 / diff;
+  if (diff > 5000) fpsCurr = 1000000UL / diff;
   _cumulativeFps = (3 * _cumulativeFps + fpsCurr +2) >> 2;   // "+2" for proper rounding (2/4 = 0.5)
+  if (showNow - _lastShow < 1000) { // do not count pauses (e.g. static effects) as frame intervals
+    _frameIntervals[_frameIntervalPos] = diff;
+    _frameIntervalPos = (_frameIntervalPos + 1) % WLED_FRAME_STATS;
+    if (_frameIntervalCnt < WLED_FRAME_STATS) _frameIntervalCnt++;
+  }
   _lastShow = showNow;
+  _lastShowUs = startUs;
 }
 
 /**
@@ -1377,7 +2162,16 @@ uint16_t WS2812FX::getFps() {
 
 void WS2812FX::setTargetFps(uint8_t fps) {
   if (fps > 0 && fps <= 120) _targetFps = fps;
-  _frametime = 1000 / _targetFps;
+  _frameUs = _frameUsOverride ? _frameUsOverride : 1000000UL / _targetFps;
+  _frametime = _frameUs / 1000;
+}
+
+// frame sync follower paces frames with frame time of master, _targetFps (user setting, saved in cfg.json) is not changed
+void WS2812FX::setFrameTimeOverride(uint32_t us) {
+  if (us && (us < 1000000UL/120 || us > 1000000UL)) us = 0; // same range as target FPS
+  if (us == _frameUsOverride) return;
+  _frameUsOverride = us;
+  setTargetFps(_targetFps);
 }
 
 void WS2812FX::setMode(uint8_t segid, uint8_t m) {
@@ -1516,8 +2310,7 @@ bool WS2812FX::hasCCTBus(void) {
 void WS2812FX::purgeSegments(bool force) {
   // remove all inactive segments (from the back)
   int deleted = 0;
-  if (_segments.size() <= 1) return;
-  for (size_t i = _segments.size()-1; i > 0; i--)
+  if (_segments.size() > 1) for (size_t i = _segments.size()-1; i > 0; i--)
     if (_segments[i].stop == 0 || force) {
       deleted++;
       _segments.erase(_segments.begin() + i);
@@ -1526,6 +2319,7 @@ void WS2812FX::purgeSegments(bool force) {
     _segments.shrink_to_fit();
     /*if (_mainSegment >= _segments.size())*/ setMainSegmentId(0);
   }
+  Segment::flushTransitionPool(); // also called on low heap
 }
 
 Segment& WS2812FX::getSegment(uint8_t id) {
@@ -1542,7 +2336,9 @@ void WS2812FX::setSegment(uint8_t segId, uint16_t i1, uint16_t i2, uint8_t group
 
   if (_queuedChangesSegId == segId) _queuedChangesSegId = 255; // cancel queued change if already queued for this segment
 
-  if (segId < getMaxSegments() && segId == getCurrSegmentId() && isServicing()) { // queue change to prevent concurrent access
+  bool rendering = false; // segment may be rendered on either core
+  for (size_t c = 0; c < WLED_FX_CORES; c++) rendering |= (segId == _segment_index[c]);
+  if (segId < getMaxSegments() && rendering && isServicing()) { // queue change to prevent concurrent access
     // queuing a change for a second segment will lead to the loss of the first change if not yet applied
     // however this is not a problem as the queued change is applied immediately after the effect function in that segment returns
     _qStart  = i1; _qStop   = i2; _qStartY = startY; _qStopY  = stopY;
@@ -1575,6 +2371,7 @@ void WS2812FX::resetSegments() {
   #endif
   _segments.push_back(seg);
   _mainSegment = 0;
+  Segment::flushTransitionPool(); // transitions of removed segments
 }
 
 void WS2812FX::makeAutoSegments(bool forceReset) {
@@ -1696,19 +2493,36 @@ bool WS2812FX::checkSegmentAlignment() {
 //Note: If called in an interrupt (e.g. JSON API), original segment must be restored,
 //otherwise it can lead to a crash on ESP32 because _segment_index is modified while in use by the main thread
 uint8_t WS2812FX::setPixelSegment(uint8_t n) {
-  uint8_t prevSegId = _segment_index;
+  uint8_t prevSegId = _segment_index[FX_CTX];
   if (n < _segments.size()) {
-    _segment_index = n;
-    _virtualSegmentLength = _segments[_segment_index].virtualLength();
+    _segment_index[FX_CTX] = n;
+    _virtualSegmentLength[FX_CTX] = _segments[n].virtualLength();
   }
   return prevSegId;
 }
 
 void WS2812FX::setRange(uint16_t i, uint16_t i2, uint32_t col) {
   if (i2 < i) std::swap(i,i2);
+  if (customMappingSize == 0) { // no ledmap, write whole run at once
+    if (i >= _length) return;
+    if (i2 >= _length) i2 = _length - 1;
+    busses.fill(i, i2 - i + 1, col);
+    return;
+  }
   for (unsigned x = i; x <= i2; x++) setPixelColor(x, col);
 }
 
+// writes count consecutive (logical) pixels, contiguous span goes to busses at once if there is no ledmap
+void WS2812FX::setPixels(uint16_t start, const uint32_t *c, uint16_t count) {
+  if (customMappingSize == 0) {
+    if (start >= _length) return;
+    if (count > _length - start) count = _length - start;
+    busses.setPixels(start, c, count);
+    return;
+  }
+  for (unsigned x = 0; x < count; x++) setPixelColor(start + x, c[x]);
+}
+
 void WS2812FX::setTransitionMode(bool t) {
   for (segment &seg : _segments) seg.startTransition(t ? _transitionDur : 0);
 }
@@ -1775,15 +2589,18 @@ void WS2812FX::loadCustomPalettes() {
   }
 }
 
-//load custom mapping table from JSON file (called from finalizeInit() or deserializeState())
+//load custom mapping table from binary (ledmap.lmb) or JSON file (called from finalizeInit() or deserializeState())
 bool WS2812FX::deserializeMap(uint8_t n) {
   // 2D support creates its own ledmap (on the fly) if a ledmap.json exists it will overwrite built one.
 
   char fileName[32];
   strcpy_P(fileName, PSTR("/ledmap"));
   if (n) sprintf(fileName +7, "%d", n);
-  strcat_P(fileName, PSTR(".json"));
-  bool isFile = WLED_FS.exists(fileName);
+  char *ext = fileName + strlen(fileName);
+  strcpy_P(ext, PSTR(".lmb")); // binary ledmap takes precedence (no JSON buffer needed)
+  bool isBinary = WLED_FS.exists(fileName);
+  if (!isBinary) strcpy_P(ext, PSTR(".json"));
+  bool isFile = isBinary || WLED_FS.exists(fileName);
 
   if (!isFile) {
     // erase custom mapping if selecting nonexistent ledmap.json (n==0)
@@ -1791,10 +2608,27 @@ bool WS2812FX::deserializeMap(uint8_t n) {
       customMappingSize = 0;
       delete[] customMappingTable;
       customMappingTable = nullptr;
+      _mappingGen++;
     }
     return false;
   }
 
+  if (isBinary) {
+    uint16_t *table = nullptr;
+    uint16_t  len   = 0;
+    if (!readLedmapFile(fileName, &table, &len)) return false;
+
+    DEBUG_PRINT(F("Reading LED map from "));
+    DEBUG_PRINTLN(fileName);
+
+    // replace old custom ledmap
+    _mappingGen++;
+    if (customMappingTable != nullptr) delete[] customMappingTable;
+    customMappingTable = table;
+    customMappingSize  = len;
+    return true;
+  }
+
   if (!requestJSONBufferLock(7)) return false;
 
   if (!readObjectFromFile(fileName, nullptr, &doc)) {
@@ -1806,6 +2640,7 @@ bool WS2812FX::deserializeMap(uint8_t n) {
   DEBUG_PRINTLN(fileName);
 
   // erase old custom ledmap
+  _mappingGen++;
   if (customMappingTable != nullptr) {
     customMappingSize = 0;
     delete[] customMappingTable;
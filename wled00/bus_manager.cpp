@@ -15,7 +15,10 @@ uint16_t approximateKelvinFromRGB(uint32_t rgb);
 void colorRGBtoRGBW(byte* rgb);
 
 //udp.cpp
-uint8_t realtimeBroadcast(uint8_t type, IPAddress client, uint16_t length, byte *buffer, uint8_t bri=255, bool isRGBW=false);
+uint8_t realtimeBroadcast(uint8_t type, IPAddress client, uint16_t length, byte *buffer, uint8_t bri=255, bool isRGBW=false, uint16_t from=0, uint16_t to=UINT16_MAX);
+size_t  realtimeHeaderLen(uint8_t type);
+size_t  realtimeChannelsPerPacket(uint8_t type, bool isRGBW);
+void    realtimeInitPackets(uint8_t type, uint8_t *buffer, uint16_t length, bool isRGBW);
 
 // enable additional debug output
 #if defined(WLED_DEBUG_HOST)
@@ -91,6 +94,12 @@ uint32_t Bus::autoWhiteCalc(uint32_t c) {
   return RGBW32(r, g, b, w);
 }
 
+uint32_t Bus::getPowerSum(bool ws2815) {
+  uint32_t sum = 0;
+  for (unsigned i = 0; i < getLength(); i++) sum += powerUnits(getPixelColor(i), ws2815); // always returns original or restored color without brightness scaling
+  return sum;
+}
+
 uint8_t *Bus::allocData(size_t size) {
   if (_data) free(_data); // should not happen, but for safety
   return _data = (uint8_t *)(size>0 ? calloc(size, sizeof(uint8_t)) : nullptr);
@@ -102,6 +111,8 @@ BusDigital::BusDigital(BusConfig &bc, uint8_t nr, const ColorOrderMap &com)
 , _skip(bc.skipAmount) //sacrificial pixels
 , _colorOrder(bc.colorOrder)
 , _colorOrderMap(com)
+, _powerSum(0)
+, _powerSum2815(0)
 {
   if (!IS_DIGITAL(bc.type) || !bc.count) return;
   if (!pinManager.allocatePin(bc.pins[0], true, PinOwner::BusDigital)) return;
@@ -128,6 +139,12 @@ BusDigital::BusDigital(BusConfig &bc, uint8_t nr, const ColorOrderMap &com)
 
 void BusDigital::show() {
   if (!_valid) return;
+  // wait time of this frame starts when service() postponed its show() (see BusManager::deferShow())
+  const bool deferred = _showDeferred;
+  uint32_t waitStart = deferred ? _deferStart : micros();
+  _showDeferred = false;
+  bool briChanged = _bri != _shownBri;
+  if (!isDirty() && !briChanged && !_needsRefresh) return; // LEDs already show this frame
   if (_buffering) { // should be _data != nullptr, but that causes ~20% FPS drop
     size_t channels = Bus::hasWhite(_type) + 3*Bus::hasRGB(_type);
     for (size_t i=0; i<_len; i++) {
@@ -153,12 +170,33 @@ void BusDigital::show() {
     #endif
     for (int i=1; i<_skip; i++) PolyBus::setPixelColor(_busPtr, _iType, i, 0, _colorOrderMap.getPixelColorOrder(_start, _colorOrder)); // paint skipped pixels black
   }
+  // NeoPixelBus keeps editing and sending buffers separate (RMT, I2S, UART & DMA methods) so the above could be done
+  // while previous frame is still being sent; direct callers (realtime) block here until it is finished
+  while (!PolyBus::canShow(_busPtr, _iType)) yield();
+  if (!deferred || !_deferReady) addWaitTime(micros() - waitStart); // else counted when canShow() first returned true
   PolyBus::show(_busPtr, _iType, !_buffering); // faster if buffer consistency is not important
+  _shownBri = _bri;
+  clearDirty();
+}
+
+uint32_t BusDigital::getWireTime() {
+  if (!_valid) return 0;
+  uint32_t bits = (_len + _skip) * (hasWhite() ? 32 : 24);
+  if (IS_2PIN(_type)) return _frequencykHz ? (bits * 1000U) / _frequencykHz : 0; // clocked (SPI) LEDs
+  if (_type == TYPE_WS2811_400KHZ) return bits * 5 / 2 + 300;
+  return bits * 5 / 4 + 300; // 800kbps (1.25us per bit) + reset/latch time
 }
 
 bool BusDigital::canShow() {
   if (!_valid) return true;
-  return PolyBus::canShow(_busPtr, _iType);
+  bool ready = PolyBus::canShow(_busPtr, _iType);
+  // a postponed frame is blocked by this bus until its previous transfer has finished (not until it is shown,
+  // that also depends on other busses and on loop() latency)
+  if (ready && _showDeferred && !_deferReady) {
+    _deferReady = true;
+    addWaitTime(micros() - _deferStart);
+  }
+  return ready;
 }
 
 void BusDigital::setBrightness(uint8_t b) {
@@ -178,7 +216,7 @@ void BusDigital::setBrightness(uint8_t b) {
   // must update/repaint every LED in the NeoPixelBus buffer to the new brightness
   // the only case where repainting is unnecessary is when all pixels are set after the brightness change but before the next show
   // (which we can't rely on)
-  uint16_t hwLen = _len;
+  uint16_t hwLen = _len + _skip;
   if (_type == TYPE_WS2812_1CH_X3) hwLen = NUM_ICS_WS2812_1CH_3X(_len); // only needs a third of "RGB" LEDs for NeoPixelBus
   for (uint_fast16_t i = 0; i < hwLen; i++) {
     // use 0 as color order, actual order does not matter here as we just update the channel values as-is
@@ -203,13 +241,21 @@ void IRAM_ATTR BusDigital::setPixelColor(uint16_t pix, uint32_t c) {
   if (_buffering) { // should be _data != nullptr, but that causes ~20% FPS drop
     size_t channels = Bus::hasWhite(_type) + 3*Bus::hasRGB(_type);
     size_t offset = pix*channels;
+    uint32_t cOld = bufferedColor(offset);
+    size_t o = offset;
     if (Bus::hasRGB(_type)) {
-      _data[offset++] = R(c);
-      _data[offset++] = G(c);
-      _data[offset++] = B(c);
+      _data[o++] = R(c);
+      _data[o++] = G(c);
+      _data[o++] = B(c);
+    }
+    if (Bus::hasWhite(_type)) _data[o] = W(c);
+    uint32_t cNew = bufferedColor(offset);
+    if (cNew != cOld) {
+      updatePowerSum(cOld, cNew);
+      markDirty(pix);
     }
-    if (Bus::hasWhite(_type)) _data[offset] = W(c);
   } else {
+    markDirty(pix); // NeoPixelBus data is not compared (read-back would cost more than sending)
     if (_reversed) pix = _len - pix -1;
     pix += _skip;
     uint8_t co = _colorOrderMap.getPixelColorOrder(pix+_start, _colorOrder);
@@ -227,6 +273,74 @@ void IRAM_ATTR BusDigital::setPixelColor(uint16_t pix, uint32_t c) {
   }
 }
 
+void BusDigital::setPixels(uint16_t pix, const uint32_t *c, uint16_t count) {
+  setSpan(pix, c, count, false);
+}
+
+void BusDigital::fill(uint16_t pix, uint16_t count, uint32_t c) {
+  setSpan(pix, &c, count, true);
+}
+
+// writes count pixels starting at pix, either from array c or (if solid) the single color *c
+// white calculation, CCT correction and color order are resolved once per span where possible
+void BusDigital::setSpan(uint16_t pix, const uint32_t *c, uint16_t count, bool solid) {
+  if (!_valid || pix >= _len) return;
+  if (pix + count > _len) count = _len - pix;
+  if (_type == TYPE_WS2812_1CH_X3) { // each IC controls 3 LEDs, needs read-modify-write per pixel
+    if (solid) Bus::fill(pix, count, *c);
+    else       Bus::setPixels(pix, c, count);
+    return;
+  }
+  const bool hasW = Bus::hasWhite(_type);
+  const bool wbCorrect = _cct >= 1900;
+  uint32_t col = *c;
+  if (solid) {
+    if (hasW)      col = autoWhiteCalc(col);
+    if (wbCorrect) col = colorBalanceFromKelvin(_cct, col); //color correction from CCT
+  }
+  if (_buffering) { // should be _data != nullptr, but that causes ~20% FPS drop
+    const bool   hasRGB = Bus::hasRGB(_type);
+    const size_t channels = hasW + 3*hasRGB;
+    size_t offset = pix*channels;
+    for (unsigned i = 0; i < count; i++, offset += channels) {
+      if (!solid) {
+        col = c[i];
+        if (hasW)      col = autoWhiteCalc(col);
+        if (wbCorrect) col = colorBalanceFromKelvin(_cct, col);
+      }
+      uint32_t cOld = bufferedColor(offset);
+      uint8_t *d = _data + offset;
+      if (hasRGB) {
+        *d++ = R(col);
+        *d++ = G(col);
+        *d++ = B(col);
+      }
+      if (hasW) *d = W(col);
+      uint32_t cNew = bufferedColor(offset);
+      if (cNew != cOld) {
+        updatePowerSum(cOld, cNew);
+        markDirty(pix + i);
+      }
+    }
+  } else {
+    const bool singleOrder = _colorOrderMap.count() == 0;
+    uint8_t co = _colorOrder;
+    markDirty(pix, count);
+    for (unsigned i = 0; i < count; i++) {
+      if (!solid) {
+        col = c[i];
+        if (hasW)      col = autoWhiteCalc(col);
+        if (wbCorrect) col = colorBalanceFromKelvin(_cct, col);
+      }
+      uint16_t p = pix + i;
+      if (_reversed) p = _len - p -1;
+      p += _skip;
+      if (!singleOrder) co = _colorOrderMap.getPixelColorOrder(p+_start, _colorOrder);
+      PolyBus::setPixelColor(_busPtr, _iType, p, col, co);
+    }
+  }
+}
+
 // returns original color if global buffering is enabled, else returns lossly restored color from bus
 uint32_t BusDigital::getPixelColor(uint16_t pix) {
   if (!_valid) return 0;
@@ -259,6 +373,25 @@ uint32_t BusDigital::getPixelColor(uint16_t pix) {
   }
 }
 
+// sum of powerUnits() for all LEDs of the bus without brightness scaling
+uint32_t BusDigital::getPowerSum(bool ws2815) {
+  if (!_valid) return 0;
+  if (_buffering) return ws2815 ? _powerSum2815 : _powerSum; // maintained when pixels are written
+  if (!Bus::hasRGB(_type)) return Bus::getPowerSum(ws2815);   // single channel busses (e.g. 3 LEDs per IC)
+  // unbuffered busses are summed up once per show() (reading NeoPixelBus back on every write costs more, also without ABL)
+  // RGB channel order does not matter for the sum so raw NeoPixelBus values are used (no reverse lookup),
+  // only the W swap nibble is needed to keep white out of the WS2815 model
+  // brightness is restored per pixel like getPixelColor() does
+  const bool singleOrder = _colorOrderMap.count() == 0;
+  uint8_t co = _colorOrder & 0xF0;
+  uint32_t sum = 0;
+  for (unsigned i = _skip; i < _len + _skip; i++) {
+    if (!singleOrder) co = _colorOrderMap.getPixelColorOrder(i+_start, _colorOrder) & 0xF0;
+    sum += powerUnits(restoreColorLossy(PolyBus::getPixelColor(_busPtr, _iType, i, co), _bri), ws2815);
+  }
+  return sum;
+}
+
 uint8_t BusDigital::getPins(uint8_t* pinArray) {
   uint8_t numPins = IS_2PIN(_type) ? 2 : 1;
   for (uint8_t i = 0; i < numPins; i++) pinArray[i] = _pins[i];
@@ -274,6 +407,7 @@ void BusDigital::setColorOrder(uint8_t colorOrder) {
 void BusDigital::reinit() {
   if (!_valid) return;
   PolyBus::begin(_busPtr, _iType, _pins);
+  markDirty(0, _len);
 }
 
 void BusDigital::cleanup() {
@@ -467,6 +601,7 @@ uint8_t BusOnOff::getPins(uint8_t* pinArray) {
 BusNetwork::BusNetwork(BusConfig &bc)
 : Bus(bc.type, bc.start, bc.autoWhite, bc.count)
 , _broadcastLock(false)
+, _lastFullShow(0)
 {
   switch (bc.type) {
     case TYPE_NET_ARTNET_RGB:
@@ -484,31 +619,63 @@ BusNetwork::BusNetwork(BusConfig &bc)
   }
   _UDPchannels = _rgbw ? 4 : 3;
   _client = IPAddress(bc.pins[0],bc.pins[1],bc.pins[2],bc.pins[3]);
-  _valid = (allocData(_len * _UDPchannels) != nullptr);
+  _headerLen = realtimeHeaderLen(_UDPtype);
+  _packetChannels = realtimeChannelsPerPacket(_UDPtype, _rgbw);
+  // packets with preformatted headers plus one spare packet used when brightness is applied in show()
+  size_t packets = (_len * _UDPchannels + _packetChannels - 1) / _packetChannels;
+  _valid = _len && (allocData((packets + 1) * (_headerLen + _packetChannels)) != nullptr);
+  if (_valid) realtimeInitPackets(_UDPtype, _data, _len, _rgbw);
 }
 
 void BusNetwork::setPixelColor(uint16_t pix, uint32_t c) {
   if (!_valid || pix >= _len) return;
   if (_rgbw) c = autoWhiteCalc(c);
   if (_cct >= 1900) c = colorBalanceFromKelvin(_cct, c); //color correction from CCT
-  uint16_t offset = pix * _UDPchannels;
-  _data[offset]   = R(c);
-  _data[offset+1] = G(c);
-  _data[offset+2] = B(c);
-  if (_rgbw) _data[offset+3] = W(c);
+  uint8_t *d = channelPtr(pix);
+  if (d[0] == R(c) && d[1] == G(c) && d[2] == B(c) && (!_rgbw || d[3] == W(c))) return;
+  d[0] = R(c);
+  d[1] = G(c);
+  d[2] = B(c);
+  if (_rgbw) d[3] = W(c);
+  markDirty(pix);
+}
+
+void BusNetwork::fill(uint16_t pix, uint16_t count, uint32_t c) {
+  if (!_valid || pix >= _len) return;
+  if (pix + count > _len) count = _len - pix;
+  if (_rgbw) c = autoWhiteCalc(c);
+  if (_cct >= 1900) c = colorBalanceFromKelvin(_cct, c); //color correction from CCT
+  for (unsigned i = 0; i < count; i++) { // pixels never straddle packets
+    uint8_t *d = channelPtr(pix + i);
+    if (d[0] == R(c) && d[1] == G(c) && d[2] == B(c) && (!_rgbw || d[3] == W(c))) continue;
+    markDirty(pix + i);
+    d[0] = R(c);
+    d[1] = G(c);
+    d[2] = B(c);
+    if (_rgbw) d[3] = W(c);
+  }
 }
 
 uint32_t BusNetwork::getPixelColor(uint16_t pix) {
   if (!_valid || pix >= _len) return 0;
-  uint16_t offset = pix * _UDPchannels;
-  return RGBW32(_data[offset], _data[offset+1], _data[offset+2], (_rgbw ? _data[offset+3] : 0));
+  const uint8_t *d = channelPtr(pix);
+  return RGBW32(d[0], d[1], d[2], (_rgbw ? d[3] : 0));
 }
 
 void BusNetwork::show() {
   if (!_valid || !canShow()) return;
+  // unchanged busses are not sent, except for a periodic full frame
+  // DDP sends only packets with changed pixels (receivers show on push flag), E1.31/Art-Net receivers
+  // that wait for all universes of a frame (e.g. WLED) need every universe, so these always send the full frame
+  bool full = _bri != _shownBri || millis() - _lastFullShow > BUS_NETWORK_KEEPALIVE || (_UDPtype != 0 && isDirty());
+  if (!full && !isDirty()) return;
   _broadcastLock = true;
-  realtimeBroadcast(_UDPtype, _client, _len, _data, _bri, _rgbw);
+  uint8_t err = realtimeBroadcast(_UDPtype, _client, _len, _data, _bri, _rgbw, full ? 0 : _dirtyStart, full ? _len : _dirtyEnd);
   _broadcastLock = false;
+  if (err) return; // keep changes (and brightness) for next show()
+  if (full) _lastFullShow = millis();
+  _shownBri = _bri;
+  clearDirty();
 }
 
 uint8_t BusNetwork::getPins(uint8_t* pinArray) {
@@ -591,6 +758,47 @@ void IRAM_ATTR BusManager::setPixelColor(uint16_t pix, uint32_t c) {
   }
 }
 
+// span versions of setPixelColor()/getPixelColor(): bus lookup is done once per bus instead of once per pixel
+void BusManager::setPixels(uint16_t start, const uint32_t *c, uint16_t count) {
+  const unsigned end = start + count;
+  for (uint8_t i = 0; i < numBusses; i++) {
+    Bus* b = busses[i];
+    unsigned bstart = b->getStart();
+    unsigned bend   = bstart + b->getLength();
+    if (end <= bstart || start >= bend) continue;
+    unsigned from = start > bstart ? start : bstart;
+    unsigned to   = end < bend ? end : bend;
+    b->setPixels(from - bstart, c + (from - start), to - from);
+  }
+}
+
+void BusManager::fill(uint16_t start, uint16_t count, uint32_t c) {
+  const unsigned end = start + count;
+  for (uint8_t i = 0; i < numBusses; i++) {
+    Bus* b = busses[i];
+    unsigned bstart = b->getStart();
+    unsigned bend   = bstart + b->getLength();
+    if (end <= bstart || start >= bend) continue;
+    unsigned from = start > bstart ? start : bstart;
+    unsigned to   = end < bend ? end : bend;
+    b->fill(from - bstart, to - from, c);
+  }
+}
+
+void BusManager::getPixels(uint16_t start, uint32_t *c, uint16_t count) {
+  memset(c, 0, count * sizeof(uint32_t)); // pixels not belonging to any bus are black
+  const unsigned end = start + count;
+  for (int i = numBusses - 1; i >= 0; i--) { // backwards so first bus wins if busses overlap (as in getPixelColor())
+    Bus* b = busses[i];
+    unsigned bstart = b->getStart();
+    unsigned bend   = bstart + b->getLength();
+    if (end <= bstart || start >= bend) continue;
+    unsigned from = start > bstart ? start : bstart;
+    unsigned to   = end < bend ? end : bend;
+    b->getPixels(from - bstart, c + (from - start), to - from);
+  }
+}
+
 void BusManager::setBrightness(uint8_t b) {
   for (uint8_t i = 0; i < numBusses; i++) {
     busses[i]->setBrightness(b);
@@ -616,16 +824,25 @@ uint32_t BusManager::getPixelColor(uint16_t pix) {
   return 0;
 }
 
-bool BusManager::canAllShow() {
+uint32_t BusManager::getWireTime() {
+  uint32_t wireTime = 0;
   for (uint8_t i = 0; i < numBusses; i++) {
-    if (!busses[i]->canShow()) return false;
+    uint32_t t = busses[i]->getWireTime();
+    if (t > wireTime) wireTime = t;
   }
-  return true;
+  return wireTime;
+}
+
+void BusManager::deferShow() {
+  for (uint8_t i = 0; i < numBusses; i++) busses[i]->deferShow();
 }
 
-Bus* BusManager::getBus(uint8_t busNr) {
-  if (busNr >= numBusses) return nullptr;
-  return busses[busNr];
+bool BusManager::canAllShow() {
+  bool ready = true;
+  for (uint8_t i = 0; i < numBusses; i++) {
+    if (!busses[i]->canShow()) ready = false; // ask all busses, each notes when its transfer has finished
+  }
+  return ready;
 }
 
 //semi-duplicate of strip.getLengthTotal() (though that just returns strip._length, calculated in finalizeInit())
@@ -18,6 +18,8 @@
 #define IC_INDEX_WS2812_2CH_3X(i)  ((i)*2/3)
 #define WS2812_2CH_3X_SPANS_2_ICS(i) ((i)&0x01)    // every other LED zone is on two different ICs
 
+#define BUS_NETWORK_KEEPALIVE 1000 // ms between full frames sent by network busses (otherwise only changed packets are sent)
+
 // flag for using double buffering in BusDigital
 extern bool useGlobalLedBuffer;
 
@@ -113,6 +115,13 @@ class Bus {
     , _valid(false)
     , _needsRefresh(refresh)
     , _data(nullptr) // keep data access consistent across all types of buses
+    , _waitTime(0)
+    , _deferStart(0)
+    , _showDeferred(false)
+    , _deferReady(false)
+    , _dirtyStart(0)
+    , _dirtyEnd(len) // everything needs to be sent initially
+    , _shownBri(0)
     {
       _autoWhiteMode = Bus::hasWhite(type) ? aw : RGBW_MODE_MANUAL_ONLY;
     };
@@ -124,6 +133,11 @@ class Bus {
     virtual void     setStatusPixel(uint32_t c)  {}
     virtual void     setPixelColor(uint16_t pix, uint32_t c) = 0;
     virtual uint32_t getPixelColor(uint16_t pix) { return 0; }
+    // span functions (pix is relative to bus start), derived buses override them to resolve per-bus settings once per span
+    virtual void     setPixels(uint16_t pix, const uint32_t *c, uint16_t count) { for (unsigned i = 0; i < count; i++) setPixelColor(pix + i, c[i]); }
+    virtual void     fill(uint16_t pix, uint16_t count, uint32_t c)             { for (unsigned i = 0; i < count; i++) setPixelColor(pix + i, c); }
+    virtual void     getPixels(uint16_t pix, uint32_t *c, uint16_t count)       { for (unsigned i = 0; i < count; i++) c[i] = getPixelColor(pix + i); }
+    virtual uint32_t getPowerSum(bool ws2815);   // sum of powerUnits() over all LEDs (used by ABL)
     virtual void     setBrightness(uint8_t b)    { _bri = b; };
     virtual void     cleanup() = 0;
     virtual uint8_t  getPins(uint8_t* pinArray)  { return 0; }
@@ -132,6 +146,7 @@ class Bus {
     virtual uint8_t  getColorOrder()             { return COL_ORDER_RGB; }
     virtual uint8_t  skippedLeds()               { return 0; }
     virtual uint16_t getFrequency()              { return 0U; }
+    virtual uint32_t getWireTime()               { return 0U; } // time (us) needed to send one frame (asynchronous output)
     inline  void     setReversed(bool reversed)  { _reversed = reversed; }
     inline  uint16_t getStart()                  { return _start; }
     inline  void     setStart(uint16_t start)    { _start = start; }
@@ -140,6 +155,11 @@ class Bus {
     inline  bool     isReversed()                { return _reversed; }
     inline  bool     isOffRefreshRequired()      { return _needsRefresh; }
             bool     containsPixel(uint16_t pix) { return pix >= _start && pix < _start+_len; }
+    inline  uint32_t getWaitTime()               { return _waitTime; } // average time (us) a frame was blocked by previous transfer of this bus
+    inline  void     deferShow()                 { if (!_showDeferred) { _showDeferred = true; _deferReady = false; _deferStart = micros(); } } // frame is ready but show() is postponed
+    // range of pixels (relative to bus start) changed since last show(), used to skip or shorten output
+    inline  bool     isDirty()                   { return _dirtyEnd > _dirtyStart; }
+    inline  void     markDirty(uint16_t pix, uint16_t count = 1) { if (pix < _dirtyStart) _dirtyStart = pix; if (pix + count > _dirtyEnd) _dirtyEnd = pix + count; }
 
     virtual bool hasRGB(void) { return Bus::hasRGB(_type); }
     static  bool hasRGB(uint8_t type) {
@@ -170,6 +190,12 @@ class Bus {
         if (_cctBlend > WLED_MAX_CCT_BLEND) _cctBlend = WLED_MAX_CCT_BLEND;
       #endif
     }
+    // power units used by a color: sum of channel values or, for WS2815, brightest RGB channel * 3 (white is ignored)
+    static inline uint32_t powerUnits(uint32_t c, bool ws2815) {
+      uint8_t r = c >> 16, g = c >> 8, b = c;
+      if (ws2815) return 3 * (r > g ? (r > b ? r : b) : (g > b ? g : b));
+      return r + g + b + (c >> 24);
+    }
     inline        void    setAutoWhiteMode(uint8_t m) { if (m < 5) _autoWhiteMode = m; }
     inline        uint8_t getAutoWhiteMode()          { return _autoWhiteMode; }
     inline static void    setGlobalAWMode(uint8_t m)  { if (m < 5) _gAWM = m; else _gAWM = AW_GLOBAL_DISABLED; }
@@ -185,12 +211,21 @@ class Bus {
     bool     _needsRefresh;
     uint8_t  _autoWhiteMode;
     uint8_t  *_data;
+    uint32_t _waitTime;
+    uint32_t _deferStart;   // micros() when show() of current frame was postponed
+    bool     _showDeferred;
+    bool     _deferReady;   // bus has finished sending previous frame since show() was postponed (wait time counted)
+    uint16_t _dirtyStart;
+    uint16_t _dirtyEnd;
+    uint8_t  _shownBri;  // brightness of last sent frame
     static uint8_t _gAWM;
     static int16_t _cct;
     static uint8_t _cctBlend;
 
     uint32_t autoWhiteCalc(uint32_t c);
     uint8_t *allocData(size_t size = 1);
+    inline void clearDirty()               { _dirtyStart = UINT16_MAX; _dirtyEnd = 0; }
+    inline void addWaitTime(uint32_t us)   { _waitTime = (3 * _waitTime + us + 2) >> 2; }
     void     freeData() { if (_data != nullptr) free(_data); _data = nullptr; }
 };
 
@@ -205,12 +240,16 @@ class BusDigital : public Bus {
     void setBrightness(uint8_t b);
     void setStatusPixel(uint32_t c);
     void setPixelColor(uint16_t pix, uint32_t c);
+    void setPixels(uint16_t pix, const uint32_t *c, uint16_t count);
+    void fill(uint16_t pix, uint16_t count, uint32_t c);
     void setColorOrder(uint8_t colorOrder);
     uint32_t getPixelColor(uint16_t pix);
+    uint32_t getPowerSum(bool ws2815);
     uint8_t  getColorOrder() { return _colorOrder; }
     uint8_t  getPins(uint8_t* pinArray);
     uint8_t  skippedLeds()   { return _skip; }
     uint16_t getFrequency()  { return _frequencykHz; }
+    uint32_t getWireTime();
     void reinit();
     void cleanup();
 
@@ -223,6 +262,20 @@ class BusDigital : public Bus {
     void * _busPtr;
     const ColorOrderMap &_colorOrderMap;
     bool _buffering; // temporary until we figure out why comparison "_data != nullptr" causes severe FPS drop
+    uint32_t _powerSum;     // running powerUnits() sum of _data (standard model), maintained on write
+    uint32_t _powerSum2815; // same for WS2815 model
+
+    void setSpan(uint16_t pix, const uint32_t *c, uint16_t count, bool solid);
+
+    // color as stored in _data at offset (same as getPixelColor() returns when buffering)
+    inline uint32_t bufferedColor(size_t offset) {
+      if (!Bus::hasRGB(_type)) return _data[offset] * 0x01010101U;
+      return (uint32_t(Bus::hasWhite(_type) ? _data[offset+3] : 0) << 24) | (uint32_t(_data[offset]) << 16) | (uint32_t(_data[offset+1]) << 8) | _data[offset+2];
+    }
+    inline void updatePowerSum(uint32_t cOld, uint32_t cNew) {
+      _powerSum     += powerUnits(cNew, false) - powerUnits(cOld, false);
+      _powerSum2815 += powerUnits(cNew, true)  - powerUnits(cOld, true);
+    }
 
     inline uint32_t restoreColorLossy(uint32_t c, uint8_t restoreBri) {
       if (restoreBri < 255) {
@@ -287,6 +340,7 @@ class BusNetwork : public Bus {
     bool hasWhite() { return _rgbw; }
     bool canShow()  { return !_broadcastLock; } // this should be a return value from UDP routine if it is still sending data out
     void setPixelColor(uint16_t pix, uint32_t c);
+    void fill(uint16_t pix, uint16_t count, uint32_t c);
     uint32_t getPixelColor(uint16_t pix);
     uint8_t  getPins(uint8_t* pinArray);
     void show();
@@ -298,6 +352,15 @@ class BusNetwork : public Bus {
     uint8_t   _UDPchannels;
     bool      _rgbw;
     bool      _broadcastLock;
+    uint8_t   _headerLen;      // protocol header length of each packet in _data
+    uint16_t  _packetChannels; // channels (bytes) of pixel data per packet
+    unsigned long _lastFullShow; // receivers time out if they do not get all pixels regularly
+
+    // _data holds prebuilt protocol packets, pixel data is written directly after each packet header
+    inline uint8_t *channelPtr(uint16_t pix) {
+      size_t ch = pix * _UDPchannels;
+      return _data + (ch / _packetChannels) * (_headerLen + _packetChannels) + _headerLen + (ch % _packetChannels);
+    }
 };
 
 
@@ -314,14 +377,19 @@ class BusManager {
     void removeAll();
 
     void show();
+    void deferShow();
     bool canAllShow();
+    uint32_t getWireTime(); // longest wire time of all busses (they send in parallel)
     void setStatusPixel(uint32_t c);
     void setPixelColor(uint16_t pix, uint32_t c);
+    void setPixels(uint16_t start, const uint32_t *c, uint16_t count);
+    void fill(uint16_t start, uint16_t count, uint32_t c);
     void setBrightness(uint8_t b);
     void setSegmentCCT(int16_t cct, bool allowWBCorrection = false);
     uint32_t getPixelColor(uint16_t pix);
+    void getPixels(uint16_t start, uint32_t *c, uint16_t count);
 
-    Bus* getBus(uint8_t busNr);
+    inline Bus* getBus(uint8_t busNr) { return busNr < numBusses ? busses[busNr] : nullptr; }
 
     //semi-duplicate of strip.getLengthTotal() (though that just returns strip._length, calculated in finalizeInit())
     uint16_t getTotalLength();
@@ -90,6 +90,9 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
   Bus::setCCTBlend(strip.cctBlending);
   strip.setTargetFps(hw_led["fps"]); //NOP if 0, default 42 FPS
   CJSON(useGlobalLedBuffer, hw_led[F("ld")]);
+  CJSON(useSegmentBuffers, hw_led[F("sb")]);
+  if (!useSegmentBuffers) Segment::flushTransitionPool(); // pooled transition frame buffers are no longer used
+  CJSON(multiCoreRender, hw_led[F("mc")]);
 
   #ifndef WLED_DISABLE_2D
   // 2D Matrix Settings
@@ -359,6 +362,8 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
   JsonObject light_tr = light["tr"];
   CJSON(fadeTransition, light_tr["mode"]);
   CJSON(modeBlending, light_tr["fx"]);
+  CJSON(transitionCurve, light_tr[F("crv")]);
+  if (transitionCurve > TRANSITION_DISSOLVE) transitionCurve = TRANSITION_LINEAR;
   int tdd = light_tr["dur"] | -1;
   if (tdd >= 0) transitionDelay = transitionDelayDefault = tdd * 100;
   strip.setTransition(fadeTransition ? transitionDelayDefault : 0);
@@ -384,6 +389,8 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
   JsonObject if_sync = interfaces["sync"];
   CJSON(udpPort, if_sync[F("port0")]); // 21324
   CJSON(udpPort2, if_sync[F("port1")]); // 65506
+  CJSON(frameSyncMode, if_sync[F("fsync")]);
+  if (frameSyncMode > FRAME_SYNC_FOLLOWER) frameSyncMode = FRAME_SYNC_OFF;
 
   JsonObject if_sync_recv = if_sync["recv"];
   CJSON(receiveNotificationBrightness, if_sync_recv["bri"]);
@@ -406,6 +413,7 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
   CJSON(syncGroups, if_sync_send["grp"]);
   if (if_sync_send[F("twice")]) udpNumRetries = 1; // import setting from 0.13 and earlier
   CJSON(udpNumRetries, if_sync_send["ret"]);
+  CJSON(notifyDelta, if_sync_send[F("delta")]);
 
   JsonObject if_nodes = interfaces["nodes"];
   CJSON(nodeListEnabled, if_nodes[F("list")]);
@@ -427,6 +435,8 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
   if (DMXSegmentSpacing > 150) DMXSegmentSpacing = 0;
   CJSON(e131Priority, if_live_dmx[F("e131prio")]);
   if (e131Priority > 200) e131Priority = 200;
+  CJSON(rtMergeMode, if_live_dmx[F("merge")]);
+  if (rtMergeMode > RT_MERGE_LTP) rtMergeMode = RT_MERGE_PRIORITY;
   CJSON(DMXMode, if_live_dmx["mode"]);
 
   tdd = if_live[F("timeout")] | -1;
@@ -720,6 +730,8 @@ void serializeConfig() {
   hw_led["fps"] = strip.getTargetFps();
   hw_led[F("rgbwm")] = Bus::getGlobalAWMode(); // global auto white mode override
   hw_led[F("ld")] = useGlobalLedBuffer;
+  hw_led[F("sb")] = useSegmentBuffers;
+  hw_led[F("mc")] = multiCoreRender;
 
   #ifndef WLED_DISABLE_2D
   // 2D Matrix Settings
@@ -831,6 +843,7 @@ void serializeConfig() {
   JsonObject light_tr = light.createNestedObject("tr");
   light_tr["mode"] = fadeTransition;
   light_tr["fx"] = modeBlending;
+  light_tr[F("crv")] = transitionCurve;
   light_tr["dur"] = transitionDelayDefault / 100;
   light_tr["pal"] = strip.paletteFade;
   light_tr[F("rpc")] = randomPaletteChangeTime;
@@ -851,6 +864,7 @@ void serializeConfig() {
   JsonObject if_sync = interfaces.createNestedObject("sync");
   if_sync[F("port0")] = udpPort;
   if_sync[F("port1")] = udpPort2;
+  if_sync[F("fsync")] = frameSyncMode;
 
   JsonObject if_sync_recv = if_sync.createNestedObject("recv");
   if_sync_recv["bri"] = receiveNotificationBrightness;
@@ -868,6 +882,7 @@ void serializeConfig() {
   if_sync_send["macro"] = notifyMacro;
   if_sync_send["grp"] = syncGroups;
   if_sync_send["ret"] = udpNumRetries;
+  if_sync_send[F("delta")] = notifyDelta;
 
   JsonObject if_nodes = interfaces.createNestedObject("nodes");
   if_nodes[F("list")] = nodeListEnabled;
@@ -883,6 +898,7 @@ void serializeConfig() {
   if_live_dmx[F("uni")] = e131Universe;
   if_live_dmx[F("seqskip")] = e131SkipOutOfSequence;
   if_live_dmx[F("e131prio")] = e131Priority;
+  if_live_dmx[F("merge")] = rtMergeMode;
   if_live_dmx[F("addr")] = DMXAddress;
   if_live_dmx[F("dss")] = DMXSegmentSpacing;
   if_live_dmx["mode"] = DMXMode;
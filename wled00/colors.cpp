@@ -4,6 +4,15 @@
  * Color conversion & utility methods
  */
 
+/*
+ * Packed (SWAR) color math: R|B and W|G channel pairs are processed in the two
+ * 16 bit lanes of a 32 bit word (c & 0x00FF00FF and (c >> 8) & 0x00FF00FF).
+ * Lanes never overflow into each other so results are bit-exact with
+ * per-channel calculation.
+ */
+#define SWAR_LO 0x00FF00FFU // R|B lanes (or channel values within lanes)
+#define SWAR_HI 0xFF00FF00U // W|G channel positions
+
 /*
  * color blend function
  */
@@ -11,24 +20,21 @@ uint32_t color_blend(uint32_t color1, uint32_t color2, uint16_t blend, bool b16)
   if(blend == 0)   return color1;
   uint16_t blendmax = b16 ? 0xFFFF : 0xFF;
   if(blend == blendmax) return color2;
-  uint8_t shift = b16 ? 16 : 8;
 
-  uint32_t w1 = W(color1);
-  uint32_t r1 = R(color1);
-  uint32_t g1 = G(color1);
-  uint32_t b1 = B(color1);
-
-  uint32_t w2 = W(color2);
-  uint32_t r2 = R(color2);
-  uint32_t g2 = G(color2);
-  uint32_t b2 = B(color2);
-
-  uint32_t w3 = ((w2 * blend) + (w1 * (blendmax - blend))) >> shift;
-  uint32_t r3 = ((r2 * blend) + (r1 * (blendmax - blend))) >> shift;
-  uint32_t g3 = ((g2 * blend) + (g1 * (blendmax - blend))) >> shift;
-  uint32_t b3 = ((b2 * blend) + (b1 * (blendmax - blend))) >> shift;
+  uint32_t inv = blendmax - blend;
+  if (b16) {
+    // 8 bit channel * 16 bit blend needs 24 bits, two of them do not fit a 32 bit word
+    // so each channel is calculated on its own (64 bit lanes would need emulated 64 bit multiplies)
+    uint32_t r3 = (R(color2) * blend + R(color1) * inv) >> 16;
+    uint32_t g3 = (G(color2) * blend + G(color1) * inv) >> 16;
+    uint32_t b3 = (B(color2) * blend + B(color1) * inv) >> 16;
+    uint32_t w3 = (W(color2) * blend + W(color1) * inv) >> 16;
+    return RGBW32(r3, g3, b3, w3);
+  }
 
-  return RGBW32(r3, g3, b3, w3);
+  uint32_t rb3 = (((color2 & SWAR_LO) * blend + (color1 & SWAR_LO) * inv) >> 8) & SWAR_LO;
+  uint32_t wg3 = ((((color2 >> 8) & SWAR_LO) * blend + ((color1 >> 8) & SWAR_LO) * inv)) & SWAR_HI;
+  return rb3 | wg3;
 }
 
 /*
@@ -37,27 +43,25 @@ uint32_t color_blend(uint32_t color1, uint32_t color2, uint16_t blend, bool b16)
  */
 uint32_t color_add(uint32_t c1, uint32_t c2, bool fast)
 {
+  uint32_t rb = (c1 & SWAR_LO) + (c2 & SWAR_LO);               // each lane holds sum of two channels (max 510)
+  uint32_t wg = ((c1 >> 8) & SWAR_LO) + ((c2 >> 8) & SWAR_LO);
+  uint32_t overflow = (rb | wg) & 0x01000100U;
+  if (!overflow) return rb | (wg << 8);
   if (fast) {
-    uint8_t r = R(c1);
-    uint8_t g = G(c1);
-    uint8_t b = B(c1);
-    uint8_t w = W(c1);
-    r = qadd8(r, R(c2));
-    g = qadd8(g, G(c2));
-    b = qadd8(b, B(c2));
-    w = qadd8(w, W(c2));
-    return RGBW32(r,g,b,w);
+    // saturate lanes that overflowed (same as qadd8())
+    rb |= ((rb & 0x01000100U) >> 8) * 0xFF;
+    wg |= ((wg & 0x01000100U) >> 8) * 0xFF;
+    return (rb & SWAR_LO) | ((wg & SWAR_LO) << 8);
   } else {
-    uint32_t r = R(c1) + R(c2);
-    uint32_t g = G(c1) + G(c2);
-    uint32_t b = B(c1) + B(c2);
-    uint32_t w = W(c1) + W(c2);
+    uint32_t r = rb >> 16;
+    uint32_t g = wg & 0x1FF;
+    uint32_t b = rb & 0x1FF;
+    uint32_t w = wg >> 16;
     uint16_t max = r;
     if (g > max) max = g;
     if (b > max) max = b;
     if (w > max) max = w;
-    if (max < 256) return RGBW32(r, g, b, w);
-    else           return RGBW32(r * 255 / max, g * 255 / max, b * 255 / max, w * 255 / max);
+    return RGBW32(r * 255 / max, g * 255 / max, b * 255 / max, w * 255 / max);
   }
 }
 
@@ -67,22 +71,59 @@ uint32_t color_add(uint32_t c1, uint32_t c2, bool fast)
  */
 uint32_t color_fade(uint32_t c1, uint8_t amount, bool video)
 {
-  uint8_t r = R(c1);
-  uint8_t g = G(c1);
-  uint8_t b = B(c1);
-  uint8_t w = W(c1);
+  uint32_t rb = c1 & SWAR_LO;
+  uint32_t wg = (c1 >> 8) & SWAR_LO;
   if (video) {
-    r = scale8_video(r, amount);
-    g = scale8_video(g, amount);
-    b = scale8_video(b, amount);
-    w = scale8_video(w, amount);
-  } else {
-    r = scale8(r, amount);
-    g = scale8(g, amount);
-    b = scale8(b, amount);
-    w = scale8(w, amount);
+    // scale8_video(): (i * scale) >> 8, +1 if both i and scale are non-zero
+    if (amount == 0) return 0;
+    uint32_t nzrb = ((rb + SWAR_LO) >> 8) & 0x00010001U;
+    uint32_t nzwg = ((wg + SWAR_LO) >> 8) & 0x00010001U;
+    rb = (((rb * amount) >> 8) & SWAR_LO) + nzrb;
+    wg = ((wg * amount) & SWAR_HI) + (nzwg << 8);
+    return rb | wg;
+  }
+  // scale8(): (i * (1 + scale)) >> 8
+  uint32_t scale = 1 + amount;
+  return (((rb * scale) >> 8) & SWAR_LO) | ((wg * scale) & SWAR_HI);
+}
+
+/*
+ * whole buffer variants of above functions
+ * dst[i] = color_blend(dst[i], src[i], blend) ...
+ */
+void color_blend_span(uint32_t *dst, const uint32_t *src, size_t len, uint16_t blend, bool b16)
+{
+  if (blend == 0) return;
+  if (blend == (b16 ? 0xFFFF : 0xFF)) { memcpy(dst, src, len * sizeof(uint32_t)); return; }
+  if (b16) {
+    for (size_t i = 0; i < len; i++) dst[i] = color_blend(dst[i], src[i], blend, true);
+    return;
+  }
+  const uint32_t inv = 0xFF - blend;
+  for (size_t i = 0; i < len; i++) {
+    uint32_t c1 = dst[i], c2 = src[i];
+    dst[i] = ((((c2 & SWAR_LO) * blend + (c1 & SWAR_LO) * inv) >> 8) & SWAR_LO)
+           | ((((c2 >> 8) & SWAR_LO) * blend + ((c1 >> 8) & SWAR_LO) * inv) & SWAR_HI);
+  }
+}
+
+void color_add_span(uint32_t *dst, const uint32_t *src, size_t len, bool fast)
+{
+  for (size_t i = 0; i < len; i++) dst[i] = color_add(dst[i], src[i], fast);
+}
+
+void color_fade_span(uint32_t *buf, size_t len, uint8_t amount, bool video)
+{
+  if (video) {
+    for (size_t i = 0; i < len; i++) buf[i] = color_fade(buf[i], amount, true);
+    return;
+  }
+  if (amount == 255) return; // scale8(i, 255) == i
+  const uint32_t scale = 1 + amount;
+  for (size_t i = 0; i < len; i++) {
+    uint32_t c = buf[i];
+    buf[i] = ((((c & SWAR_LO) * scale) >> 8) & SWAR_LO) | ((((c >> 8) & SWAR_LO) * scale) & SWAR_HI);
   }
-  return RGBW32(r, g, b, w);
 }
 
 void setRandomColor(byte* rgb)
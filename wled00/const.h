@@ -158,6 +158,12 @@
 #define AP_BEHAVIOR_ALWAYS                2     //Always open
 #define AP_BEHAVIOR_BUTTON_ONLY           3     //Only when button pressed for 6 sec
 
+//Sources of queued JSON API commands (json_queue.cpp)
+#define JSON_SOURCE_HTTP          0
+#define JSON_SOURCE_WS            1
+#define JSON_SOURCE_MQTT          2
+#define JSON_SOURCE_WS_BIN        3 // binary WebSocket command (ws.cpp)
+
 //Notifier callMode
 #define CALL_MODE_INIT           0     //no updates on init, can be used to disable updates
 #define CALL_MODE_DIRECT_CHANGE  1
@@ -198,6 +204,17 @@
 #define REALTIME_OVERRIDE_ONCE    1
 #define REALTIME_OVERRIDE_ALWAYS  2
 
+//realtime source merge modes (multiple E1.31/Art-Net/DDP senders)
+#define RT_MERGE_PRIORITY         0    // highest priority sender wins, senders of equal priority are merged HTP
+#define RT_MERGE_HTP              1    // highest takes precedence (per channel)
+#define RT_MERGE_LTP              2    // latest takes precedence (sender with most recent frame)
+
+//frame sync modes (frame_sync.cpp)
+#define FRAME_SYNC_OFF            0
+#define FRAME_SYNC_MASTER         1    // broadcasts clock, frames are aligned to own clock
+#define FRAME_SYNC_FOLLOWER       2    // follows clock, time base and frame rate of master
+#define FRAME_SYNC_ID          0xDF    // first byte of frame sync packets on notifier port
+
 //E1.31 DMX modes
 #define DMX_MODE_DISABLED         0            //not used
 #define DMX_MODE_SINGLE_RGB       1            //all LEDs same RGB color (3 channels)
@@ -253,7 +270,7 @@
 #define TYPE_LPD6803             54
 //Network types (master broadcast) (80-95)
 #define TYPE_NET_DDP_RGB         80            //network DDP RGB bus (master broadcast bus)
-#define TYPE_NET_E131_RGB        81            //network E131 RGB bus (master broadcast bus, unused)
+#define TYPE_NET_E131_RGB        81            //network E131 RGB bus (master broadcast bus)
 #define TYPE_NET_ARTNET_RGB      82            //network ArtNet RGB bus (master broadcast bus, unused)
 #define TYPE_NET_DDP_RGBW        88            //network DDP RGBW bus (master broadcast bus)
 
@@ -318,6 +335,12 @@
 #define SEG_OPTION_MIRROR_Y       7
 #define SEG_OPTION_TRANSPOSED     8
 
+//Effect transition curves (previous and new effect are blended in segment frame buffer)
+#define TRANSITION_LINEAR         0
+#define TRANSITION_EASE           1            //smoothstep
+#define TRANSITION_WIPE           2            //new effect replaces old one from segment start to end
+#define TRANSITION_DISSOLVE       3            //pixels switch to new effect in pseudo random order
+
 //Segment differs return byte
 #define SEG_DIFFERS_BRI        0x01 // opacity
 #define SEG_DIFFERS_OPT        0x02 // all segment options except: selected, reset & transitional
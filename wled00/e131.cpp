@@ -1,4 +1,7 @@
 #include "wled.h"
+#ifdef ARDUINO_ARCH_ESP32
+#include <esp_heap_caps.h>
+#endif
 
 #define MAX_3_CH_LEDS_PER_UNIVERSE 170
 #define MAX_4_CH_LEDS_PER_UNIVERSE 128
@@ -8,19 +11,398 @@
  * E1.31 handler
  */
 
+/*
+ * Realtime frame assembler
+ * Pixel data of multi universe E1.31/Art-Net and DDP streams is collected in a back buffer and handed
+ * over to loop() as a whole frame, so the output never mixes universes of two different frames.
+ * Every sender (protocol + IP address, covering the configured universe range) is a separate source with
+ * its own buffers and sequence numbers, so multiple senders (e.g. a backup media server) do not overwrite
+ * each other. A source frame is complete when
+ * - all universes needed for the strip have arrived (E1.31/Art-Net) or on ArtSync if the sender uses it
+ * - a DDP packet with PUSH flag arrives
+ * - a universe of the next frame arrives or RT_FRAME_TIMEOUT passed before the frame was complete ("torn" frame)
+ * loop() takes the complete frames of all sources and merges live ones (rtMergeMode: RT_MERGE_PRIORITY,
+ * RT_MERGE_HTP or RT_MERGE_LTP) while writing them to the strip. A source frame completed before loop() took
+ * the previous one replaces it (dropped frame).
+ * Each source has three buffers: back (written by the packet handler), mid (last complete frame) and front
+ * (read by loop()). Only pointers and flags are changed under RT_LOCK, pixel data is copied and merged outside
+ * of it. The packet handler refreshes back from the last complete frame before it writes the next one (partial
+ * updates). Buffers are only freed by loop() while no packet is handled.
+ * If the buffers cannot be allocated, pixels are set directly as they arrive.
+ */
+#ifndef RT_FRAME_TIMEOUT
+  #define RT_FRAME_TIMEOUT 100 // ms
+#endif
+#define RT_SYNC_TIMEOUT 4000   // ms, Art-Net receivers fall back to non-synchronous mode if there is no ArtSync for 4s
+#define RT_SOURCE_TIMEOUT 2500 // ms, source is no longer merged (E1.31 network data loss timeout)
+#define RT_DEFAULT_PRIORITY 100 // E1.31 default priority, used for Art-Net and DDP sources
+#define RT_MERGE_SPAN 64       // pixels merged at once (on stack)
+
+#ifndef RT_MAX_SOURCES
+  #ifdef ESP8266
+    #define RT_MAX_SOURCES 2
+  #else
+    #define RT_MAX_SOURCES 4
+  #endif
+#endif
+
+#ifdef ARDUINO_ARCH_ESP32
+static portMUX_TYPE rtFrameMux = portMUX_INITIALIZER_UNLOCKED; // packets are handled in async UDP task
+#define RT_LOCK()   portENTER_CRITICAL(&rtFrameMux)
+#define RT_UNLOCK() portEXIT_CRITICAL(&rtFrameMux)
+#define RT_FREE_HEAP() heap_caps_get_free_size(MALLOC_CAP_8BIT)
+#else
+#define RT_LOCK()
+#define RT_UNLOCK()
+#define RT_FREE_HEAP() ESP.getFreeHeap()
+#endif
+
+typedef struct RealtimeSource {
+  IPAddress ip;
+  uint8_t   mode = REALTIME_MODE_INACTIVE; // REALTIME_MODE_E131/ARTNET/DDP, INACTIVE if entry is unused
+  uint8_t   priority = RT_DEFAULT_PRIORITY;
+  bool      active = false;                // contributed to last merged frame (loop() only)
+  bool      fresh = false;                 // mid holds a frame loop() has not taken yet
+  bool      hasFront = false;              // front holds a frame (loop() only)
+  uint8_t   seq[E131_MAX_UNIVERSE_COUNT];  // last sequence number per universe (DDP: last push)
+  uint32_t *back  = nullptr;               // frame being assembled (packet handler only)
+  uint32_t *mid   = nullptr;               // last complete frame
+  uint32_t *front = nullptr;               // frame merged by loop()
+  const uint32_t *last = nullptr;          // complete frame back has to be refreshed from before it is written
+  uint16_t  backMax = 0;                   // highest pixel index written +1
+  uint16_t  midMax = 0;
+  uint16_t  frontMax = 0;
+  uint32_t  pending = 0;                   // universes received for frame being assembled (bit 0 = e131Universe)
+  uint32_t  expected = 0;                  // universes needed for the configured strip length
+  uint32_t  learned = 0;                   // universes sender actually sends (if it repeatedly sends less than expected)
+  uint32_t  lastIncomplete = 0;
+  unsigned long frameStart = 0;
+  unsigned long lastPacket = 0;
+  unsigned long lastFrame = 0;             // time of last complete frame (0 = none yet)
+  unsigned long lastSync = 0;              // last ArtSync received from this source
+  uint32_t  frames = 0;
+  uint32_t  torn = 0;
+  uint32_t  late = 0;                      // packets of a frame that was already presented (out of sequence)
+} rtsrc;
+
+static RealtimeSource rtSources[RT_MAX_SOURCES];
+static uint16_t rtFrameLen = 0;          // pixels in each buffer (0: no buffers)
+static bool     rtWriting = false;       // packet handler is using source buffers (changed under RT_LOCK)
+static bool     rtMerging = false;       // loop() is reading front buffers (changed under RT_LOCK)
+static bool     rtReleasePending = false; // loop() frees all buffers once no packet is handled (strip length changed, release deferred)
+
+// statistics
+static uint32_t rtFramesShown   = 0;
+static uint32_t rtFramesDropped = 0;
+static uint32_t rtSourcesRejected = 0; // packets from senders exceeding RT_MAX_SOURCES
+static uint32_t rtPacketsLate   = 0; // out of sequence packets of single universe modes
+
+// marks source buffers as in use by the packet handler for its lifetime
+struct RealtimeWriteGuard {
+  RealtimeWriteGuard()  { RT_LOCK(); rtWriting = true;  RT_UNLOCK(); }
+  ~RealtimeWriteGuard() { RT_LOCK(); rtWriting = false; RT_UNLOCK(); }
+};
+
+static inline bool rtSourceLive(const RealtimeSource &s, unsigned long now) {
+  return s.mode != REALTIME_MODE_INACTIVE && now - s.lastPacket < RT_SOURCE_TIMEOUT;
+}
+
+static inline bool rtSyncActive(const RealtimeSource *s) {
+  return s->lastSync && millis() - s->lastSync < RT_SYNC_TIMEOUT;
+}
+
+static inline bool rtFrameIsComplete(const RealtimeSource *s) {
+  return s->pending == s->expected || s->pending == s->learned;
+}
+
+// returns source for sender, creates one if sender is new (nullptr if all entries are in use by live senders)
+static RealtimeSource *rtSource(uint8_t mode, IPAddress ip)
+{
+  unsigned long now = millis();
+  RealtimeSource *src = nullptr;
+  bool reused = false;
+  RT_LOCK();
+  for (size_t i = 0; i < RT_MAX_SOURCES; i++) {
+    RealtimeSource &s = rtSources[i];
+    if (s.mode == mode && s.ip == ip) { src = &s; break; }
+  }
+  bool busy = !src && rtMerging; // loop() is reading the entries, try again with next packet
+  if (!src && !busy) { // new sender, reuse free or timed out entry (buffers are kept)
+    for (size_t i = 0; i < RT_MAX_SOURCES; i++) {
+      if (rtSourceLive(rtSources[i], now)) continue;
+      src = &rtSources[i];
+      uint32_t *back = src->back, *mid = src->mid, *front = src->front;
+      *src = RealtimeSource();
+      src->back = back; src->mid = mid; src->front = front;
+      src->mode = mode;
+      src->ip = ip;
+      memset(src->seq, 0, sizeof(src->seq));
+      reused = true;
+      break;
+    }
+  }
+  if (src) src->lastPacket = now;
+  RT_UNLOCK();
+  if (reused && src->back) memset(src->back, 0, rtFrameLen * sizeof(uint32_t)); // new sender starts with black
+  if (!src && !busy) rtSourcesRejected++;
+  return src;
+}
+
+// frees all frame buffers (loop() only), deferred if a packet is being handled
+static void rtFrameFree()
+{
+  uint32_t *bufs[3*RT_MAX_SOURCES];
+  RT_LOCK();
+  if (rtWriting) {
+    rtReleasePending = true; // next handleRealtimeFrame() frees them
+    RT_UNLOCK();
+    return;
+  }
+  for (size_t i = 0; i < RT_MAX_SOURCES; i++) {
+    RealtimeSource &s = rtSources[i];
+    bufs[3*i]   = s.back;
+    bufs[3*i+1] = s.mid;
+    bufs[3*i+2] = s.front;
+    s.back = s.mid = s.front = nullptr;
+    s.last = nullptr;
+    s.pending = 0;
+    s.backMax = s.midMax = s.frontMax = 0;
+    s.lastFrame = 0;
+    s.fresh = s.hasFront = s.active = false;
+  }
+  rtFrameLen = 0;
+  rtReleasePending = false;
+  RT_UNLOCK();
+  for (size_t i = 0; i < 3*RT_MAX_SOURCES; i++) free(bufs[i]);
+}
+
+// makes sure frame buffers of source fit the strip, returns false if they are not available (packet handler only)
+static bool rtFrameAlloc(RealtimeSource *src, uint16_t len)
+{
+  if (!len) return false;
+  RT_LOCK();
+  if (rtFrameLen && rtFrameLen != len) rtReleasePending = true; // strip length changed, loop() frees all buffers first
+  bool usable = !rtReleasePending;
+  bool allocated = src->back != nullptr;
+  RT_UNLOCK();
+  if (!usable) return false;
+  if (allocated) return true;
+
+  // keep enough heap for the web server and other allocations
+  if (RT_FREE_HEAP() < 3 * len * sizeof(uint32_t) + MIN_HEAP_SIZE) return false;
+  uint32_t *back  = (uint32_t*)calloc(len, sizeof(uint32_t));
+  uint32_t *mid   = (uint32_t*)calloc(len, sizeof(uint32_t));
+  uint32_t *front = (uint32_t*)calloc(len, sizeof(uint32_t));
+  if (!back || !mid || !front) {
+    free(back);
+    free(mid);
+    free(front);
+    return false;
+  }
+  RT_LOCK();
+  src->back  = back;
+  src->mid   = mid;
+  src->front = front;
+  src->last  = nullptr;
+  src->fresh = false;
+  src->pending = 0;
+  src->backMax = src->midMax = 0;
+  src->lastFrame = 0;
+  rtFrameLen = len;
+  RT_UNLOCK();
+  return true;
+}
+
+// brings back buffer up to date with last complete frame before pixels are written (packet handler only)
+static void rtFrameRefresh(RealtimeSource *src)
+{
+  RT_LOCK();
+  const uint32_t *last = src->last;
+  src->last = nullptr;
+  RT_UNLOCK();
+  // last is mid or front now, only read until packet handler completes another frame
+  if (last) memcpy(src->back, last, rtFrameLen * sizeof(uint32_t));
+}
+
+static inline void rtFramePixel(RealtimeSource *src, uint16_t i, uint32_t c) {
+  if (i >= rtFrameLen || !src->back) return;
+  src->back[i] = c;
+  if (i >= src->backMax) src->backMax = i + 1;
+}
+
+// completes assembled frame of source (must be called with RT_LOCK held while back is not written)
+static void rtFrameComplete(RealtimeSource *src)
+{
+  if (!rtFrameIsComplete(src)) {
+    src->torn++;
+    // learn universes the sender actually sends if the same subset arrives twice in a row
+    src->learned = (src->pending == src->lastIncomplete) ? src->pending : 0;
+    src->lastIncomplete = src->pending;
+  }
+  src->pending = 0;
+  if (!src->back) return;
+  if (src->fresh) rtFramesDropped++; // loop() did not take previous frame
+  std::swap(src->back, src->mid);
+  src->midMax = src->backMax;
+  src->last = src->mid; // next frame starts with content of this one (partial updates)
+  src->fresh = true;
+  src->lastFrame = millis();
+  if (!src->lastFrame) src->lastFrame = 1;
+  src->frames++;
+}
+
+// takes complete frames and selects sources to merge (must be called with RT_LOCK held)
+// returns true if the output changes (a source contributing to it has a new frame)
+static bool rtFrameTake()
+{
+  unsigned long now = millis();
+  bool taken[RT_MAX_SOURCES];
+  bool any = false;
+  for (size_t i = 0; i < RT_MAX_SOURCES; i++) {
+    RealtimeSource &s = rtSources[i];
+    // sender stopped in the middle of a frame
+    if (!rtWriting && s.pending && now - s.frameStart > RT_FRAME_TIMEOUT) rtFrameComplete(&s);
+    taken[i] = s.fresh;
+    if (!s.fresh) continue;
+    std::swap(s.mid, s.front);
+    s.frontMax = s.midMax;
+    s.fresh = false;
+    s.hasFront = true;
+    any = true;
+  }
+  if (!any) return false;
+
+  RealtimeSource *latest = nullptr;
+  uint8_t topPriority = 0;
+  for (size_t i = 0; i < RT_MAX_SOURCES; i++) {
+    RealtimeSource &s = rtSources[i];
+    if (!rtSourceLive(s, now) || !s.hasFront) continue;
+    if (s.priority > topPriority) topPriority = s.priority;
+    if (!latest || (long)(s.lastFrame - latest->lastFrame) > 0) latest = &s;
+  }
+  bool changed = false;
+  for (size_t i = 0; i < RT_MAX_SOURCES; i++) {
+    RealtimeSource &s = rtSources[i];
+    s.active = false;
+    if (!rtSourceLive(s, now) || !s.hasFront) continue;
+    switch (rtMergeMode) {
+      case RT_MERGE_HTP: s.active = true; break;
+      case RT_MERGE_LTP: s.active = (&s == latest); break;
+      default:           s.active = (s.priority == topPriority); break; // sources of equal priority are merged HTP
+    }
+    if (s.active && taken[i]) changed = true;
+  }
+  return changed;
+}
+
+// writes front frames of active sources to the strip, highest value per channel if there are several (loop() only)
+static void rtFrameOutput()
+{
+  const RealtimeSource *act[RT_MAX_SOURCES];
+  size_t n = 0;
+  uint16_t len = 0;
+  for (size_t i = 0; i < RT_MAX_SOURCES; i++) {
+    const RealtimeSource &s = rtSources[i];
+    if (!s.active) continue;
+    act[n++] = &s;
+    if (s.frontMax > len) len = s.frontMax;
+  }
+  if (n == 1) {
+    setRealtimePixels(0, act[0]->front, len);
+    return;
+  }
+  uint32_t span[RT_MERGE_SPAN];
+  for (uint16_t p = 0; p < len; p += RT_MERGE_SPAN) {
+    uint16_t count = len - p < RT_MERGE_SPAN ? len - p : RT_MERGE_SPAN;
+    memcpy(span, act[0]->front + p, count * sizeof(uint32_t));
+    for (size_t k = 1; k < n; k++) {
+      const uint32_t *f = act[k]->front + p;
+      for (size_t j = 0; j < count; j++) {
+        uint32_t a = span[j], b = f[j];
+        if (a == b) continue;
+        span[j] = RGBW32(MAX(R(a),R(b)), MAX(G(a),G(b)), MAX(B(a),B(b)), MAX(W(a),W(b)));
+      }
+    }
+    setRealtimePixels(p, span, count);
+  }
+}
+
+// outputs assembled frames (called from loop())
+void handleRealtimeFrame()
+{
+  if (rtReleasePending) rtFrameFree();
+  RT_LOCK();
+  bool changed = rtFrameTake();
+  rtMerging = changed; // front buffers are read until output is done
+  RT_UNLOCK();
+  if (!changed) return;
+  if (!realtimeOverride || (realtimeMode && useMainSegmentOnly)) {
+    rtFrameOutput();
+  }
+  RT_LOCK();
+  rtMerging = false;
+  RT_UNLOCK();
+  rtFramesShown++;
+  strip.show();
+}
+
+// frees frame buffers when realtime mode ends (called from loop())
+void releaseRealtimeFrame()
+{
+  rtFrameFree();
+  RT_LOCK();
+  for (size_t i = 0; i < RT_MAX_SOURCES; i++) rtSources[i].learned = rtSources[i].lastIncomplete = 0;
+  RT_UNLOCK();
+}
+
+void serializeRealtimeFrameInfo(JsonObject root)
+{
+  JsonObject rtf = root.createNestedObject(F("rtf"));
+  uint32_t torn = 0, late = rtPacketsLate;
+  bool sync = false;
+  unsigned long now = millis();
+  JsonArray sources = rtf.createNestedArray(F("src"));
+  for (size_t i = 0; i < RT_MAX_SOURCES; i++) {
+    const RealtimeSource &s = rtSources[i];
+    if (s.mode == REALTIME_MODE_INACTIVE) continue;
+    torn += s.torn;
+    late += s.late;
+    if (!rtSourceLive(s, now)) continue;
+    sync |= rtSyncActive(&s);
+    JsonObject src = sources.createNestedObject();
+    src[F("ip")]   = s.ip.toString();
+    src[F("m")]    = s.mode;
+    src[F("pri")]  = s.priority;
+    src[F("ok")]   = s.frames;
+    src[F("torn")] = s.torn;
+    src[F("late")] = s.late;
+    src[F("age")]  = now - s.lastPacket; // ms since last packet
+    src[F("act")]  = s.active;           // contributes to output
+  }
+  rtf[F("ok")]   = rtFramesShown;
+  rtf[F("torn")] = torn;
+  rtf[F("drop")] = rtFramesDropped;
+  rtf[F("late")] = late;
+  rtf[F("rej")]  = rtSourcesRejected;
+  rtf[F("sync")] = sync;
+  rtf[F("mm")]   = rtMergeMode;
+}
+
 //DDP protocol support, called by handleE131Packet
 //handles RGB data only
-void handleDDPPacket(e131_packet_t* p) {
-  int lastPushSeq = e131LastSequenceNumber[0];
+void handleDDPPacket(e131_packet_t* p, IPAddress clientIP) {
+  RealtimeSource *src = rtSource(REALTIME_MODE_DDP, clientIP);
+  if (!src) return;
+  int lastPushSeq = src->seq[0];
 
   //reject late packets belonging to previous frame (assuming 4 packets max. before push)
   if (e131SkipOutOfSequence && lastPushSeq) {
     int sn = p->sequenceNum & 0xF;
     if (sn) {
       if (lastPushSeq > 5) {
-        if (sn > (lastPushSeq -5) && sn < lastPushSeq) return;
+        if (sn > (lastPushSeq -5) && sn < lastPushSeq) { src->late++; return; }
       } else {
-        if (sn > (10 + lastPushSeq) || sn < lastPushSeq) return;
+        if (sn > (10 + lastPushSeq) || sn < lastPushSeq) { src->late++; return; }
       }
     }
   }
@@ -36,27 +418,42 @@ void handleDDPPacket(e131_packet_t* p) {
 
   realtimeLock(realtimeTimeoutMs, REALTIME_MODE_DDP);
 
-  if (!realtimeOverride || (realtimeMode && useMainSegmentOnly)) {
+  bool push = p->flags & DDP_PUSH_FLAG;
+  if (rtFrameAlloc(src, strip.getLengthTotal())) {
+    RT_LOCK();
+    if (!src->pending) src->frameStart = millis();
+    src->pending = src->expected = 1; // DDP frame is complete on push
+    RT_UNLOCK();
+    rtFrameRefresh(src);
     for (uint16_t i = start; i < stop; i++) {
-      setRealtimePixel(i, data[c], data[c+1], data[c+2], ddpChannelsPerLed >3 ? data[c+3] : 0);
+      rtFramePixel(src, i, RGBW32(data[c], data[c+1], data[c+2], ddpChannelsPerLed >3 ? data[c+3] : 0));
       c += ddpChannelsPerLed;
     }
+    if (push) {
+      RT_LOCK();
+      rtFrameComplete(src);
+      RT_UNLOCK();
+    }
+  } else if (!realtimeOverride || (realtimeMode && useMainSegmentOnly)) {
+    if (stop > start) setRealtimePixels(start, data + c, stop - start, ddpChannelsPerLed);
+    if (push) e131NewData = true;
   }
 
-  bool push = p->flags & DDP_PUSH_FLAG;
   if (push) {
-    e131NewData = true;
     byte sn = p->sequenceNum & 0xF;
-    if (sn) e131LastSequenceNumber[0] = sn;
+    if (sn) src->seq[0] = sn;
   }
 }
 
 //E1.31 and Art-Net protocol support
 void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
+  RealtimeWriteGuard rtGuard; // loop() does not free or complete source buffers meanwhile
 
   uint16_t uni = 0, dmxChannels = 0;
   uint8_t* e131_data = nullptr;
   uint8_t seq = 0, mde = REALTIME_MODE_E131;
+  uint8_t priority = RT_DEFAULT_PRIORITY;
+  const bool isMultiMode = DMXMode == DMX_MODE_MULTIPLE_RGB || DMXMode == DMX_MODE_MULTIPLE_DRGB || DMXMode == DMX_MODE_MULTIPLE_RGBW;
 
   if (protocol == P_ARTNET)
   {
@@ -64,6 +461,15 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
       handleArtnetPollReply(clientIP);
       return;
     }
+    if (p->art_opcode == ARTNET_OPCODE_OPSYNC) { // present assembled frame of this sender
+      RealtimeSource *src = rtSource(REALTIME_MODE_ARTNET, clientIP);
+      if (!src) return;
+      RT_LOCK();
+      src->lastSync = millis();
+      if (src->pending) rtFrameComplete(src);
+      RT_UNLOCK();
+      return;
+    }
     uni = p->art_universe;
     dmxChannels = htons(p->art_length);
     e131_data = p->art_data;
@@ -78,15 +484,16 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
     uni = htons(p->universe);
     e131_data = p->property_values;
     seq = p->sequence_number;
+    priority = p->priority;
     if (e131Priority != 0) {
       if (p->priority < e131Priority ) return;
-      // track highest priority & skip all lower priorities
+      // track highest priority & skip all lower priorities (sources of per pixel modes are merged by priority instead)
       if (p->priority >= highPriority.get()) highPriority.set(p->priority);
-      if (p->priority < highPriority.get()) return;
+      if (p->priority < highPriority.get() && !isMultiMode) return;
     }
   } else { //DDP
     realtimeIP = clientIP;
-    handleDDPPacket(p);
+    handleDDPPacket(p, clientIP);
     return;
   }
 
@@ -104,18 +511,29 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
 
   uint8_t previousUniverses = uni - e131Universe;
 
+  // per pixel data is assembled per sender, each sender has its own sequence numbers
+  RealtimeSource *src = nullptr;
+  if (isMultiMode) {
+    src = rtSource(mde, clientIP);
+    if (!src) return;
+    src->priority = priority;
+  }
+  byte *lastSequenceNumber = src ? src->seq : e131LastSequenceNumber;
+
   if (e131SkipOutOfSequence)
-    if (seq < e131LastSequenceNumber[previousUniverses] && seq > 20 && e131LastSequenceNumber[previousUniverses] < 250){
+    if (seq < lastSequenceNumber[previousUniverses] && seq > 20 && lastSequenceNumber[previousUniverses] < 250){
       DEBUG_PRINT(F("skipping E1.31 frame (last seq="));
-      DEBUG_PRINT(e131LastSequenceNumber[previousUniverses]);
+      DEBUG_PRINT(lastSequenceNumber[previousUniverses]);
       DEBUG_PRINT(F(", current seq="));
       DEBUG_PRINT(seq);
       DEBUG_PRINT(F(", universe="));
       DEBUG_PRINT(uni);
       DEBUG_PRINTLN(")");
+      if (src) src->late++;
+      else rtPacketsLate++;
       return;
     }
-  e131LastSequenceNumber[previousUniverses] = seq;
+  lastSequenceNumber[previousUniverses] = seq;
 
   // update status info
   realtimeIP = clientIP;
@@ -268,6 +686,8 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
         const uint16_t ledsPerUniverse = is4Chan ? MAX_4_CH_LEDS_PER_UNIVERSE : MAX_3_CH_LEDS_PER_UNIVERSE;
         uint8_t stripBrightness = bri;
         uint16_t previousLeds, dmxOffset, ledsTotal;
+        const uint16_t dimmerOffset = (DMXMode == DMX_MODE_MULTIPLE_DRGB) ? 1 : 0;
+        const uint16_t ledsInFirstUniverse = (((MAX_CHANNELS_PER_UNIVERSE - DMXAddress) + dmxLenOffset) - dimmerOffset) / dmxChannelsPerLed;
 
         if (previousUniverses == 0) {
           if (availDMXLen < 1) return;
@@ -283,8 +703,6 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
         } else {
           // All subsequent universes start at the first channel.
           dmxOffset = (protocol == P_ARTNET) ? 0 : 1;
-          const uint16_t dimmerOffset = (DMXMode == DMX_MODE_MULTIPLE_DRGB) ? 1 : 0;
-          uint16_t ledsInFirstUniverse = (((MAX_CHANNELS_PER_UNIVERSE - DMXAddress) + dmxLenOffset) - dimmerOffset) / dmxChannelsPerLed;
           previousLeds = ledsInFirstUniverse + (previousUniverses - 1) * ledsPerUniverse;
           ledsTotal = previousLeds + (dmxChannels / dmxChannelsPerLed);
         }
@@ -308,16 +726,31 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
           }
         }
 
-        if (!is4Chan) {
+        if (rtFrameAlloc(src, totalLen)) {
+          // universes needed to cover the strip
+          uint16_t universes = 1;
+          if (totalLen > ledsInFirstUniverse) universes += (totalLen - ledsInFirstUniverse + ledsPerUniverse - 1) / ledsPerUniverse;
+          if (universes > E131_MAX_UNIVERSE_COUNT) universes = E131_MAX_UNIVERSE_COUNT;
+          uint32_t bit = 1UL << previousUniverses;
+          RT_LOCK();
+          src->expected = (universes >= 32) ? UINT32_MAX : (1UL << universes) - 1;
+          if (src->pending & bit) rtFrameComplete(src); // universe of next frame, current one is incomplete
+          if (!src->pending) src->frameStart = millis();
+          src->pending |= bit;
+          RT_UNLOCK();
+          rtFrameRefresh(src);
           for (uint16_t i = previousLeds; i < ledsTotal; i++) {
-            setRealtimePixel(i, e131_data[dmxOffset], e131_data[dmxOffset+1], e131_data[dmxOffset+2], 0);
-            dmxOffset+=3;
+            rtFramePixel(src, i, RGBW32(e131_data[dmxOffset], e131_data[dmxOffset+1], e131_data[dmxOffset+2], is4Chan ? e131_data[dmxOffset+3] : 0));
+            dmxOffset += dmxChannelsPerLed;
           }
-        } else {
-          for (uint16_t i = previousLeds; i < ledsTotal; i++) {
-            setRealtimePixel(i, e131_data[dmxOffset], e131_data[dmxOffset+1], e131_data[dmxOffset+2], e131_data[dmxOffset+3]);
-            dmxOffset+=4;
+          if (rtFrameIsComplete(src) && !rtSyncActive(src)) {
+            RT_LOCK();
+            rtFrameComplete(src);
+            RT_UNLOCK();
           }
+          return; // presented by handleRealtimeFrame()
+        } else if (ledsTotal > previousLeds) {
+          setRealtimePixels(previousLeds, e131_data + dmxOffset, ledsTotal - previousLeds, dmxChannelsPerLed);
         }
         break;
       }
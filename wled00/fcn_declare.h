@@ -65,6 +65,9 @@ class NeoGammaWLEDMethod {
 uint32_t color_blend(uint32_t,uint32_t,uint16_t,bool b16=false);
 uint32_t color_add(uint32_t,uint32_t, bool fast=false);
 uint32_t color_fade(uint32_t c1, uint8_t amount, bool video=false);
+void color_blend_span(uint32_t *dst, const uint32_t *src, size_t len, uint16_t blend, bool b16=false);
+void color_add_span(uint32_t *dst, const uint32_t *src, size_t len, bool fast=false);
+void color_fade_span(uint32_t *buf, size_t len, uint8_t amount, bool video=false);
 inline uint32_t colorFromRgbw(byte* rgbw) { return uint32_t((byte(rgbw[3]) << 24) | (byte(rgbw[0]) << 16) | (byte(rgbw[1]) << 8) | (byte(rgbw[2]))); }
 void colorHStoRGB(uint16_t hue, byte sat, byte* rgb); //hue, sat to rgb
 void colorKtoRGB(uint16_t kelvin, byte* rgb);
@@ -86,6 +89,9 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol);
 void handleArtnetPollReply(IPAddress ipAddress);
 void prepareArtnetPollReply(ArtPollReply* reply);
 void sendArtnetPollReply(ArtPollReply* reply, IPAddress ipAddress, uint16_t portAddress);
+void handleRealtimeFrame();
+void releaseRealtimeFrame();
+void serializeRealtimeFrameInfo(JsonObject root);
 
 //file.cpp
 bool handleFileRead(AsyncWebServerRequest*, String path);
@@ -93,8 +99,16 @@ bool writeObjectToFileUsingId(const char* file, uint16_t id, JsonDocument* conte
 bool writeObjectToFile(const char* file, const char* key, JsonDocument* content);
 bool readObjectFromFileUsingId(const char* file, uint16_t id, JsonDocument* dest);
 bool readObjectFromFile(const char* file, const char* key, JsonDocument* dest);
+bool readLedmapFile(const char* file, uint16_t** table, uint16_t* len, char* name = nullptr);
 void updateFSInfo();
 void closeFile();
+void invalidatePresetIndex();
+
+//frame_sync.cpp
+uint64_t frameSyncMicros();
+void handleFrameSync();
+void handleFrameSyncPacket(const byte *udpIn, size_t len, IPAddress sender, uint64_t rxUs);
+void serializeFrameSyncInfo(JsonObject root);
 
 //hue.cpp
 void handleHue();
@@ -148,8 +162,8 @@ bool deserializeState(JsonObject root, byte callMode = CALL_MODE_DIRECT_CHANGE,
 void serializeSegment(JsonObject& root, Segment& seg, byte id, bool forPreset = false, bool segmentBounds = true);
 void serializeState(JsonObject root, bool forPreset = false, bool includeBri = true, bool segmentBounds = true, bool selectedSegmentsOnly = false);
 void serializeInfo(JsonObject root);
-void serializeModeNames(JsonArray root);
-void serializeModeData(JsonArray root);
+void serializeModeNames(Print& dest);
+void serializeModeData(Print& dest);
 void serveJson(AsyncWebServerRequest* request);
 #ifdef WLED_ENABLE_JSONLIVE
 bool serveLiveLeds(AsyncWebServerRequest* request, uint32_t wsClient = 0);
@@ -206,6 +220,8 @@ void unloadPlaylist();
 int16_t loadPlaylist(JsonObject playlistObject, byte presetId = 0);
 void handlePlaylist();
 void serializePlaylist(JsonObject obj);
+bool presetInPlaylist(byte preset);
+byte getPlaylistPreset(byte i);
 
 //presets.cpp
 void initPresetsFile();
@@ -217,6 +233,9 @@ void savePreset(byte index, const char* pname = nullptr, JsonObject saveobj = Js
 inline void saveTemporaryPreset() {savePreset(255);};
 void deletePreset(byte index);
 bool getPresetName(byte index, String& name);
+void invalidatePresetCache(byte index = 0);
+void markPresetCacheDirty();
+void precachePlaylistPresets();
 
 //remote.cpp
 void handleRemote();
@@ -228,11 +247,17 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply=tru
 
 //udp.cpp
 void notify(byte callMode, bool followUp=false);
-uint8_t realtimeBroadcast(uint8_t type, IPAddress client, uint16_t length, uint8_t *buffer, uint8_t bri=255, bool isRGBW=false);
+uint8_t realtimeBroadcast(uint8_t type, IPAddress client, uint16_t length, uint8_t *buffer, uint8_t bri=255, bool isRGBW=false, uint16_t from=0, uint16_t to=UINT16_MAX);
+size_t realtimeHeaderLen(uint8_t type);
+size_t realtimeChannelsPerPacket(uint8_t type, bool isRGBW);
+void realtimeInitPackets(uint8_t type, uint8_t *buffer, uint16_t length, bool isRGBW);
 void realtimeLock(uint32_t timeoutMs, byte md = REALTIME_MODE_GENERIC);
 void exitRealtime();
 void handleNotifications();
 void setRealtimePixel(uint16_t i, byte r, byte g, byte b, byte w);
+void serializeNotifierInfo(JsonObject root);
+void setRealtimePixels(uint16_t i, const uint8_t *data, uint16_t count, uint8_t channels);
+void setRealtimePixels(uint16_t i, const uint32_t *c, uint16_t count);
 void refreshNodeList();
 void sendSysInfoUDP();
 
@@ -419,10 +444,16 @@ String dmxProcessor(const String& var);
 void serveSettings(AsyncWebServerRequest* request, bool post = false);
 void serveSettingsJS(AsyncWebServerRequest* request);
 
+//json_queue.cpp
+bool queueJsonCommand(const char *json, size_t len, uint8_t source, uint32_t client = 0);
+void handleJsonQueue();
+void serializeJsonQueueInfo(JsonObject root);
+
 //ws.cpp
 void handleWs();
 void wsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventType type, void * arg, uint8_t *data, size_t len);
 void sendDataWs(AsyncWebSocketClient * client = nullptr);
+void handleWsBinaryCommand(const uint8_t *data, size_t len, uint32_t client);
 
 //xml.cpp
 void XML_response(AsyncWebServerRequest *request, char* dest = nullptr);
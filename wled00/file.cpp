@@ -80,6 +80,88 @@ static bool bufferedFind(const char *target, bool fromStart = true) {
   return false;
 }
 
+/*
+ * Offset index of presets.json: file position of each preset object (just after its "id": key).
+ * It is built with a single pass over the file on first use and kept up to date when presets
+ * are written so reading (applying) a preset does not need to scan the whole file.
+ * Index is rebuilt if file size changed behind our back (e.g. /edit) or a stale entry is detected.
+ */
+#define PRESET_INDEX_SIZE 251                   // preset ids 0-250
+static uint32_t presetIndex[PRESET_INDEX_SIZE]; // 0 = preset does not exist
+static size_t   presetIndexFileSize = 0;        // size of presets.json the index is valid for (0 = invalid)
+static int      presetIndexId = -1;             // preset id being read/written (-1 if not an indexed file)
+
+void invalidatePresetIndex() {
+  presetIndexFileSize = 0;
+}
+
+static void buildPresetIndex() {
+  #ifdef WLED_DEBUG_FS
+    uint32_t s = millis();
+  #endif
+  memset(presetIndex, 0, sizeof(presetIndex));
+  presetIndexFileSize = 0;
+  if (!f || !f.size()) return;
+
+  byte     buf[FS_BUFSIZE];
+  unsigned depth = 0;
+  bool     inString = false, escaped = false, isKey = false;
+  int      id = -1;       // root level key (only numeric keys are valid ids)
+  size_t   pos = 0;
+  f.seek(0);
+  while (pos < f.size()) {
+    size_t bufsize = f.read(buf, FS_BUFSIZE);
+    if (!bufsize) break;
+    for (size_t i = 0; i < bufsize; i++, pos++) {
+      char c = buf[i];
+      if (inString) {
+        if (escaped)          escaped = false;
+        else if (c == '\\')   escaped = true;
+        else if (c == '"')    inString = false;
+        else if (id >= 0)     id = (c >= '0' && c <= '9' && id < PRESET_INDEX_SIZE) ? id * 10 + c - '0' : PRESET_INDEX_SIZE;
+        continue;
+      }
+      switch (c) {
+        case '"': inString = true; isKey = (depth == 1); id = isKey ? 0 : -1; break;
+        case ':': if (isKey && id >= 0 && id < PRESET_INDEX_SIZE && !presetIndex[id]) presetIndex[id] = pos + 1; isKey = false; break;
+        case '{': case '[': depth++; isKey = false; break;
+        case '}': case ']': if (depth) depth--; isKey = false; break;
+        case ' ': case '\n': case '\r': case '\t': break;
+        default:  isKey = false; break;
+      }
+    }
+  }
+  presetIndex[0] = 0; // "0" is a dummy object
+  presetIndexFileSize = f.size();
+  DEBUGFS_PRINTF("Preset index built, took %d ms\n", millis() - s);
+}
+
+//find() for preset files, uses offset index for presets.json
+static bool findKey(const char *key) {
+  if (presetIndexId < 0 || presetIndexId >= PRESET_INDEX_SIZE) return bufferedFind(key);
+  if (!f || !f.size()) return false;
+  if (presetIndexFileSize != f.size()) buildPresetIndex();
+  if (!presetIndexFileSize) return bufferedFind(key);
+
+  uint32_t pos = presetIndex[presetIndexId];
+  if (!pos) return false;
+  // verify that key is still where we expect it (file leaves f positioned just after the key like bufferedFind())
+  size_t keyLen = strlen(key);
+  char   buf[12];
+  if (pos >= keyLen && keyLen <= sizeof(buf)) {
+    f.seek(pos - keyLen);
+    if (f.read((uint8_t*)buf, keyLen) == keyLen && !memcmp(buf, key, keyLen)) return true;
+  }
+  DEBUGFS_PRINTLN(F("Stale preset index."));
+  invalidatePresetIndex();
+  return bufferedFind(key);
+}
+
+//record new position of preset being written (pos == 0 if it was deleted)
+static void updatePresetIndex(uint32_t pos) {
+  if (presetIndexId >= 0 && presetIndexId < PRESET_INDEX_SIZE && presetIndexFileSize) presetIndex[presetIndexId] = pos;
+}
+
 //find empty spots in file stream in 256-byte blocks.
 static bool bufferedFindSpace(size_t targetLen, bool fromStart = true) {
 
@@ -189,6 +271,7 @@ bool appendObjectToFile(const char* key, JsonDocument* content, uint32_t s, uint
     char init[10];
     strcpy_P(init, PSTR("{\"0\":{}}"));
     f.print(init);
+    invalidatePresetIndex(); // will be rebuilt on next access
   }
 
   if (content->isNull()) {
@@ -202,6 +285,7 @@ bool appendObjectToFile(const char* key, JsonDocument* content, uint32_t s, uint
   if (bufferedFindSpace(contentLen + strlen(key) + 1)) {
     if (f.position() > 2) f.write(','); //add comma if not first object
     f.print(key);
+    updatePresetIndex(f.position());
     serializeJson(*content, f);
     DEBUGFS_PRINTF("Inserted, took %d ms (total %d)", millis() - s1, millis() - s);
     doCloseFile = true;
@@ -242,13 +326,16 @@ bool appendObjectToFile(const char* key, JsonDocument* content, uint32_t s, uint
   } else { //file content is not valid JSON object
     f.seek(0, SeekSet);
     f.print('{'); //start JSON
+    invalidatePresetIndex();
   }
 
   f.print(key);
+  updatePresetIndex(f.position());
 
   //Append object
   serializeJson(*content, f);
   f.write('}');
+  if (presetIndexFileSize && f.position() > presetIndexFileSize) presetIndexFileSize = f.position(); // file grew
 
   doCloseFile = true;
   DEBUGFS_PRINTF("Appended, took %d ms (total %d)", millis() - s1, millis() - s);
@@ -259,7 +346,10 @@ bool writeObjectToFileUsingId(const char* file, uint16_t id, JsonDocument* conte
 {
   char objKey[10];
   sprintf(objKey, "\"%d\":", id);
-  return writeObjectToFile(file, objKey, content);
+  presetIndexId = strcmp_P(file, PSTR("/presets.json")) ? -1 : id;
+  bool success = writeObjectToFile(file, objKey, content);
+  presetIndexId = -1;
+  return success;
 }
 
 bool writeObjectToFile(const char* file, const char* key, JsonDocument* content)
@@ -279,7 +369,7 @@ bool writeObjectToFile(const char* file, const char* key, JsonDocument* content)
     return false;
   }
 
-  if (!bufferedFind(key)) //key does not exist in file
+  if (!findKey(key)) //key does not exist in file
   {
     return appendObjectToFile(key, content, s);
   }
@@ -317,6 +407,7 @@ bool writeObjectToFile(const char* file, const char* key, JsonDocument* content)
     if (pos > 3) pos--; //also delete leading comma if not first object
     f.seek(pos);
     writeSpace(pos2 - pos);
+    updatePresetIndex(0);
     if (contentLen) return appendObjectToFile(key, content, s, contentLen);
   }
 
@@ -329,7 +420,10 @@ bool readObjectFromFileUsingId(const char* file, uint16_t id, JsonDocument* dest
 {
   char objKey[10];
   sprintf(objKey, "\"%d\":", id);
-  return readObjectFromFile(file, objKey, dest);
+  presetIndexId = strcmp_P(file, PSTR("/presets.json")) ? -1 : id;
+  bool success = readObjectFromFile(file, objKey, dest);
+  presetIndexId = -1;
+  return success;
 }
 
 //if the key is a nullptr, deserialize entire object
@@ -343,7 +437,7 @@ bool readObjectFromFile(const char* file, const char* key, JsonDocument* dest)
   f = WLED_FS.open(file, "r");
   if (!f) return false;
 
-  if (key != nullptr && !bufferedFind(key)) //key does not exist in file
+  if (key != nullptr && !findKey(key)) //key does not exist in file
   {
     f.close();
     dest->clear();
@@ -358,6 +452,79 @@ bool readObjectFromFile(const char* file, const char* key, JsonDocument* dest)
   return true;
 }
 
+/*
+ * Binary ledmap files (.lmb), see tools/ledmap2lmb.py
+ * They are streamed directly into the mapping table, no JSON buffer is needed.
+ * All multi byte values are little endian.
+ *   0 "LMB"  magic
+ *   3 uint8  format version (1)
+ *   4 uint16 number of map entries
+ *   6 uint8  flags (bit 0: entries are run length encoded)
+ *   7 uint8  length of ledmap name (0-32), followed by the name (not terminated)
+ *     entries: uint16 physical LED index for each entry (0xFFFF: no LED)
+ *     or (RLE) runs: uint16 first index, uint16 run length (1-16383) | step << 14
+ *     where step 0 increments, 1 decrements and 2 repeats the index
+ */
+#define LMB_VERSION  1
+#define LMB_FLAG_RLE 0x01
+
+//if table is a nullptr, only the header (name) is read
+bool readLedmapFile(const char* file, uint16_t** table, uint16_t* len, char* name)
+{
+  File mf = WLED_FS.open(file, "r");
+  if (!mf) return false;
+
+  uint8_t hdr[8];
+  if (mf.read(hdr, sizeof(hdr)) != sizeof(hdr) || memcmp_P(hdr, PSTR("LMB"), 3) || hdr[3] != LMB_VERSION) {
+    DEBUG_PRINTLN(F("Invalid binary ledmap."));
+    mf.close();
+    return false;
+  }
+  uint16_t count = hdr[4] | (hdr[5] << 8);
+  if (name) {
+    size_t nameLen = mf.read((uint8_t*)name, hdr[7] > 32 ? 32 : hdr[7]);
+    name[nameLen] = '\0';
+  }
+  if (!table) {
+    mf.close();
+    return true;
+  }
+  mf.seek(sizeof(hdr) + hdr[7]);
+
+  uint16_t *map = count ? new uint16_t[count] : nullptr;
+  if (count && !map) {
+    DEBUG_PRINTLN(F("Ledmap alloc error."));
+    mf.close();
+    return false;
+  }
+  size_t pos = 0;
+  if (!(hdr[6] & LMB_FLAG_RLE)) {
+    pos = mf.read((uint8_t*)map, count * sizeof(uint16_t)) / sizeof(uint16_t); // ESP8266 and ESP32 are little endian
+  } else {
+    uint8_t buf[FS_BUFSIZE];
+    while (pos < count) {
+      size_t n = mf.read(buf, sizeof(buf)) & ~3U; // whole runs only (file consists of 4 byte runs)
+      if (n == 0) break;
+      for (size_t i = 0; i < n && pos < count; i += 4) {
+        uint16_t idx  = buf[i]   | (buf[i+1] << 8);
+        uint16_t ctrl = buf[i+2] | (buf[i+3] << 8);
+        int      step = (ctrl >> 14) == 0 ? 1 : ((ctrl >> 14) == 1 ? -1 : 0);
+        for (unsigned run = ctrl & 0x3FFF; run > 0 && pos < count; run--, idx += step) map[pos++] = idx;
+      }
+    }
+  }
+  mf.close();
+
+  if (pos != count) {
+    DEBUG_PRINTLN(F("Truncated binary ledmap."));
+    delete[] map;
+    return false;
+  }
+  *table = map;
+  *len   = count;
+  return true;
+}
+
 void updateFSInfo() {
   #ifdef ARDUINO_ARCH_ESP32
     #if WLED_FS == LITTLEFS || ESP_IDF_VERSION_MAJOR >= 4
@@ -383,6 +550,7 @@ static String getContentType(AsyncWebServerRequest* request, String filename){
   else if(filename.endsWith(".css")) return "text/css";
   else if(filename.endsWith(".js")) return "application/javascript";
   else if(filename.endsWith(".json")) return "application/json";
+  else if(filename.endsWith(".lmb")) return "application/octet-stream";
   else if(filename.endsWith(".png")) return "image/png";
   else if(filename.endsWith(".gif")) return "image/gif";
   else if(filename.endsWith(".jpg")) return "image/jpeg";
@@ -0,0 +1,298 @@
+#include "wled.h"
+#ifdef ARDUINO_ARCH_ESP32
+#include "esp_timer.h"
+#endif
+
+/*
+ * Frame synchronization across multiple WLED nodes
+ * The master (frameSyncMode == FRAME_SYNC_MASTER) announces itself, its frame time and effect time base
+ * by broadcast on the notifier port. Followers measure the offset of their clock to the master clock
+ * with NTP style round trips (delay request/response with 4 time stamps), keep the samples with the
+ * shortest round trip time and estimate the drift (skew) of their clock from the offset over time.
+ * Frame N is due at master time N * frame time on every node: the master and all followers align
+ * WS2812FX frame pacing (alignFrames()) to that grid and followers set strip.timebase to the one of
+ * the master, so effects are rendered with the same time and shown at the same instant.
+ * While locked, followers use the frame time of the master (setFrameTimeOverride(), their own target FPS is kept)
+ * and restore their frame time and timebase when the lock is lost or frame sync mode changes.
+ *
+ * packet: [FRAME_SYNC_ID][FRAME_SYNC_VERSION][type][sync groups] followed by (big endian)
+ *   FS_ANNOUNCE:   [master time (8)][frame time us (4)][frame number (4)][effect time offset (4)]
+ *   FS_DELAY_REQ:  [follower send time (8)]
+ *   FS_DELAY_RESP: [follower send time (8)][master receive time (8)][master send time (8)][frame time us (4)]
+ *                  [effect time offset (4)][Toki time source (1)][Toki sec (4)][Toki ms (2)]
+ * Effect time offset is (millis() + strip.timebase) - master time / 1000, so effect time can be derived from master time.
+ */
+
+#define FRAME_SYNC_VERSION     1
+#define FS_ANNOUNCE            0
+#define FS_DELAY_REQ           1
+#define FS_DELAY_RESP          2
+#define FS_ANNOUNCE_LEN        28
+#define FS_DELAY_REQ_LEN       12
+#define FS_DELAY_RESP_LEN      47
+
+#define FS_ANNOUNCE_INTERVAL   1000  // ms
+#define FS_REQUEST_INTERVAL    500   // ms
+#define FS_MASTER_TIMEOUT      5000  // ms without announce until follower is unlocked
+#define FS_SAMPLES             8     // round trip samples kept for filtering
+#define FS_SKEW_MIN_SPAN       10000000LL // us, minimum time between offset estimates used for skew estimation
+
+typedef struct FrameSyncSample {
+  int64_t  offset;  // master time - local time (us)
+  uint32_t rtt;     // round trip time (us)
+  uint64_t time;    // local time of sample
+} fssample;
+
+static FrameSyncSample fsSamples[FS_SAMPLES];
+static uint8_t   fsSampleCnt = 0;
+static uint8_t   fsSamplePos = 0;
+static IPAddress fsMasterIP;
+static unsigned long fsLastAnnounce = 0;  // master: sent, follower: received
+static unsigned long fsLastRequest = 0;
+static uint32_t  fsFrameUs = 0;           // frame time of master
+static uint32_t  fsEffectOffset = 0;      // effect time offset of master
+static int64_t   fsRefOffset = 0;         // offset estimate used as reference for skew
+static uint64_t  fsRefTime = 0;
+static float     fsSkew = 0.0f;           // drift of local clock relative to master (us per us)
+static uint32_t  fsJitter = 0;            // running average of deviation of samples from estimate (us)
+static uint32_t  fsPhase = 0;             // running average of frame phase corrections (us)
+static uint32_t  fsSamplesTotal = 0;
+static bool      fsFollowing = false;     // follower uses frame time and timebase of master
+static uint32_t  fsLocalTimebase = 0;     // strip.timebase before following master
+
+// 64 bit micros() (does not roll over)
+uint64_t frameSyncMicros() {
+  #ifdef ARDUINO_ARCH_ESP32
+  return esp_timer_get_time();
+  #else
+  return micros64();
+  #endif
+}
+
+static inline void fsPut32(byte *p, uint32_t v) { p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v; }
+static inline void fsPut64(byte *p, uint64_t v) { fsPut32(p, v >> 32); fsPut32(p + 4, v); }
+static inline uint32_t fsGet32(const byte *p) { return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3]; }
+static inline uint64_t fsGet64(const byte *p) { return (uint64_t(fsGet32(p)) << 32) | fsGet32(p + 4); }
+
+static inline bool fsLocked() {
+  return fsSampleCnt >= FS_SAMPLES/2 && fsLastAnnounce && millis() - fsLastAnnounce < FS_MASTER_TIMEOUT;
+}
+
+// follower: uses frame time of master while locked, restores local frame time and timebase when lock is lost
+static void fsUpdateFollower() {
+  bool follow = frameSyncMode == FRAME_SYNC_FOLLOWER && fsLocked();
+  if (follow && !fsFollowing) fsLocalTimebase = strip.timebase;
+  if (!follow && fsFollowing) strip.timebase = fsLocalTimebase;
+  fsFollowing = follow;
+  strip.setFrameTimeOverride(follow ? fsFrameUs : 0);
+}
+
+// best sample: the one with shortest round trip (least affected by network and loop() delays)
+static const FrameSyncSample *fsBestSample() {
+  const FrameSyncSample *best = nullptr;
+  for (size_t i = 0; i < fsSampleCnt; i++) {
+    if (!best || fsSamples[i].rtt < best->rtt) best = &fsSamples[i];
+  }
+  return best;
+}
+
+// estimated offset of master clock at given local time
+static int64_t fsOffsetAt(uint64_t localUs) {
+  const FrameSyncSample *best = fsBestSample();
+  if (!best) return 0;
+  return best->offset + (int64_t)(fsSkew * (float)(int64_t)(localUs - best->time));
+}
+
+static void fsSend(IPAddress ip, const byte *buf, size_t len) {
+  notifierUdp.beginPacket(ip, udpPort);
+  notifierUdp.write(buf, len);
+  notifierUdp.endPacket();
+}
+
+static inline void fsHeader(byte *buf, uint8_t type) {
+  buf[0] = FRAME_SYNC_ID;
+  buf[1] = FRAME_SYNC_VERSION;
+  buf[2] = type;
+  buf[3] = syncGroups;
+}
+
+static inline uint32_t fsLocalEffectOffset(uint64_t us) {
+  return (millis() + strip.timebase) - (uint32_t)(us / 1000);
+}
+
+// aligns frames to grid of frame time on master clock (frame N at N * frame time), offset is master - local time
+static void fsAlignFrames(int64_t offset) {
+  const uint32_t frameUs = strip.getTargetFrameTime();
+  if (!frameUs) return;
+  uint32_t renderUs = strip.getEffectTime();
+  if (renderUs > frameUs) renderUs = frameUs;
+  uint64_t masterUs = frameSyncMicros() + offset + renderUs; // earliest master time the next frame can be shown
+  uint64_t frameN   = masterUs / frameUs + 1;                // first frame boundary after that
+  uint64_t showUs   = frameN * frameUs - offset;             // local time of frame boundary
+  uint32_t err = abs(strip.alignFrames((uint32_t)showUs));
+  fsPhase = (3 * fsPhase + err + 2) >> 2;
+}
+
+// periodic tasks (called from handleNotifications())
+void handleFrameSync()
+{
+  fsUpdateFollower(); // master timeout or mode change
+  if (frameSyncMode == FRAME_SYNC_OFF || !udpConnected) return;
+  unsigned long now = millis();
+
+  if (frameSyncMode == FRAME_SYNC_MASTER) {
+    if (now - fsLastAnnounce < FS_ANNOUNCE_INTERVAL) return;
+    fsLastAnnounce = now;
+    byte buf[FS_ANNOUNCE_LEN];
+    uint64_t us = frameSyncMicros();
+    uint32_t frameUs = strip.getTargetFrameTime();
+    fsHeader(buf, FS_ANNOUNCE);
+    fsPut64(buf + 4, us);
+    fsPut32(buf + 12, frameUs);
+    fsPut32(buf + 16, frameUs ? us / frameUs : 0);
+    fsPut32(buf + 20, fsLocalEffectOffset(us));
+    fsPut32(buf + 24, 0); // reserved
+    IPAddress broadcastIp = ~uint32_t(Network.subnetMask()) | uint32_t(Network.gatewayIP());
+    fsSend(broadcastIp, buf, FS_ANNOUNCE_LEN);
+    fsAlignFrames(0); // master clock is the reference
+    return;
+  }
+
+  // follower
+  if (!fsLastAnnounce || now - fsLastAnnounce > FS_MASTER_TIMEOUT) return; // no master
+  if (now - fsLastRequest < FS_REQUEST_INTERVAL) return;
+  fsLastRequest = now;
+  byte buf[FS_DELAY_REQ_LEN];
+  fsHeader(buf, FS_DELAY_REQ);
+  fsPut64(buf + 4, frameSyncMicros());
+  fsSend(fsMasterIP, buf, FS_DELAY_REQ_LEN);
+}
+
+// adds offset measurement and applies new estimate to clock and frame pacing
+static void fsAddSample(int64_t offset, uint32_t rtt, uint64_t localUs)
+{
+  if (fsSampleCnt) {
+    int64_t dev = offset - fsOffsetAt(localUs);
+    if (dev < 0) dev = -dev;
+    if (dev > 0xFFFFFF) dev = 0xFFFFFF;
+    fsJitter = (3 * fsJitter + (uint32_t)dev + 2) >> 2;
+  }
+  fsSamples[fsSamplePos] = {offset, rtt, localUs};
+  fsSamplePos = (fsSamplePos + 1) % FS_SAMPLES;
+  if (fsSampleCnt < FS_SAMPLES) fsSampleCnt++;
+  fsSamplesTotal++;
+
+  // skew from change of best offset over time
+  const FrameSyncSample *best = fsBestSample();
+  if (!fsRefTime) {
+    fsRefOffset = best->offset;
+    fsRefTime   = best->time;
+  } else if ((int64_t)(best->time - fsRefTime) > FS_SKEW_MIN_SPAN) {
+    float skew = (float)(best->offset - fsRefOffset) / (float)(int64_t)(best->time - fsRefTime);
+    if (skew > -0.001f && skew < 0.001f) fsSkew = (3.0f * fsSkew + skew) / 4.0f; // ignore implausible values (>1000 ppm)
+    fsRefOffset = best->offset;
+    fsRefTime   = best->time;
+  }
+  fsUpdateFollower();
+  if (!fsFollowing) return;
+
+  // effects use time base of master
+  int64_t offsetNow = fsOffsetAt(frameSyncMicros());
+  uint32_t masterMs = (uint32_t)((frameSyncMicros() + offsetNow) / 1000);
+  strip.timebase = masterMs + fsEffectOffset - millis();
+  fsAlignFrames(offsetNow);
+}
+
+// handles frame sync packet received on notifier port, rxUs is local time of reception
+void handleFrameSyncPacket(const byte *udpIn, size_t len, IPAddress sender, uint64_t rxUs)
+{
+  if (len < 4 || udpIn[0] != FRAME_SYNC_ID || udpIn[1] != FRAME_SYNC_VERSION) return;
+
+  switch (udpIn[2]) {
+    case FS_ANNOUNCE:
+      if (frameSyncMode != FRAME_SYNC_FOLLOWER || len < FS_ANNOUNCE_LEN || !(receiveGroups & udpIn[3])) return;
+      if (!(sender == fsMasterIP)) { // new master, samples of previous one are useless
+        fsMasterIP = sender;
+        fsSampleCnt = fsSamplePos = 0;
+        fsRefTime = 0;
+        fsSkew = 0.0f;
+      }
+      fsLastAnnounce = millis();
+      fsFrameUs      = fsGet32(udpIn + 12);
+      fsEffectOffset = fsGet32(udpIn + 20);
+      fsUpdateFollower(); // same frame grid as master
+      break;
+
+    case FS_DELAY_REQ:
+      if (frameSyncMode != FRAME_SYNC_MASTER || len < FS_DELAY_REQ_LEN) return;
+      {
+        byte buf[FS_DELAY_RESP_LEN];
+        fsHeader(buf, FS_DELAY_RESP);
+        memcpy(buf + 4, udpIn + 4, 8); // follower send time
+        fsPut64(buf + 12, rxUs);
+        fsPut32(buf + 28, strip.getTargetFrameTime());
+        buf[36] = toki.getTimeSource();
+        Toki::Time tm = toki.getTime();
+        fsPut32(buf + 37, tm.sec);
+        buf[41] = tm.ms >> 8;
+        buf[42] = tm.ms & 0xFF;
+        uint64_t txUs = frameSyncMicros();
+        fsPut64(buf + 20, txUs);
+        fsPut32(buf + 32, fsLocalEffectOffset(txUs));
+        fsPut32(buf + 43, 0); // reserved
+        fsSend(sender, buf, FS_DELAY_RESP_LEN);
+      }
+      break;
+
+    case FS_DELAY_RESP:
+      if (frameSyncMode != FRAME_SYNC_FOLLOWER || len < FS_DELAY_RESP_LEN || !(sender == fsMasterIP)) return;
+      {
+        uint64_t t1 = fsGet64(udpIn + 4);  // follower send
+        uint64_t t2 = fsGet64(udpIn + 12); // master receive
+        uint64_t t3 = fsGet64(udpIn + 20); // master send
+        uint64_t t4 = rxUs;                // follower receive
+        if (t4 < t1 || t3 < t2) return;
+        int64_t  rtt = (int64_t)(t4 - t1) - (int64_t)(t3 - t2);
+        if (rtt < 0 || rtt > 1000000) return; // response to an old request
+        int64_t offset = ((int64_t)(t2 - t1) + (int64_t)(t3 - t4)) / 2;
+        fsEffectOffset = fsGet32(udpIn + 32);
+
+        // system time of master if it is more accurate
+        if (udpIn[36] > toki.getTimeSource()) {
+          Toki::Time tm;
+          tm.sec = fsGet32(udpIn + 37);
+          tm.ms  = (udpIn[41] << 8) | udpIn[42];
+          toki.adjust(tm, (rtt / 2 + (frameSyncMicros() - t4)) / 1000);
+          uint8_t ts = TOKI_TS_UDP;
+          if (udpIn[36] > 99) ts = TOKI_TS_UDP_NTP;
+          else if (udpIn[36] >= TOKI_TS_SEC) ts = TOKI_TS_UDP_SEC;
+          toki.setTime(tm, ts);
+        }
+        fsAddSample(offset, rtt, t4);
+      }
+      break;
+  }
+}
+
+void serializeFrameSyncInfo(JsonObject root)
+{
+  if (frameSyncMode == FRAME_SYNC_OFF) return;
+  JsonObject fs = root.createNestedObject(F("fsync"));
+  fs[F("mode")] = frameSyncMode;
+  fs[F("ph")]   = fsPhase;    // avg. frame phase correction (us)
+  if (frameSyncMode == FRAME_SYNC_MASTER) {
+    uint32_t frameUs = strip.getTargetFrameTime();
+    fs[F("frame")] = frameUs ? (uint32_t)(frameSyncMicros() / frameUs) : 0;
+    return;
+  }
+  const FrameSyncSample *best = fsBestSample();
+  int64_t offset = fsOffsetAt(frameSyncMicros());
+  fs[F("lock")]  = fsLocked();
+  fs[F("mip")]   = fsMasterIP.toString();
+  fs[F("off")]   = (int32_t)(offset > INT32_MAX ? INT32_MAX : (offset < INT32_MIN ? INT32_MIN : offset)); // master - local clock (us)
+  fs[F("jit")]   = fsJitter; // avg. deviation of measurements from estimate (us)
+  fs[F("rtt")]   = best ? best->rtt : 0;
+  fs[F("skew")]  = fsSkew * 1e6f; // ppm
+  fs[F("n")]     = fsSamplesTotal;
+  fs[F("frame")] = fsFrameUs ? (uint32_t)((frameSyncMicros() + offset) / fsFrameUs) : 0;
+}
@@ -1,6 +1,7 @@
 #include "wled.h"
 
 #include "palettes.h"
+#include <memory>
 
 #define JSON_PATH_STATE      1
 #define JSON_PATH_INFO       2
@@ -612,6 +613,22 @@ void serializeInfo(JsonObject root)
   leds[F("count")] = strip.getLengthTotal();
   leds[F("pwr")] = strip.currentMilliamps;
   leds["fps"] = strip.getFps();
+  leds[F("fxus")] = strip.getEffectTime(); // avg. us per frame spent in effects
+  leds[F("shus")] = strip.getShowTime();   // avg. us per frame spent in show()
+  uint32_t frameUs = strip.getEffectTime() + strip.getShowTime();
+  leds[F("pps")] = frameUs ? (uint32_t)((uint64_t)strip.getLengthTotal() * 1000000ULL / frameUs) : 0; // pixels/s render+output throughput
+  leds[F("ftus")] = strip.getTargetFrameTime();  // target us between frames
+  leds[F("ft50")] = strip.getFrameInterval(50);   // median us between recent frames
+  leds[F("ft99")] = strip.getFrameInterval(99);   // 99th percentile us between recent frames
+  #if WLED_FX_CORES > 1
+  leds[F("fxsave")] = strip.getRenderTimeSaved(); // avg. us per frame saved by rendering segments on both cores
+  #endif
+  leds[F("defer")] = strip.getDeferTime(); // avg. us a rendered frame waited until all busses could take it (includes loop() latency)
+  JsonArray busWait = leds.createNestedArray(F("wait")); // avg. us a frame was blocked by previous transfer of each bus
+  for (size_t b = 0; b < busses.getNumBusses(); b++) {
+    Bus *bus = busses.getBus(b);
+    if (bus) busWait.add(bus->getWaitTime());
+  }
   leds[F("maxpwr")] = (strip.currentMilliamps)? strip.ablMilliampsMax : 0;
   leds[F("maxseg")] = strip.getMaxSegments();
   //leds[F("actseg")] = strip.getActiveSegmentsNum();
@@ -676,6 +693,9 @@ void serializeInfo(JsonObject root)
   } else {
     root[F("lip")] = realtimeIP.toString();
   }
+  serializeRealtimeFrameInfo(root);
+  serializeNotifierInfo(root);
+  serializeFrameSyncInfo(root);
 
   #ifdef WLED_ENABLE_WEBSOCKETS
   root[F("ws")] = ws.count();
@@ -743,6 +763,21 @@ void serializeInfo(JsonObject root)
   #if defined(ARDUINO_ARCH_ESP32) && defined(BOARD_HAS_PSRAM)
   if (psramFound()) root[F("psram")] = ESP.getFreePsram();
   #endif
+
+  Segment::arenastats_t arena;
+  Segment::getArenaStats(arena);
+  JsonObject segdata = root.createNestedObject(F("segdata")); // segment runtime data arena
+  segdata[F("size")]  = arena.size;
+  segdata[F("used")]  = Segment::getUsedSegmentData(); // payload accounted against MAX_SEGMENT_DATA
+  segdata[F("free")]  = arena.free;
+  segdata[F("maxfree")] = arena.maxFree;
+  segdata[F("trans")] = arena.transition; // part of used, duplicated for mode blending
+  segdata[F("blocks")]  = arena.blocks;
+  segdata[F("frag")]  = arena.free ? 100 - (arena.maxFree * 100U) / arena.free : 0; // % of free space not usable as one block
+  segdata[F("fail")]  = arena.fails;
+  segdata[F("cmp")]   = arena.compactions;
+
+  serializeJsonQueueInfo(root);
   root[F("uptime")] = millis()/1000 + rolloverMillis*4294967;
 
   char time[32];
@@ -982,47 +1017,77 @@ void serializeNodes(JsonObject root)
   }
 }
 
-// deserializes mode data string into JsonArray
-void serializeModeData(JsonArray fxdata)
+// writes string as quoted and escaped JSON string (no JSON buffer needed)
+static void printJsonString(Print &dest, const char *str)
 {
-  char lineBuffer[256];
-  for (size_t i = 0; i < strip.getModeCount(); i++) {
-    strncpy_P(lineBuffer, strip.getModeData(i), sizeof(lineBuffer)/sizeof(char)-1);
-    lineBuffer[sizeof(lineBuffer)/sizeof(char)-1] = '\0'; // terminate string
-    if (lineBuffer[0] != 0) {
-      char* dataPtr = strchr(lineBuffer,'@');
-      if (dataPtr) fxdata.add(dataPtr+1);
-      else         fxdata.add("");
-    }
+  dest.write('"');
+  for (; *str; str++) {
+    char c = *str;
+    if (c == '"' || c == '\\')  { dest.write('\\'); dest.write(c); }
+    else if ((uint8_t)c < 0x20) dest.printf_P(PSTR("\\u%04X"), (unsigned)c);
+    else                        dest.write(c);
   }
+  dest.write('"');
 }
 
-// deserializes mode names string into JsonArray
-// also removes effect data extensions (@...) from deserialised names
-void serializeModeNames(JsonArray arr)
+// streams effect data (part after '@' of mode data string) as JSON array
+// or effect names if names is true (effect data extensions are removed)
+static void printModeInfo(Print &dest, bool names)
 {
   char lineBuffer[256];
+  bool first = true;
+  dest.write('[');
   for (size_t i = 0; i < strip.getModeCount(); i++) {
     strncpy_P(lineBuffer, strip.getModeData(i), sizeof(lineBuffer)/sizeof(char)-1);
     lineBuffer[sizeof(lineBuffer)/sizeof(char)-1] = '\0'; // terminate string
     if (lineBuffer[0] != 0) {
       char* dataPtr = strchr(lineBuffer,'@');
-      if (dataPtr) *dataPtr = 0; // terminate mode data after name
-      arr.add(lineBuffer);
+      if (!first) dest.write(',');
+      first = false;
+      if (names) {
+        if (dataPtr) *dataPtr = 0; // terminate mode data after name
+        printJsonString(dest, lineBuffer);
+      } else {
+        printJsonString(dest, dataPtr ? dataPtr+1 : "");
+      }
     }
   }
+  dest.write(']');
 }
 
+void serializeModeData(Print &dest)
+{
+  printModeInfo(dest, false);
+}
 
-// Global buffer locking response helper class
-class GlobalBufferAsyncJsonResponse: public JSONBufferGuard, public AsyncJsonResponse {
-  public:
-  inline GlobalBufferAsyncJsonResponse(bool isArray) : JSONBufferGuard(17), AsyncJsonResponse(&doc, isArray) {};
-  virtual ~GlobalBufferAsyncJsonResponse() {};
-
-  // Other members are inherited
-};
+void serializeModeNames(Print &dest)
+{
+  printModeInfo(dest, true);
+}
 
+// chunked response for effect names/data and the parts of /json that come from flash (effect names and palettes)
+// only head (serialized state and info) is held in RAM while the client receives the response,
+// AsyncResponseStream would buffer the whole response (effects and palettes are several kB) on heap
+static AsyncWebServerResponse *beginJsonChunkedResponse(AsyncWebServerRequest* request, std::shared_ptr<char> head, size_t headLen, byte subJson)
+{
+  return request->beginChunkedResponse("application/json", [head, headLen, subJson](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+    ChunkPrint dest(buffer, index, maxLen); // response is printed again for every chunk, only this chunk is kept
+    switch (subJson) {
+      case JSON_PATH_EFFECTS: serializeModeNames(dest); break;
+      case JSON_PATH_FXDATA:  serializeModeData(dest);  break;
+      default:
+        dest.write((const uint8_t*)head.get(), headLen);
+        if (subJson != JSON_PATH_STATE_INFO) {
+          dest.print(F(",\"effects\":"));
+          serializeModeNames(dest); // remove WLED-SR extensions from effect names
+          dest.print(F(",\"palettes\":"));
+          dest.print(FPSTR(JSON_palette_names));
+        }
+        dest.write('}');
+    }
+    return dest.written();
+  });
+}
 
 void serveJson(AsyncWebServerRequest* request)
 {
@@ -1054,14 +1119,18 @@ void serveJson(AsyncWebServerRequest* request)
     return;
   }
 
-  GlobalBufferAsyncJsonResponse *response = new GlobalBufferAsyncJsonResponse(subJson==JSON_PATH_FXDATA || subJson==JSON_PATH_EFFECTS); // will clear and convert JsonDocument into JsonArray if necessary
-  if (!response->owns_lock()) {
+  // effect names and data do not need JSON buffer, they are streamed directly from flash
+  if (subJson == JSON_PATH_EFFECTS || subJson == JSON_PATH_FXDATA) {
+    request->send(beginJsonChunkedResponse(request, nullptr, 0, subJson));
+    return;
+  }
+
+  if (!requestJSONBufferLock(17)) {
     request->send(503, "application/json", F("{\"error\":3}"));
-    delete response;
     return;
   }
 
-  JsonVariant lDoc = response->getRoot();
+  JsonObject lDoc = doc.to<JsonObject>();
 
   switch (subJson)
   {
@@ -1073,10 +1142,6 @@ void serveJson(AsyncWebServerRequest* request)
       serializeNodes(lDoc); break;
     case JSON_PATH_PALETTES:
       serializePalettes(lDoc, request->hasParam("page") ? request->getParam("page")->value().toInt() : 0); break;
-    case JSON_PATH_EFFECTS:
-      serializeModeNames(lDoc); break;
-    case JSON_PATH_FXDATA:
-      serializeModeData(lDoc); break;
     case JSON_PATH_NETWORKS:
       serializeNetworks(lDoc); break;
     default: //all
@@ -1084,22 +1149,38 @@ void serveJson(AsyncWebServerRequest* request)
       serializeState(state);
       JsonObject info = lDoc.createNestedObject("info");
       serializeInfo(info);
-      if (subJson != JSON_PATH_STATE_INFO)
-      {
-        JsonArray effects = lDoc.createNestedArray(F("effects"));
-        serializeModeNames(effects); // remove WLED-SR extensions from effect names
-        lDoc[F("palettes")] = serialized((const __FlashStringHelper*)JSON_palette_names);
-      }
       //lDoc["m"] = lDoc.memoryUsage(); // JSON buffer usage, for remote debugging
   }
 
-  DEBUG_PRINTF("JSON buffer size: %u for request: %d\n", lDoc.memoryUsage(), subJson);
-
-  #ifdef WLED_DEBUG
-  size_t len =
-  #endif
-  response->setLength();
-  DEBUG_PRINT(F("JSON content length: ")); DEBUG_PRINTLN(len);
+  DEBUG_PRINTF("JSON buffer size: %u for request: %d\n", doc.memoryUsage(), subJson);
+
+  // JSON buffer is serialized right away and released before response is sent
+  // so slow clients do not hold the lock (and other requests do not fail with error 3)
+  if (subJson == 0 || subJson == JSON_PATH_STATE_INFO) {
+    // only state and info are kept in RAM until the client received them, effect names and palettes follow from flash
+    size_t len = measureJson(lDoc["state"]) + measureJson(lDoc["info"]) + 17; // {"state": ,"info":
+    std::shared_ptr<char> head((char*)malloc(len+1), free);
+    if (!head) {
+      releaseJSONBufferLock();
+      request->send(503, "application/json", F("{\"error\":3}"));
+      return;
+    }
+    char *buf = head.get();
+    strcpy_P(buf, PSTR("{\"state\":"));
+    size_t pos = strlen(buf);
+    pos += serializeJson(lDoc["state"], buf + pos, len + 1 - pos);
+    strcpy_P(buf + pos, PSTR(",\"info\":"));
+    pos += strlen(buf + pos);
+    pos += serializeJson(lDoc["info"], buf + pos, len + 1 - pos);
+    releaseJSONBufferLock();
+    DEBUG_PRINT(F("JSON state and info length: ")); DEBUG_PRINTLN(pos);
+    request->send(beginJsonChunkedResponse(request, head, pos, subJson));
+    return;
+  }
+  AsyncResponseStream *response = request->beginResponseStream("application/json");
+  serializeJson(doc, *response);
+  releaseJSONBufferLock();
+  DEBUG_PRINT(F("JSON content length: ")); DEBUG_PRINTLN(response->available());
 
   request->send(response);
 }
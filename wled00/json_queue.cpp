@@ -0,0 +1,169 @@
+#include "wled.h"
+#include <atomic>
+
+/*
+ * JSON API command queue
+ * Network callbacks (HTTP, WebSockets, MQTT) do not apply state changes themselves (and do not wait for
+ * the global JSON buffer), they copy received JSON into the queue and return. Queued commands are applied
+ * in one batch from loop() before strip.service().
+ * HTTP POST to /json (without "v") is answered with {"success":true} once the command is queued, before it
+ * is parsed and applied; commands that turn out to be invalid are counted in info "jq" "err" only.
+ * Binary WebSocket commands (JSON_SOURCE_WS_BIN, see ws.cpp) use the same queue but do not need the JSON buffer.
+ * Queue is a lock-free ring buffer with a single consumer (loop()) and producers running in the async
+ * TCP task (ESP32) or system context (ESP8266); producers never run concurrently with each other.
+ */
+
+#ifndef WLED_JSON_QUEUE_SIZE
+  #ifdef ESP8266
+    #define WLED_JSON_QUEUE_SIZE 4
+  #else
+    #define WLED_JSON_QUEUE_SIZE 8
+  #endif
+#endif
+
+typedef struct JsonCommand {
+  char    *json;    // received JSON (null terminated, owned by queue)
+  uint32_t time;    // millis() when queued
+  uint16_t len;     // length of received data (without terminator)
+  uint32_t client;  // WebSocket client to respond to (0 if none)
+  uint8_t  source;  // JSON_SOURCE_*
+} jcmd;
+
+#ifdef WLED_ENABLE_WEBSOCKETS
+extern uint16_t wsLiveClientId; // ws.cpp
+#endif
+
+static JsonCommand          jsonQueue[WLED_JSON_QUEUE_SIZE];
+static std::atomic<uint8_t> jsonQueueHead(0); // next free slot (written by producer)
+static std::atomic<uint8_t> jsonQueueTail(0); // oldest queued command (written by consumer)
+
+// statistics
+static uint8_t  jsonQueueMaxDepth = 0;
+static uint32_t jsonQueueDrops    = 0;
+static uint32_t jsonQueueErrors   = 0;  // queued commands that could not be parsed (already answered if HTTP)
+static uint32_t jsonQueueApplied  = 0;
+static uint16_t jsonQueueLatency  = 0;  // running average of time from queueing to applying (ms)
+static uint16_t jsonQueueMaxLatency = 0;
+
+static inline uint8_t jsonQueueDepth(uint8_t head, uint8_t tail) {
+  return (head + WLED_JSON_QUEUE_SIZE - tail) % WLED_JSON_QUEUE_SIZE;
+}
+
+// copies JSON command into queue, returns false if queue is full
+bool queueJsonCommand(const char *json, size_t len, uint8_t source, uint32_t client)
+{
+  uint8_t head = jsonQueueHead.load(std::memory_order_relaxed);
+  uint8_t tail = jsonQueueTail.load(std::memory_order_acquire);
+  uint8_t next = (head + 1) % WLED_JSON_QUEUE_SIZE;
+  if (next == tail) {
+    jsonQueueDrops++;
+    DEBUG_PRINTLN(F("JSON queue full!"));
+    return false;
+  }
+  char *copy = (char*)malloc(len + 1);
+  if (!copy) {
+    jsonQueueDrops++;
+    return false;
+  }
+  memcpy(copy, json, len);
+  copy[len] = '\0';
+
+  JsonCommand &cmd = jsonQueue[head];
+  cmd.json   = copy;
+  cmd.time   = millis();
+  cmd.len    = len;
+  cmd.client = client;
+  cmd.source = source;
+  jsonQueueHead.store(next, std::memory_order_release); // publish command
+
+  uint8_t depth = jsonQueueDepth(next, tail);
+  if (depth > jsonQueueMaxDepth) jsonQueueMaxDepth = depth;
+  return true;
+}
+
+// applies all queued commands (called from loop())
+void handleJsonQueue()
+{
+  uint8_t tail = jsonQueueTail.load(std::memory_order_relaxed);
+  uint8_t head = jsonQueueHead.load(std::memory_order_acquire);
+  if (tail == head) return;
+
+  bool locked = false; // JSON buffer is only requested if there is a JSON command in queue
+  uint32_t clients[WLED_JSON_QUEUE_SIZE]; // WS clients expecting a reply
+  bool     verbose[WLED_JSON_QUEUE_SIZE]; // reply with full state instead of "success"
+  size_t   numClients = 0;
+
+  while (tail != head) {
+    JsonCommand &cmd = jsonQueue[tail];
+    if (cmd.source == JSON_SOURCE_WS_BIN) {
+      handleWsBinaryCommand((const uint8_t*)cmd.json, cmd.len, cmd.client);
+    } else if (!locked && (jsonBufferLock || !(locked = requestJSONBufferLock(22)))) {
+      break; // buffer in use (requestJSONBufferLock() would wait for it), try again in next loop()
+    } else {
+      DeserializationError error = deserializeJson(doc, cmd.json);
+      JsonObject root = doc.as<JsonObject>();
+      if (!error && !root.isNull()) {
+        bool verboseResponse = false;
+        if (cmd.source == JSON_SOURCE_WS && root["v"] && root.size() == 1) {
+          //if the received value is just "{"v":true}", send only to this client
+          verboseResponse = true;
+        } else if (cmd.source == JSON_SOURCE_WS && root.containsKey("lv")) {
+          #ifdef WLED_ENABLE_WEBSOCKETS
+          wsLiveClientId = root["lv"] ? cmd.client : 0;
+          #endif
+        } else {
+          verboseResponse = deserializeState(root);
+        }
+        if (cmd.source == JSON_SOURCE_WS) {
+          size_t i = 0;
+          while (i < numClients && clients[i] != cmd.client) i++;
+          if (i == numClients && numClients < WLED_JSON_QUEUE_SIZE) {
+            clients[numClients] = cmd.client;
+            verbose[numClients++] = false;
+          }
+          if (i < numClients) verbose[i] |= verboseResponse;
+        }
+      } else {
+        jsonQueueErrors++;
+      }
+    }
+
+    uint32_t latency = millis() - cmd.time;
+    if (latency > 0xFFFF) latency = 0xFFFF;
+    jsonQueueLatency = (3 * jsonQueueLatency + latency + 2) >> 2;
+    if (latency > jsonQueueMaxLatency) jsonQueueMaxLatency = latency;
+    jsonQueueApplied++;
+
+    free(cmd.json);
+    cmd.json = nullptr;
+    tail = (tail + 1) % WLED_JSON_QUEUE_SIZE;
+    jsonQueueTail.store(tail, std::memory_order_release); // free slot
+    head = jsonQueueHead.load(std::memory_order_acquire); // include commands queued meanwhile
+  }
+
+  if (locked) releaseJSONBufferLock();
+
+  #ifdef WLED_ENABLE_WEBSOCKETS
+  if (!interfaceUpdateCallMode) { // individual client response only needed if no WS broadcast soon
+    // we have to send something back otherwise WS connection closes
+    for (size_t i = 0; i < numClients; i++) {
+      AsyncWebSocketClient *client = ws.client(clients[i]);
+      if (!client) continue;
+      if (verbose[i]) sendDataWs(client);
+      else            client->text(F("{\"success\":true}"));
+    }
+  }
+  #endif
+}
+
+void serializeJsonQueueInfo(JsonObject root)
+{
+  JsonObject jq = root.createNestedObject(F("jq"));
+  jq[F("len")]  = jsonQueueDepth(jsonQueueHead.load(), jsonQueueTail.load()); // commands waiting
+  jq[F("max")]  = jsonQueueMaxDepth;
+  jq[F("drop")] = jsonQueueDrops;
+  jq[F("err")]  = jsonQueueErrors;    // invalid JSON (HTTP POST was answered with success when queued)
+  jq[F("cnt")]  = jsonQueueApplied;
+  jq[F("lat")]  = jsonQueueLatency;   // avg. ms from receiving to applying command
+  jq[F("latmax")] = jsonQueueMaxLatency;
+}
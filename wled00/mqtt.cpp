@@ -103,20 +103,19 @@ void onMqttMessage(char* topic, char* payload, AsyncMqttClientMessageProperties
     colorFromDecOrHexString(col, payloadStr);
     colorUpdated(CALL_MODE_DIRECT_CHANGE);
   } else if (strcmp_P(topic, PSTR("/api")) == 0) {
-    if (!requestJSONBufferLock(15)) {
-      delete[] payloadStr;
-      payloadStr = nullptr;
-      return;
-    }
-    if (payloadStr[0] == '{') { //JSON API
-      deserializeJson(doc, payloadStr);
-      deserializeState(doc.as<JsonObject>());
+    if (payloadStr[0] == '{') { //JSON API, applied from loop()
+      queueJsonCommand(payloadStr, strlen(payloadStr), JSON_SOURCE_MQTT);
     } else { //HTTP API
+      if (!requestJSONBufferLock(15)) {
+        delete[] payloadStr;
+        payloadStr = nullptr;
+        return;
+      }
       String apireq = "win"; apireq += '&'; // reduce flash string usage
       apireq += payloadStr;
       handleSet(nullptr, apireq);
+      releaseJSONBufferLock();
     }
-    releaseJSONBufferLock();
   } else if (strlen(topic) != 0) {
     // non standard topic, check with usermods
     usermods.onMqttMessage(topic, payloadStr);
@@ -115,6 +115,7 @@ int16_t loadPlaylist(JsonObject playlistObj, byte presetId) {
   if (shuffle) playlistOptions |= PL_OPTION_SHUFFLE;
 
   currentPlaylist = presetId;
+  precachePlaylistPresets(); // read entries into preset cache while playlist runs
   DEBUG_PRINTLN(F("Playlist loaded."));
   return currentPlaylist;
 }
@@ -151,6 +152,18 @@ void handlePlaylist() {
 }
 
 
+// true if preset is an entry of the active playlist
+bool presetInPlaylist(byte preset) {
+  for (int i=0; playlistEntries != nullptr && i<playlistLen; i++) if (playlistEntries[i].preset == preset) return true;
+  return false;
+}
+
+// preset of active playlist entry i (0 if there is no such entry)
+byte getPlaylistPreset(byte i) {
+  return (playlistEntries != nullptr && i < playlistLen) ? playlistEntries[i].preset : 0;
+}
+
+
 void serializePlaylist(JsonObject sObj) {
   JsonObject playlist = sObj.createNestedObject(F("playlist"));
   JsonArray ps = playlist.createNestedArray("ps");
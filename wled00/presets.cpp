@@ -20,6 +20,122 @@ static const char *getFileName(bool persist = true) {
   return persist ? "/presets.json" : "/tmp.json";
 }
 
+/*
+ * RAM cache of recently applied presets so that repeated applies (playlists) do not read flash.
+ * Presets are stored MessagePack encoded (more compact than JSON and faster to deserialize), a cache hit
+ * still deserializes the preset into the JSON buffer and applies it with deserializeState().
+ * When cache is full least recently used preset is evicted, presets of active playlist are kept if possible.
+ * Entries of a loaded playlist are read into the cache ahead of time while nothing else uses the JSON buffer.
+ * Cache is invalidated when presets are saved/deleted or presets.json is uploaded, changed or deleted (/edit).
+ * Cache is only accessed from loop(), web server handlers use markPresetCacheDirty() instead of invalidatePresetCache().
+ */
+#ifndef WLED_PRESET_CACHE_SIZE
+  #ifdef ESP8266
+    #define WLED_PRESET_CACHE_SIZE  4       // number of cached presets
+    #define WLED_PRESET_CACHE_BYTES 2048    // total size of cached presets
+  #else
+    #define WLED_PRESET_CACHE_SIZE  16
+    #define WLED_PRESET_CACHE_BYTES 16384
+  #endif
+#endif
+
+typedef struct PresetCacheEntry {
+  uint8_t  *data;   // MessagePack encoded preset (nullptr if entry is unused)
+  uint16_t len;
+  uint8_t  id;
+  uint32_t used;    // LRU counter
+} pce;
+
+static PresetCacheEntry presetCache[WLED_PRESET_CACHE_SIZE];
+static size_t           presetCacheBytes = 0;
+static uint32_t         presetCacheCounter = 0;
+static int16_t          presetCachePrefetch = -1; // next playlist entry to read into cache (-1 if none)
+static volatile bool    presetCacheDirty = false; // set by web server task, whole cache is invalidated in handlePresets()
+
+static void freeCacheEntry(PresetCacheEntry &e) {
+  if (!e.data) return;
+  free(e.data);
+  presetCacheBytes -= e.len;
+  e.data = nullptr;
+  e.len  = 0;
+  e.id   = 0;
+}
+
+// invalidate cached preset (or all presets if index is 0)
+void invalidatePresetCache(byte index) {
+  for (auto &e : presetCache) if (e.data && (index == 0 || e.id == index)) freeCacheEntry(e);
+}
+
+// requests invalidation of the whole cache from another task (async web server), done in handlePresets()
+void markPresetCacheDirty() {
+  presetCacheDirty = true;
+}
+
+static bool readPresetFromCache(byte index, JsonDocument *dest) {
+  for (auto &e : presetCache) {
+    if (!e.data || e.id != index) continue;
+    e.used = ++presetCacheCounter;
+    // const pointer makes ArduinoJson copy strings, entry may be freed while state is applied (i.e. by saving a preset)
+    return deserializeMsgPack(*dest, (const uint8_t*)e.data, e.len) == DeserializationError::Ok;
+  }
+  return false;
+}
+
+static bool isPresetCached(byte index) {
+  for (auto &e : presetCache) if (e.data && e.id == index) return true;
+  return false;
+}
+
+// returns false if preset was not stored (too large, out of memory or only playlist entries could be evicted if !evictPlaylist)
+static bool storePresetInCache(byte index, JsonDocument *src, bool evictPlaylist = true) {
+  size_t len = measureMsgPack(*src);
+  if (len == 0 || len > WLED_PRESET_CACHE_BYTES / 2) return false; // too large to be worth caching
+  invalidatePresetCache(index);
+  // evict entries until there is a free slot and enough space
+  for (;;) {
+    PresetCacheEntry *freeSlot = nullptr, *victim = nullptr;
+    for (auto &e : presetCache) {
+      if (!e.data) { if (!freeSlot) freeSlot = &e; continue; }
+      // prefer evicting presets that are not part of the active playlist
+      if (!victim || (presetInPlaylist(victim->id) && !presetInPlaylist(e.id))
+                  || (presetInPlaylist(victim->id) == presetInPlaylist(e.id) && e.used < victim->used)) victim = &e;
+    }
+    if (freeSlot && presetCacheBytes + len <= WLED_PRESET_CACHE_BYTES) {
+      freeSlot->data = (uint8_t*)malloc(len);
+      if (!freeSlot->data) return false;
+      freeSlot->len  = serializeMsgPack(*src, freeSlot->data, len);
+      freeSlot->id   = index;
+      freeSlot->used = ++presetCacheCounter;
+      presetCacheBytes += freeSlot->len;
+      return true;
+    }
+    if (!victim || (!evictPlaylist && presetInPlaylist(victim->id))) return false;
+    freeCacheEntry(*victim);
+  }
+}
+
+// called when a playlist is loaded
+void precachePlaylistPresets() {
+  presetCachePrefetch = 0;
+}
+
+// reads one not yet cached entry of the active playlist into cache (uses JSON buffer, call only if it is free)
+static void prefetchPlaylistPreset() {
+  byte id = 0;
+  while (presetCachePrefetch >= 0 && !id) {
+    id = getPlaylistPreset(presetCachePrefetch);
+    if (!id) presetCachePrefetch = -1;          // end of playlist
+    else {
+      presetCachePrefetch++;
+      if (id > 250 || isPresetCached(id)) id = 0; // nothing to read
+    }
+  }
+  if (!id || !requestJSONBufferLock(9)) return; // will also assign fileDoc
+  // stop if cache is full of playlist entries, they would evict each other while playlist runs
+  if (readObjectFromFileUsingId(getFileName(), id, fileDoc) && !storePresetInCache(id, fileDoc, false)) presetCachePrefetch = -1;
+  releaseJSONBufferLock();
+}
+
 static void doSaveState() {
   bool persist = (presetToSave < 251);
   const char *filename = getFileName(persist);
@@ -67,7 +183,10 @@ static void doSaveState() {
   #endif
   writeObjectToFileUsingId(filename, presetToSave, fileDoc);
 
-  if (persist) presetsModifiedTime = toki.second(); //unix time
+  if (persist) {
+    presetsModifiedTime = toki.second(); //unix time
+    invalidatePresetCache(presetToSave);
+  }
   releaseJSONBufferLock();
   updateFSInfo();
 
@@ -131,12 +250,21 @@ void applyPresetWithFallback(uint8_t index, uint8_t callMode, uint8_t effectID,
 
 void handlePresets()
 {
+  if (presetCacheDirty) {
+    presetCacheDirty = false;
+    invalidatePresetCache();
+  }
+
   if (presetToSave) {
     doSaveState();
     return;
   }
 
-  if (presetToApply == 0 || fileDoc) return; // no preset waiting to apply, or JSON buffer is already allocated, return to loop until free
+  if (fileDoc) return; // JSON buffer is already allocated, return to loop until free
+  if (presetToApply == 0) { // no preset waiting to apply
+    if (presetCachePrefetch >= 0) prefetchPlaylistPreset();
+    return;
+  }
 
   bool changePreset = false;
   uint8_t tmpPreset = presetToApply; // store temporary since deserializeState() may call applyPreset()
@@ -160,8 +288,12 @@ void handlePresets()
     errorFlag = ERR_NONE;
   } else
   #endif
-  {
+  if (tmpPreset < 255 && readPresetFromCache(tmpPreset, fileDoc)) {
+    DEBUG_PRINTLN(F("Preset from cache."));
+    errorFlag = ERR_NONE;
+  } else {
   errorFlag = readObjectFromFileUsingId(filename, tmpPreset, fileDoc) ? ERR_NONE : ERR_FS_PLOAD;
+  if (!errorFlag && tmpPreset < 255) storePresetInCache(tmpPreset, fileDoc);
   }
   fdo = fileDoc->as<JsonObject>();
 
@@ -232,6 +364,7 @@ void savePreset(byte index, const char* pname, JsonObject sObj)
       initPresetsFile(); // just in case if someone deleted presets.json using /edit
       writeObjectToFileUsingId(getFileName(index<255), index, fileDoc);
       presetsModifiedTime = toki.second(); //unix time
+      invalidatePresetCache(index);
       updateFSInfo();
     } else {
       // store playlist
@@ -246,5 +379,6 @@ void deletePreset(byte index) {
   StaticJsonDocument<24> empty;
   writeObjectToFileUsingId(getFileName(), index, &empty);
   presetsModifiedTime = toki.second(); //unix time
+  invalidatePresetCache(index);
   updateFSInfo();
 }
\ No newline at end of file
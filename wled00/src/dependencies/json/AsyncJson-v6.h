@@ -52,6 +52,7 @@ class ChunkPrint : public Print {
     {
       return this->Print::write(buffer, size);
     }
+    size_t written() const { return _pos; }
 };
 
 class AsyncJsonResponse: public AsyncAbstractResponse {
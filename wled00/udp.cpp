@@ -10,23 +10,86 @@
 #define UDP_IN_MAXSIZE 1472
 #define PRESUMED_NETWORK_DELAY 3 //how many ms could it take on avg to reach the receiver? This will be added to transmitted times
 
-void notify(byte callMode, bool followUp)
+/*
+ * Delta notifier protocol
+ * If notifyDelta is enabled, a full notifier packet (keyframe) is followed by delta packets that contain only
+ * the bytes of the notifier packet which differ from the keyframe, so a lost delta is repaired by the next one.
+ * Keyframes carry a trailer with the sequence number (ignored by older receivers), a new keyframe is sent every
+ * NOTIFIER_KEYFRAME_INTERVAL ms while changes are sent or if a delta would exceed half the packet size.
+ * Receivers compare the reconstructed packet with the state they applied last and only apply changed parts.
+ * Receivers keep the last keyframe of up to NOTIFIER_RX_SENDERS senders, so several nodes can send deltas.
+ *
+ * keyframe trailer: [NOTIFIER_DELTA_ID][NOTIFIER_DELTA_VERSION][seq MSB][seq LSB]
+ * delta packet:     [NOTIFIER_DELTA_ID][NOTIFIER_DELTA_VERSION][sync groups][seq MSB][seq LSB][keyframe seq MSB][keyframe seq LSB][call mode]
+ *                   followed by runs of changed bytes: [offset MSB][offset LSB][length][length bytes]
+ */
+#define NOTIFIER_DELTA_ID          0xDE
+#define NOTIFIER_DELTA_VERSION     1
+#define NOTIFIER_TRAILER_SIZE      4
+#define NOTIFIER_DELTA_HEADER      8
+#define NOTIFIER_KEYFRAME_INTERVAL 5000 // ms
+#define NOTIFIER_RUN_GAP           3    // unchanged bytes within a run that cost less than a new run header
+#ifdef ESP8266
+#define NOTIFIER_RX_SENDERS        2    // senders whose keyframe is kept (others wait for their next keyframe)
+#else
+#define NOTIFIER_RX_SENDERS        4
+#endif
+
+static byte    *notifierTxKey = nullptr;   // last keyframe sent
+static uint16_t notifierTxSeq = 0;
+static uint16_t notifierTxKeySeq = 0;
+static unsigned long notifierTxKeyTime = 0;
+static bool     notifierTxDeltaPending = false; // deltas were sent since last keyframe
+
+// reference state of a sender: deltas are applied to the last keyframe received from the same sender
+struct NotifierRxRef {
+  IPAddress ip;
+  byte     *key = nullptr;                 // last keyframe received (WLEDPACKETSIZE), nullptr if slot is unused
+  uint16_t  keySeq = 0;
+  uint16_t  seq = 0;
+  unsigned long time = 0;                  // last keyframe or delta, least recently used slot is reused
+};
+static NotifierRxRef notifierRxRefs[NOTIFIER_RX_SENDERS];
+
+static byte    *notifierRxCur = nullptr;   // packet reconstructed from last keyframe/delta that was applied
+static byte    *notifierRxNext = nullptr;  // followed by next state (2 * WLEDPACKETSIZE)
+static IPAddress notifierRxIP;             // sender of current state
+static bool     notifierRxValid = false;
+
+// statistics
+static uint32_t notifierKeyframesSent = 0;
+static uint32_t notifierDeltasSent = 0;
+static uint32_t notifierKeyframesReceived = 0;
+static uint32_t notifierDeltasReceived = 0;
+static uint32_t notifierDeltasLost = 0;    // sequence gaps
+static uint32_t notifierDeltasStale = 0;   // deltas without matching keyframe
+
+// encodes bytes of packet differing from key as runs, returns encoded length or -1 if it exceeds maxLen
+static int encodeNotifierDelta(const byte *packet, const byte *key, size_t len, byte *out, size_t maxLen)
 {
-  if (!udpConnected) return;
-  if (!syncGroups) return;
-  switch (callMode)
-  {
-    case CALL_MODE_INIT:          return;
-    case CALL_MODE_DIRECT_CHANGE: if (!notifyDirect) return; break;
-    case CALL_MODE_BUTTON:        if (!notifyButton) return; break;
-    case CALL_MODE_BUTTON_PRESET: if (!notifyButton) return; break;
-    case CALL_MODE_NIGHTLIGHT:    if (!notifyDirect) return; break;
-    case CALL_MODE_HUE:           if (!notifyHue)    return; break;
-    case CALL_MODE_PRESET_CYCLE:  if (!notifyDirect) return; break;
-    case CALL_MODE_ALEXA:         if (!notifyAlexa)  return; break;
-    default: return;
+  size_t n = 0, i = 0;
+  while (i < len) {
+    if (packet[i] == key[i]) { i++; continue; }
+    size_t start = i, end = i + 1; // run is [start, end)
+    while (end < len) {
+      size_t next = end;
+      while (next < len && next - end < NOTIFIER_RUN_GAP && packet[next] == key[next]) next++; // skip short unchanged gap
+      if (next >= len || next - end >= NOTIFIER_RUN_GAP || next - start >= 255) break;
+      end = next + 1;
+    }
+    if (n + 3 + (end - start) > maxLen) return -1;
+    out[n++] = start >> 8;
+    out[n++] = start & 0xFF;
+    out[n++] = end - start;
+    memcpy(out + n, packet + start, end - start);
+    n += end - start;
+    i = end;
   }
-  byte udpOut[WLEDPACKETSIZE];
+  return n;
+}
+
+static void buildNotifierPacket(byte *udpOut, byte callMode, bool followUp)
+{
   Segment& mainseg = strip.getMainSegment();
   udpOut[0] = 0; //0: wled notifier protocol 1: WARLS protocol
   udpOut[1] = callMode;
@@ -134,16 +197,83 @@ void notify(byte callMode, bool followUp)
     udpOut[35+ofs] = selseg.stopY & 0xFF;
     ++s;
   }
+  // unused segment slots are sent as well, keep them constant so deltas only contain real changes
+  memset(udpOut + 41 + s*UDP_SEG_SIZE, 0, (MAX_NUM_SEGMENTS - s)*UDP_SEG_SIZE);
 
   //uint16_t offs = SEG_OFFSET;
   //next value to be added has index: udpOut[offs + 0]
+}
+
+// broadcasts notifier packet (udpOut needs room for NOTIFIER_TRAILER_SIZE extra bytes), as delta if enabled
+// retries (followUp) repeat the sequence number of the packet they repeat, so receivers drop them if that arrived
+static void sendNotifierPacket(byte *udpOut, bool keyframe, bool followUp = false)
+{
+  const byte *pkt = udpOut;
+  size_t len = WLEDPACKETSIZE;
+  byte deltaOut[NOTIFIER_DELTA_HEADER + WLEDPACKETSIZE/2];
+
+  if (notifyDelta && !notifierTxKey) notifierTxKey = (byte*)malloc(WLEDPACKETSIZE);
+  if (notifyDelta && notifierTxKey) {
+    if (!followUp) notifierTxSeq++;
+    else if (notifierTxSeq == notifierTxKeySeq) keyframe = true; // repeat lost keyframe as keyframe, a delta would be stale
+    int n = -1;
+    if (!keyframe && notifierKeyframesSent && millis() - notifierTxKeyTime < NOTIFIER_KEYFRAME_INTERVAL) {
+      n = encodeNotifierDelta(udpOut, notifierTxKey, WLEDPACKETSIZE, deltaOut + NOTIFIER_DELTA_HEADER, WLEDPACKETSIZE/2);
+    }
+    if (n < 0) { // keyframe
+      memcpy(notifierTxKey, udpOut, WLEDPACKETSIZE);
+      notifierTxKeySeq  = notifierTxSeq;
+      notifierTxKeyTime = millis();
+      notifierTxDeltaPending = false;
+      udpOut[WLEDPACKETSIZE+0] = NOTIFIER_DELTA_ID;
+      udpOut[WLEDPACKETSIZE+1] = NOTIFIER_DELTA_VERSION;
+      udpOut[WLEDPACKETSIZE+2] = notifierTxSeq >> 8;
+      udpOut[WLEDPACKETSIZE+3] = notifierTxSeq & 0xFF;
+      len += NOTIFIER_TRAILER_SIZE;
+      notifierKeyframesSent++;
+    } else {
+      deltaOut[0] = NOTIFIER_DELTA_ID;
+      deltaOut[1] = NOTIFIER_DELTA_VERSION;
+      deltaOut[2] = syncGroups;
+      deltaOut[3] = notifierTxSeq >> 8;
+      deltaOut[4] = notifierTxSeq & 0xFF;
+      deltaOut[5] = notifierTxKeySeq >> 8;
+      deltaOut[6] = notifierTxKeySeq & 0xFF;
+      deltaOut[7] = udpOut[1]; // call mode
+      pkt = deltaOut;
+      len = NOTIFIER_DELTA_HEADER + n;
+      notifierTxDeltaPending = true;
+      notifierDeltasSent++;
+    }
+  }
 
   IPAddress broadcastIp;
   broadcastIp = ~uint32_t(Network.subnetMask()) | uint32_t(Network.gatewayIP());
 
   notifierUdp.beginPacket(broadcastIp, udpPort);
-  notifierUdp.write(udpOut, WLEDPACKETSIZE);
+  notifierUdp.write(pkt, len);
   notifierUdp.endPacket();
+}
+
+void notify(byte callMode, bool followUp)
+{
+  if (!udpConnected) return;
+  if (!syncGroups) return;
+  switch (callMode)
+  {
+    case CALL_MODE_INIT:          return;
+    case CALL_MODE_DIRECT_CHANGE: if (!notifyDirect) return; break;
+    case CALL_MODE_BUTTON:        if (!notifyButton) return; break;
+    case CALL_MODE_BUTTON_PRESET: if (!notifyButton) return; break;
+    case CALL_MODE_NIGHTLIGHT:    if (!notifyDirect) return; break;
+    case CALL_MODE_HUE:           if (!notifyHue)    return; break;
+    case CALL_MODE_PRESET_CYCLE:  if (!notifyDirect) return; break;
+    case CALL_MODE_ALEXA:         if (!notifyAlexa)  return; break;
+    default: return;
+  }
+  byte udpOut[WLEDPACKETSIZE + NOTIFIER_TRAILER_SIZE];
+  buildNotifierPacket(udpOut, callMode, followUp);
+  sendNotifierPacket(udpOut, false, followUp);
   notificationSentCallMode = callMode;
   notificationSentTime = millis();
   notificationCount = followUp ? notificationCount + 1 : 0;
@@ -193,6 +323,7 @@ void exitRealtime() {
   realtimeTimeout = 0; // cancel realtime mode immediately
   realtimeMode = REALTIME_MODE_INACTIVE; // inform UI immediately
   realtimeIP[0] = 0;
+  releaseRealtimeFrame();
   if (useMainSegmentOnly) { // unfreeze live segment again
     strip.getMainSegment().freeze = false;
   }
@@ -210,6 +341,304 @@ void sendTPM2Ack() {
 }
 
 
+// true if a byte of the notifier packet in [from, to] differs from the previously applied one (chg == nullptr: all changed)
+static inline bool notifierChanged(const uint8_t *chg, size_t from, size_t to)
+{
+  if (!chg) return true;
+  for (size_t i = from; i <= to; i++) if (chg[i>>3] & (1 << (i&7))) return true;
+  return false;
+}
+
+// applies notifier packet, chg is a bit field of changed bytes (nullptr: apply everything)
+static void applyNotification(const byte *udpIn, size_t len, const uint8_t *chg)
+{
+  if (udpIn[1] > 199) return; //do not receive custom versions
+
+  //compatibilityVersionByte:
+  byte version = udpIn[11];
+
+  // if we are not part of any sync group ignore message
+  if (version < 9 || version > 199) {
+    // legacy senders are treated as if sending in sync group 1 only
+    if (!(receiveGroups & 0x01)) return;
+  } else if (!(receiveGroups & udpIn[36])) return;
+
+  bool someSel = (receiveNotificationBrightness || receiveNotificationColor || receiveNotificationEffects);
+  // anything changed apart from follow up flag and time (which is always applied)
+  bool anyChanged = notifierChanged(chg, 1, 23) || notifierChanged(chg, 36, len-1);
+
+  // set transition time before making any segment changes
+  if (version > 3 && anyChanged) {
+    if (fadeTransition) {
+      jsonTransitionOnce = true;
+      strip.setTransition(((udpIn[17] << 0) & 0xFF) + ((udpIn[18] << 8) & 0xFF00));
+    }
+  }
+
+  //apply colors from notification to main segment, only if not syncing full segments
+  bool colorChanged = notifierChanged(chg, 3, 5) || notifierChanged(chg, 10, 10) || notifierChanged(chg, 12, 15) || notifierChanged(chg, 20, 23) || notifierChanged(chg, 37, 38);
+  if ((receiveNotificationColor || !someSel) && (version < 11 || !receiveSegmentOptions) && colorChanged) {
+    // primary color, only apply white if intended (version > 0)
+    strip.setColor(0, RGBW32(udpIn[3], udpIn[4], udpIn[5], (version > 0) ? udpIn[10] : 0));
+    if (version > 1) {
+      strip.setColor(1, RGBW32(udpIn[12], udpIn[13], udpIn[14], udpIn[15])); // secondary color
+    }
+    if (version > 6) {
+      strip.setColor(2, RGBW32(udpIn[20], udpIn[21], udpIn[22], udpIn[23])); // tertiary color
+      if (version > 9 && version < 200 && udpIn[37] < 255) { // valid CCT/Kelvin value
+        uint16_t cct = udpIn[38];
+        if (udpIn[37] > 0) { //Kelvin
+          cct |= (udpIn[37] << 8);
+        }
+        strip.setCCT(cct);
+      }
+    }
+  }
+
+  bool timebaseUpdated = false;
+  //apply effects from notification
+  bool applyEffects = (receiveNotificationEffects || !someSel);
+  bool effectChanged = notifierChanged(chg, 8, 9) || notifierChanged(chg, 16, 16) || notifierChanged(chg, 19, 19);
+  if (version < 200)
+  {
+    if (applyEffects && currentPlaylist >= 0 && (effectChanged || notifierChanged(chg, 39, len-1))) unloadPlaylist();
+    if (version > 10 && (receiveSegmentOptions || receiveSegmentBounds)) {
+      uint8_t numSrcSegs = udpIn[39];
+      for (size_t i = 0; i < numSrcSegs; i++) {
+        uint16_t ofs = 41 + i*udpIn[40]; //start of segment offset byte
+        if (!udpIn[40] || ofs + udpIn[40] > len) break;
+        if (!notifierChanged(chg, ofs, ofs + udpIn[40] - 1)) continue; //segment did not change
+        uint8_t id = udpIn[0 +ofs];
+        if (id > strip.getSegmentsNum()) break;
+
+        Segment& selseg = strip.getSegment(id);
+        if (!selseg.isActive() || !selseg.isSelected()) continue; //do not apply to non selected segments
+
+        uint16_t startY = 0, start  = (udpIn[1+ofs] << 8 | udpIn[2+ofs]);
+        uint16_t stopY  = 1, stop   = (udpIn[3+ofs] << 8 | udpIn[4+ofs]);
+        uint16_t offset = (udpIn[7+ofs] << 8 | udpIn[8+ofs]);
+        if (!receiveSegmentOptions) {
+          selseg.setUp(start, stop, selseg.grouping, selseg.spacing, offset, startY, stopY);
+          continue;
+        }
+        //for (size_t j = 1; j<4; j++) selseg.setOption(j, (udpIn[9 +ofs] >> j) & 0x01); //only take into account mirrored, on, reversed; ignore selected
+        selseg.options = (selseg.options & 0x0071U) | (udpIn[9 +ofs] & 0x0E); // ignore selected, freeze, reset & transitional
+        selseg.setOpacity(udpIn[10+ofs]);
+        if (applyEffects) {
+          strip.setMode(id,  udpIn[11+ofs]);
+          selseg.speed     = udpIn[12+ofs];
+          selseg.intensity = udpIn[13+ofs];
+          selseg.palette   = udpIn[14+ofs];
+        }
+        if (receiveNotificationColor || !someSel) {
+          selseg.setColor(0, RGBW32(udpIn[15+ofs],udpIn[16+ofs],udpIn[17+ofs],udpIn[18+ofs]));
+          selseg.setColor(1, RGBW32(udpIn[19+ofs],udpIn[20+ofs],udpIn[21+ofs],udpIn[22+ofs]));
+          selseg.setColor(2, RGBW32(udpIn[23+ofs],udpIn[24+ofs],udpIn[25+ofs],udpIn[26+ofs]));
+          selseg.setCCT(udpIn[27+ofs]);
+        }
+        if (version > 11) {
+          // when applying synced options ignore selected as it may be used as indicator of which segments to sync
+          // freeze, reset should never be synced
+          // LSB to MSB: select, reverse, on, mirror, freeze, reset, reverse_y, mirror_y, transpose, map1d2d (3), ssim (2), set (2)
+          selseg.options = (selseg.options & 0b0000000000110001U) | (udpIn[28+ofs]<<8) | (udpIn[9 +ofs] & 0b11001110U); // ignore selected, freeze, reset
+          if (applyEffects) {
+            selseg.custom1 = udpIn[29+ofs];
+            selseg.custom2 = udpIn[30+ofs];
+            selseg.custom3 = udpIn[31+ofs] & 0x1F;
+            selseg.check1  = (udpIn[31+ofs]>>5) & 0x1;
+            selseg.check1  = (udpIn[31+ofs]>>6) & 0x1;
+            selseg.check1  = (udpIn[31+ofs]>>7) & 0x1;
+          }
+          startY = (udpIn[32+ofs] << 8 | udpIn[33+ofs]);
+          stopY  = (udpIn[34+ofs] << 8 | udpIn[35+ofs]);
+        }
+        if (receiveSegmentBounds) {
+          selseg.setUp(start, stop, udpIn[5+ofs], udpIn[6+ofs], offset, startY, stopY);
+        } else {
+          selseg.setUp(selseg.start, selseg.stop, udpIn[5+ofs], udpIn[6+ofs], selseg.offset, selseg.startY, selseg.stopY);
+        }
+      }
+      stateChanged = true;
+    }
+
+    // simple effect sync, applies to all selected segments
+    if (applyEffects && (version < 11 || !receiveSegmentOptions) && effectChanged) {
+      for (size_t i = 0; i < strip.getSegmentsNum(); i++) {
+        Segment& seg = strip.getSegment(i);
+        if (!seg.isActive() || !seg.isSelected()) continue;
+        seg.setMode(udpIn[8]);
+        seg.speed = udpIn[9];
+        if (version > 2) seg.intensity = udpIn[16];
+        if (version > 4) seg.setPalette(udpIn[19]);
+      }
+      stateChanged = true;
+    }
+
+    if (applyEffects && version > 5) {
+      uint32_t t = (udpIn[25] << 24) | (udpIn[26] << 16) | (udpIn[27] << 8) | (udpIn[28]);
+      t += PRESUMED_NETWORK_DELAY; //adjust trivially for network delay
+      t -= millis();
+      strip.timebase = t;
+      timebaseUpdated = true;
+    }
+  }
+
+  //adjust system time, but only if sender is more accurate than self
+  if (version > 7 && version < 200)
+  {
+    Toki::Time tm;
+    tm.sec = (udpIn[30] << 24) | (udpIn[31] << 16) | (udpIn[32] << 8) | (udpIn[33]);
+    tm.ms = (udpIn[34] << 8) | (udpIn[35]);
+    if (udpIn[29] > toki.getTimeSource()) { //if sender's time source is more accurate
+      toki.adjust(tm, PRESUMED_NETWORK_DELAY); //adjust trivially for network delay
+      uint8_t ts = TOKI_TS_UDP;
+      if (udpIn[29] > 99) ts = TOKI_TS_UDP_NTP;
+      else if (udpIn[29] >= TOKI_TS_SEC) ts = TOKI_TS_UDP_SEC;
+      toki.setTime(tm, ts);
+    } else if (timebaseUpdated && toki.getTimeSource() > 99) { //if we both have good times, get a more accurate timebase
+      Toki::Time myTime = toki.getTime();
+      uint32_t diff = toki.msDifference(tm, myTime);
+      strip.timebase -= PRESUMED_NETWORK_DELAY; //no need to presume, use difference between NTP times at send and receive points
+      if (toki.isLater(tm, myTime)) {
+        strip.timebase += diff;
+      } else {
+        strip.timebase -= diff;
+      }
+    }
+  }
+
+  if (!anyChanged) return;
+
+  nightlightActive = udpIn[6];
+  if (nightlightActive) nightlightDelayMins = udpIn[7];
+
+  if (receiveNotificationBrightness || !someSel) bri = udpIn[2];
+  stateUpdated(CALL_MODE_NOTIFICATION);
+}
+
+// marks bytes differing between a and b in chg bit field, returns false if packets are equal
+static bool notifierDiff(const byte *a, const byte *b, size_t len, uint8_t *chg)
+{
+  bool diff = false;
+  memset(chg, 0, (len+7)/8);
+  for (size_t i = 0; i < len; i++) {
+    if (a[i] == b[i]) continue;
+    chg[i>>3] |= 1 << (i&7);
+    diff = true;
+  }
+  return diff;
+}
+
+static NotifierRxRef *findNotifierRef(IPAddress sender)
+{
+  for (auto &ref : notifierRxRefs) if (ref.key && ref.ip == sender) return &ref;
+  return nullptr;
+}
+
+// returns reference slot for keyframe of sender (its own, a free or the least recently used one)
+static NotifierRxRef *allocNotifierRef(IPAddress sender)
+{
+  if (!notifierRxCur) {
+    notifierRxCur = (byte*)malloc(2 * WLEDPACKETSIZE);
+    if (!notifierRxCur) return nullptr;
+    notifierRxNext = notifierRxCur + WLEDPACKETSIZE;
+  }
+  NotifierRxRef *ref = findNotifierRef(sender);
+  if (!ref) {
+    ref = &notifierRxRefs[0];
+    for (auto &r : notifierRxRefs) {
+      if (!r.key) { ref = &r; break; }
+      if (millis() - r.time > millis() - ref->time) ref = &r;
+    }
+    if (!ref->key) ref->key = (byte*)malloc(WLEDPACKETSIZE);
+    if (!ref->key) return nullptr;
+    ref->ip = sender;
+  }
+  return ref;
+}
+
+// applies next state, only parts that differ from current state if that came from the same sender
+static void applyNotifierNext(IPAddress sender)
+{
+  uint8_t chg[(WLEDPACKETSIZE+7)/8];
+  if (notifierRxValid && sender == notifierRxIP) {
+    notifierDiff(notifierRxNext, notifierRxCur, WLEDPACKETSIZE, chg);
+    applyNotification(notifierRxNext, WLEDPACKETSIZE, chg);
+  } else {
+    applyNotification(notifierRxNext, WLEDPACKETSIZE, nullptr);
+  }
+  std::swap(notifierRxCur, notifierRxNext);
+  notifierRxIP = sender;
+  notifierRxValid = true;
+}
+
+// full notifier packet, keyframe of delta protocol if it has a sequence trailer
+static void receiveNotifierKeyframe(const byte *udpIn, size_t len, IPAddress sender)
+{
+  // legacy packets consist of 41 bytes and a multiple of UDP_SEG_SIZE, keyframe has a trailer
+  bool isKeyframe = len > 41 + NOTIFIER_TRAILER_SIZE && (len - 41) % UDP_SEG_SIZE == NOTIFIER_TRAILER_SIZE
+                    && udpIn[len-4] == NOTIFIER_DELTA_ID && udpIn[len-3] == NOTIFIER_DELTA_VERSION;
+  NotifierRxRef *ref = isKeyframe ? allocNotifierRef(sender) : nullptr;
+  if (!ref) {
+    notifierRxValid = false; // next delta must not be applied as difference to this state
+    applyNotification(udpIn, len, nullptr);
+    return;
+  }
+  uint16_t seq = (udpIn[len-2] << 8) | udpIn[len-1];
+  len -= NOTIFIER_TRAILER_SIZE;
+  if (len > WLEDPACKETSIZE) len = WLEDPACKETSIZE; // sender supports more segments than we do
+  memset(notifierRxNext, 0, WLEDPACKETSIZE);
+  memcpy(notifierRxNext, udpIn, len);
+  if (notifierRxNext[39] > (len - 41) / UDP_SEG_SIZE) notifierRxNext[39] = (len - 41) / UDP_SEG_SIZE;
+  memcpy(ref->key, notifierRxNext, WLEDPACKETSIZE);
+  ref->keySeq = ref->seq = seq;
+  ref->time = millis();
+  notifierKeyframesReceived++;
+  applyNotifierNext(sender);
+}
+
+static void receiveNotifierDelta(const byte *udpIn, size_t len, IPAddress sender)
+{
+  if (len < NOTIFIER_DELTA_HEADER || udpIn[1] != NOTIFIER_DELTA_VERSION) return;
+  if (udpIn[7] > 199 || !(receiveGroups & udpIn[2])) return;
+  uint16_t seq    = (udpIn[3] << 8) | udpIn[4];
+  uint16_t keySeq = (udpIn[5] << 8) | udpIn[6];
+  NotifierRxRef *ref = findNotifierRef(sender);
+  if (!ref || keySeq != ref->keySeq) {
+    notifierDeltasStale++; // wait for next keyframe
+    return;
+  }
+  int16_t d = seq - ref->seq;
+  if (d <= 0) return; // repeated (udpNumRetries) or out of order, deltas are cumulative so newer one was applied already
+  notifierDeltasLost += d - 1;
+  ref->seq = seq;
+  ref->time = millis();
+  notifierDeltasReceived++;
+
+  memcpy(notifierRxNext, ref->key, WLEDPACKETSIZE);
+  for (size_t i = NOTIFIER_DELTA_HEADER; i + 3 <= len; ) {
+    uint16_t ofs = (udpIn[i] << 8) | udpIn[i+1];
+    uint8_t  n   = udpIn[i+2];
+    i += 3;
+    if (i + n > len) break;
+    if (ofs + n <= WLEDPACKETSIZE) memcpy(notifierRxNext + ofs, udpIn + i, n); // runs beyond our max. segments are ignored
+    i += n;
+  }
+  if (notifierRxNext[39] > MAX_NUM_SEGMENTS) notifierRxNext[39] = MAX_NUM_SEGMENTS;
+  applyNotifierNext(sender);
+}
+
+void serializeNotifierInfo(JsonObject root)
+{
+  JsonObject nd = root.createNestedObject(F("nd"));
+  nd[F("txk")]   = notifierKeyframesSent;
+  nd[F("tx")]    = notifierDeltasSent;
+  nd[F("rxk")]   = notifierKeyframesReceived;
+  nd[F("rx")]    = notifierDeltasReceived;
+  nd[F("lost")]  = notifierDeltasLost;
+  nd[F("stale")] = notifierDeltasStale;
+}
+
 void handleNotifications()
 {
   IPAddress localIP;
@@ -218,7 +647,15 @@ void handleNotifications()
   if(udpConnected && (notificationCount < udpNumRetries) && ((millis()-notificationSentTime) > 250)){
     notify(notificationSentCallMode,true);
   }
+  //refresh receivers with a keyframe after deltas were sent, repairs state of nodes that lost the last delta
+  if (udpConnected && notifyDelta && syncGroups && notifierTxDeltaPending && millis() - notifierTxKeyTime > NOTIFIER_KEYFRAME_INTERVAL) {
+    byte udpOut[WLEDPACKETSIZE + NOTIFIER_TRAILER_SIZE];
+    buildNotifierPacket(udpOut, notificationSentCallMode, true);
+    sendNotifierPacket(udpOut, true);
+  }
 
+  handleRealtimeFrame(); // assembled E1.31/Art-Net/DDP frames
+  handleFrameSync();
   if (e131NewData && millis() - strip.getLastShow() > 15)
   {
     e131NewData = false;
@@ -233,6 +670,7 @@ void handleNotifications()
 
   bool isSupp = false;
   size_t packetSize = notifierUdp.parsePacket();
+  uint64_t rxUs = packetSize ? frameSyncMicros() : 0; // time stamp for frame sync, as close to reception as possible
   if (!packetSize && udp2Connected) {
     packetSize = notifier2Udp.parsePacket();
     isSupp = true;
@@ -250,19 +688,13 @@ void handleNotifications()
       rgbUdp.read(lbuf, packetSize);
       realtimeLock(realtimeTimeoutMs, REALTIME_MODE_HYPERION);
       if (realtimeOverride && !(realtimeMode && useMainSegmentOnly)) return;
-      uint16_t id = 0;
-      uint16_t totalLen = strip.getLengthTotal();
-      for (size_t i = 0; i < packetSize -2; i += 3)
-      {
-        setRealtimePixel(id, lbuf[i], lbuf[i+1], lbuf[i+2], 0);
-        id++; if (id >= totalLen) break;
-      }
+      setRealtimePixels(0, lbuf, packetSize/3, 3);
       if (!(realtimeMode && useMainSegmentOnly)) strip.show();
       return;
     }
   }
 
-  if (!(receiveNotifications || receiveDirect)) return;
+  if (!(receiveNotifications || receiveDirect || frameSyncMode)) return;
 
   localIP = Network.localIP();
   //notifier and UDP realtime
@@ -305,165 +737,20 @@ void handleNotifications()
     return;
   }
 
+  if (udpIn[0] == FRAME_SYNC_ID && !isSupp) {
+    handleFrameSyncPacket(udpIn, len, notifierUdp.remoteIP(), rxUs);
+    return;
+  }
+  if (!(receiveNotifications || receiveDirect)) return;
+
   //wled notifier, ignore if realtime packets active
-  if (udpIn[0] == 0 && !realtimeMode && receiveNotifications)
+  if ((udpIn[0] == 0 || udpIn[0] == NOTIFIER_DELTA_ID) && !realtimeMode && receiveNotifications)
   {
     //ignore notification if received within a second after sending a notification ourselves
     if (millis() - notificationSentTime < 1000) return;
-    if (udpIn[1] > 199) return; //do not receive custom versions
-
-    //compatibilityVersionByte:
-    byte version = udpIn[11];
-
-    // if we are not part of any sync group ignore message
-    if (version < 9 || version > 199) {
-      // legacy senders are treated as if sending in sync group 1 only
-      if (!(receiveGroups & 0x01)) return;
-    } else if (!(receiveGroups & udpIn[36])) return;
-
-    bool someSel = (receiveNotificationBrightness || receiveNotificationColor || receiveNotificationEffects);
-
-    // set transition time before making any segment changes
-    if (version > 3) {
-      if (fadeTransition) {
-        jsonTransitionOnce = true;
-        strip.setTransition(((udpIn[17] << 0) & 0xFF) + ((udpIn[18] << 8) & 0xFF00));
-      }
-    }
-
-    //apply colors from notification to main segment, only if not syncing full segments
-    if ((receiveNotificationColor || !someSel) && (version < 11 || !receiveSegmentOptions)) {
-      // primary color, only apply white if intended (version > 0)
-      strip.setColor(0, RGBW32(udpIn[3], udpIn[4], udpIn[5], (version > 0) ? udpIn[10] : 0));
-      if (version > 1) {
-        strip.setColor(1, RGBW32(udpIn[12], udpIn[13], udpIn[14], udpIn[15])); // secondary color
-      }
-      if (version > 6) {
-        strip.setColor(2, RGBW32(udpIn[20], udpIn[21], udpIn[22], udpIn[23])); // tertiary color
-        if (version > 9 && version < 200 && udpIn[37] < 255) { // valid CCT/Kelvin value
-          uint16_t cct = udpIn[38];
-          if (udpIn[37] > 0) { //Kelvin
-            cct |= (udpIn[37] << 8);
-          }
-          strip.setCCT(cct);
-        }
-      }
-    }
-
-    bool timebaseUpdated = false;
-    //apply effects from notification
-    bool applyEffects = (receiveNotificationEffects || !someSel);
-    if (version < 200)
-    {
-      if (applyEffects && currentPlaylist >= 0) unloadPlaylist();
-      if (version > 10 && (receiveSegmentOptions || receiveSegmentBounds)) {
-        uint8_t numSrcSegs = udpIn[39];
-        for (size_t i = 0; i < numSrcSegs; i++) {
-          uint16_t ofs = 41 + i*udpIn[40]; //start of segment offset byte
-          uint8_t id = udpIn[0 +ofs];
-          if (id > strip.getSegmentsNum()) break;
-
-          Segment& selseg = strip.getSegment(id);
-          if (!selseg.isActive() || !selseg.isSelected()) continue; //do not apply to non selected segments
-
-          uint16_t startY = 0, start  = (udpIn[1+ofs] << 8 | udpIn[2+ofs]);
-          uint16_t stopY  = 1, stop   = (udpIn[3+ofs] << 8 | udpIn[4+ofs]);
-          uint16_t offset = (udpIn[7+ofs] << 8 | udpIn[8+ofs]);
-          if (!receiveSegmentOptions) {
-            selseg.setUp(start, stop, selseg.grouping, selseg.spacing, offset, startY, stopY);
-            continue;
-          }
-          //for (size_t j = 1; j<4; j++) selseg.setOption(j, (udpIn[9 +ofs] >> j) & 0x01); //only take into account mirrored, on, reversed; ignore selected
-          selseg.options = (selseg.options & 0x0071U) | (udpIn[9 +ofs] & 0x0E); // ignore selected, freeze, reset & transitional
-          selseg.setOpacity(udpIn[10+ofs]);
-          if (applyEffects) {
-            strip.setMode(id,  udpIn[11+ofs]);
-            selseg.speed     = udpIn[12+ofs];
-            selseg.intensity = udpIn[13+ofs];
-            selseg.palette   = udpIn[14+ofs];
-          }
-          if (receiveNotificationColor || !someSel) {
-            selseg.setColor(0, RGBW32(udpIn[15+ofs],udpIn[16+ofs],udpIn[17+ofs],udpIn[18+ofs]));
-            selseg.setColor(1, RGBW32(udpIn[19+ofs],udpIn[20+ofs],udpIn[21+ofs],udpIn[22+ofs]));
-            selseg.setColor(2, RGBW32(udpIn[23+ofs],udpIn[24+ofs],udpIn[25+ofs],udpIn[26+ofs]));
-            selseg.setCCT(udpIn[27+ofs]);
-          }
-          if (version > 11) {
-            // when applying synced options ignore selected as it may be used as indicator of which segments to sync
-            // freeze, reset should never be synced
-            // LSB to MSB: select, reverse, on, mirror, freeze, reset, reverse_y, mirror_y, transpose, map1d2d (3), ssim (2), set (2)
-            selseg.options = (selseg.options & 0b0000000000110001U) | (udpIn[28+ofs]<<8) | (udpIn[9 +ofs] & 0b11001110U); // ignore selected, freeze, reset
-            if (applyEffects) {
-              selseg.custom1 = udpIn[29+ofs];
-              selseg.custom2 = udpIn[30+ofs];
-              selseg.custom3 = udpIn[31+ofs] & 0x1F;
-              selseg.check1  = (udpIn[31+ofs]>>5) & 0x1;
-              selseg.check1  = (udpIn[31+ofs]>>6) & 0x1;
-              selseg.check1  = (udpIn[31+ofs]>>7) & 0x1;
-            }
-            startY = (udpIn[32+ofs] << 8 | udpIn[33+ofs]);
-            stopY  = (udpIn[34+ofs] << 8 | udpIn[35+ofs]);
-          }
-          if (receiveSegmentBounds) {
-            selseg.setUp(start, stop, udpIn[5+ofs], udpIn[6+ofs], offset, startY, stopY);
-          } else {
-            selseg.setUp(selseg.start, selseg.stop, udpIn[5+ofs], udpIn[6+ofs], selseg.offset, selseg.startY, selseg.stopY);
-          }
-        }
-        stateChanged = true;
-      }
-
-      // simple effect sync, applies to all selected segments
-      if (applyEffects && (version < 11 || !receiveSegmentOptions)) {
-        for (size_t i = 0; i < strip.getSegmentsNum(); i++) {
-          Segment& seg = strip.getSegment(i);
-          if (!seg.isActive() || !seg.isSelected()) continue;
-          seg.setMode(udpIn[8]);
-          seg.speed = udpIn[9];
-          if (version > 2) seg.intensity = udpIn[16];
-          if (version > 4) seg.setPalette(udpIn[19]);
-        }
-        stateChanged = true;
-      }
-
-      if (applyEffects && version > 5) {
-        uint32_t t = (udpIn[25] << 24) | (udpIn[26] << 16) | (udpIn[27] << 8) | (udpIn[28]);
-        t += PRESUMED_NETWORK_DELAY; //adjust trivially for network delay
-        t -= millis();
-        strip.timebase = t;
-        timebaseUpdated = true;
-      }
-    }
-
-    //adjust system time, but only if sender is more accurate than self
-    if (version > 7 && version < 200)
-    {
-      Toki::Time tm;
-      tm.sec = (udpIn[30] << 24) | (udpIn[31] << 16) | (udpIn[32] << 8) | (udpIn[33]);
-      tm.ms = (udpIn[34] << 8) | (udpIn[35]);
-      if (udpIn[29] > toki.getTimeSource()) { //if sender's time source is more accurate
-        toki.adjust(tm, PRESUMED_NETWORK_DELAY); //adjust trivially for network delay
-        uint8_t ts = TOKI_TS_UDP;
-        if (udpIn[29] > 99) ts = TOKI_TS_UDP_NTP;
-        else if (udpIn[29] >= TOKI_TS_SEC) ts = TOKI_TS_UDP_SEC;
-        toki.setTime(tm, ts);
-      } else if (timebaseUpdated && toki.getTimeSource() > 99) { //if we both have good times, get a more accurate timebase
-        Toki::Time myTime = toki.getTime();
-        uint32_t diff = toki.msDifference(tm, myTime);
-        strip.timebase -= PRESUMED_NETWORK_DELAY; //no need to presume, use difference between NTP times at send and receive points
-        if (toki.isLater(tm, myTime)) {
-          strip.timebase += diff;
-        } else {
-          strip.timebase -= diff;
-        }
-      }
-    }
-
-    nightlightActive = udpIn[6];
-    if (nightlightActive) nightlightDelayMins = udpIn[7];
-
-    if (receiveNotificationBrightness || !someSel) bri = udpIn[2];
-    stateUpdated(CALL_MODE_NOTIFICATION);
+    IPAddress sender = isSupp ? notifier2Udp.remoteIP() : notifierUdp.remoteIP();
+    if (udpIn[0] == 0) receiveNotifierKeyframe(udpIn, len, sender);
+    else               receiveNotifierDelta(udpIn, len, sender);
     return;
   }
 
@@ -490,16 +777,10 @@ void handleNotifications()
     byte numPackets = udpIn[5];
 
     uint16_t id = (tpmPayloadFrameSize/3)*(packetNum-1); //start LED
-    uint16_t totalLen = strip.getLengthTotal();
-    for (size_t i = 6; i < tpmPayloadFrameSize + 4U; i += 3)
-    {
-      if (id < totalLen)
-      {
-        setRealtimePixel(id, udpIn[i], udpIn[i+1], udpIn[i+2], 0);
-        id++;
-      }
-      else break;
-    }
+    uint16_t count = tpmPayloadFrameSize/3;
+    if (packetSize < 6) count = 0;
+    else if (count > (packetSize-6)/3) count = (packetSize-6)/3; // do not read beyond received data
+    setRealtimePixels(id, udpIn+6, count, 3);
     if (tpmPacketCount == numPackets) //reset packet count and show if all packets were received
     {
       tpmPacketCount = 0;
@@ -524,7 +805,6 @@ void handleNotifications()
     }
     if (realtimeOverride && !(realtimeMode && useMainSegmentOnly)) return;
 
-    uint16_t totalLen = strip.getLengthTotal();
     if ((udpIn[0] == 1) && (packetSize > 5)) //warls - avoiding infinite "for" loop (unsigned underflow)    
     {
       for (size_t i = 2; i < packetSize -3; i += 4)
@@ -533,40 +813,18 @@ void handleNotifications()
       }
     } else if (udpIn[0] == 2) //drgb
     {
-      uint16_t id = 0;
-      for (size_t i = 2; i < packetSize -2; i += 3)
-      {
-        setRealtimePixel(id, udpIn[i], udpIn[i+1], udpIn[i+2], 0);
-
-        id++; if (id >= totalLen) break;
-      }
-    } else if ((udpIn[0] == 3) && (packetSize > 5)) //drgbw - avoiding infinite "for" loop (unsigned underflow)
+      setRealtimePixels(0, udpIn+2, (packetSize-2)/3, 3);
+    } else if (udpIn[0] == 3) //drgbw
     {
-      uint16_t id = 0;
-      for (size_t i = 2; i < packetSize -3; i += 4)
-      {
-        setRealtimePixel(id, udpIn[i], udpIn[i+1], udpIn[i+2], udpIn[i+3]);
-
-        id++; if (id >= totalLen) break;
-      }
-    } else if (udpIn[0] == 4) //dnrgb
+      setRealtimePixels(0, udpIn+2, (packetSize-2)/4, 4);
+    } else if ((udpIn[0] == 4) && (packetSize > 4)) //dnrgb
     {
       uint16_t id = ((udpIn[3] << 0) & 0xFF) + ((udpIn[2] << 8) & 0xFF00);
-      for (size_t i = 4; i < packetSize -2; i += 3)
-      {
-        if (id >= totalLen) break;
-        setRealtimePixel(id, udpIn[i], udpIn[i+1], udpIn[i+2], 0);
-        id++;
-      }
-    } else if (udpIn[0] == 5) //dnrgbw
+      setRealtimePixels(id, udpIn+4, (packetSize-4)/3, 3);
+    } else if ((udpIn[0] == 5) && (packetSize > 4)) //dnrgbw
     {
       uint16_t id = ((udpIn[3] << 0) & 0xFF) + ((udpIn[2] << 8) & 0xFF00);
-      for (size_t i = 4; i < packetSize -2; i += 4)
-      {
-        if (id >= totalLen) break;
-        setRealtimePixel(id, udpIn[i], udpIn[i+1], udpIn[i+2], udpIn[i+3]);
-        id++;
-      }
+      setRealtimePixels(id, udpIn+4, (packetSize-4)/4, 4);
     }
     strip.show();
     return;
@@ -609,6 +867,79 @@ void setRealtimePixel(uint16_t i, byte r, byte g, byte b, byte w)
   }
 }
 
+#define REALTIME_SPAN_LEN 64 // pixels converted at once (on stack)
+
+// applies realtime offset to first pixel and clips span to strip (or main segment) length
+// returns number of leading pixels to skip (before start of strip), count is reduced accordingly
+static uint16_t clipRealtimeSpan(uint16_t i, int &pix, uint16_t &count)
+{
+  uint16_t skip = 0;
+  pix = i + arlsOffset;
+  if (pix < 0) { // pixels shifted before start of strip are dropped
+    skip  = -pix < count ? -pix : count;
+    count -= skip;
+    pix   = 0;
+  }
+  int len = strip.getLengthTotal();
+  if (useMainSegmentOnly && strip.getMainSegment().length() < len) len = strip.getMainSegment().length();
+  if (pix >= len) count = 0;
+  else if (count > len - pix) count = len - pix;
+  return skip;
+}
+
+static void writeRealtimeSpan(int pix, const uint32_t *c, uint16_t count)
+{
+  if (useMainSegmentOnly) {
+    Segment &seg = strip.getMainSegment();
+    for (unsigned j = 0; j < count; j++) seg.setPixelColor(int(pix + j), c[j]);
+  } else {
+    strip.setPixels(pix, c, count);
+  }
+}
+
+// sets count consecutive pixels starting at i from received channel data (channels: 3 = RGB, 4 = RGBW)
+// same result as calling setRealtimePixel() for each pixel, but offset, length and gamma settings are
+// only resolved once and pixels are written to the busses in contiguous spans
+void setRealtimePixels(uint16_t i, const uint8_t *data, uint16_t count, uint8_t channels)
+{
+  int pix;
+  data += clipRealtimeSpan(i, pix, count) * channels;
+  const bool gamma = !arlsDisableGammaCorrection && gammaCorrectCol;
+  uint32_t span[REALTIME_SPAN_LEN];
+
+  while (count) {
+    uint16_t n = count < REALTIME_SPAN_LEN ? count : REALTIME_SPAN_LEN;
+    for (unsigned j = 0; j < n; j++, data += channels) {
+      uint8_t w = channels > 3 ? data[3] : 0;
+      if (gamma) span[j] = RGBW32(gamma8(data[0]), gamma8(data[1]), gamma8(data[2]), gamma8(w));
+      else       span[j] = RGBW32(data[0], data[1], data[2], w);
+    }
+    writeRealtimeSpan(pix, span, n);
+    pix   += n;
+    count -= n;
+  }
+}
+
+// same as above for already assembled 32 bit colors
+void setRealtimePixels(uint16_t i, const uint32_t *c, uint16_t count)
+{
+  int pix;
+  c += clipRealtimeSpan(i, pix, count);
+  if (arlsDisableGammaCorrection || !gammaCorrectCol) {
+    writeRealtimeSpan(pix, c, count);
+    return;
+  }
+  uint32_t span[REALTIME_SPAN_LEN];
+  while (count) {
+    uint16_t n = count < REALTIME_SPAN_LEN ? count : REALTIME_SPAN_LEN;
+    for (unsigned j = 0; j < n; j++) span[j] = gamma32(c[j]);
+    writeRealtimeSpan(pix, span, n);
+    c     += n;
+    pix   += n;
+    count -= n;
+  }
+}
+
 /*********************************************************************************************\
    Refresh aging for remote units, drop if too old...
 \*********************************************************************************************/
@@ -709,147 +1040,164 @@ void sendSysInfoUDP()
 // 1440 channels per packet
 #define DDP_CHANNELS_PER_PACKET 1440 // 480 leds
 
-//
-// Send real time UDP updates to the specified client
-//
-// type   - protocol type (0=DDP, 1=E1.31, 2=ArtNet)
-// client - the IP address to send to
-// length - the number of pixels
-// buffer - a buffer of at least length*4 bytes long
-// isRGBW - true if the buffer contains 4 components per pixel
+// E1.31 header is the fixed part of the packet up to (and including) the DMX start code
+#define E131_HEADER_LEN (E131_DMP_DATA+1)
 
 static       size_t sequenceNumber = 0; // this needs to be shared across all outputs
 static const size_t ART_NET_HEADER_SIZE = 12;
 static const byte   ART_NET_HEADER[] PROGMEM = {0x41,0x72,0x74,0x2d,0x4e,0x65,0x74,0x00,0x00,0x50,0x00,0x0e};
+static const byte   E131_ACN_ID[] PROGMEM = {0x41,0x53,0x43,0x2d,0x45,0x31,0x2e,0x31,0x37,0x00,0x00,0x00}; // "ASC-E1.17"
 
-uint8_t realtimeBroadcast(uint8_t type, IPAddress client, uint16_t length, uint8_t *buffer, uint8_t bri, bool isRGBW)  {
-  if (!(apActive || interfacesInited) || !client[0] || !length) return 1;  // network not initialised or dummy/unset IP address  031522 ajn added check for ap
-
-  WiFiUDP ddpUdp;
+//
+// Layout of prebuilt real time UDP packets (used by BusNetwork)
+// packets are stored back to back in a buffer, each packet occupies
+// realtimeHeaderLen() + realtimeChannelsPerPacket() bytes (last one may use less)
+// header is written once by realtimeInitPackets(), pixel data is written in place
+// after the header (channel values without brightness applied)
+//
+// type   - protocol type (0=DDP, 1=E1.31, 2=ArtNet)
+// length - the number of pixels
+// isRGBW - true if the buffer contains 4 components per pixel
 
+size_t realtimeHeaderLen(uint8_t type) {
   switch (type) {
-    case 0: // DDP
-    {
-      // calculate the number of UDP packets we need to send
-      size_t channelCount = length * (isRGBW? 4:3); // 1 channel for every R,G,B value
-      size_t packetCount = ((channelCount-1) / DDP_CHANNELS_PER_PACKET) +1;
-
-      // there are 3 channels per RGB pixel
-      uint32_t channel = 0; // TODO: allow specifying the start channel
-      // the current position in the buffer
-      size_t bufferOffset = 0;
-
-      for (size_t currentPacket = 0; currentPacket < packetCount; currentPacket++) {
-        if (sequenceNumber > 15) sequenceNumber = 0;
-
-        if (!ddpUdp.beginPacket(client, DDP_DEFAULT_PORT)) {  // port defined in ESPAsyncE131.h
-          DEBUG_PRINTLN(F("WiFiUDP.beginPacket returned an error"));
-          return 1; // problem
-        }
-
-        // the amount of data is AFTER the header in the current packet
-        size_t packetSize = DDP_CHANNELS_PER_PACKET;
-
-        uint8_t flags = DDP_FLAGS1_VER1;
-        if (currentPacket == (packetCount - 1U)) {
-          // last packet, set the push flag
-          // TODO: determine if we want to send an empty push packet to each destination after sending the pixel data
-          flags = DDP_FLAGS1_VER1 | DDP_FLAGS1_PUSH;
-          if (channelCount % DDP_CHANNELS_PER_PACKET) {
-            packetSize = channelCount % DDP_CHANNELS_PER_PACKET;
-          }
-        }
-
-        // write the header
-        /*0*/ddpUdp.write(flags);
-        /*1*/ddpUdp.write(sequenceNumber++ & 0x0F); // sequence may be unnecessary unless we are sending twice (as requested in Sync settings)
-        /*2*/ddpUdp.write(isRGBW ?  DDP_TYPE_RGBW32 : DDP_TYPE_RGB24);
-        /*3*/ddpUdp.write(DDP_ID_DISPLAY);
-        // data offset in bytes, 32-bit number, MSB first
-        /*4*/ddpUdp.write(0xFF & (channel >> 24));
-        /*5*/ddpUdp.write(0xFF & (channel >> 16));
-        /*6*/ddpUdp.write(0xFF & (channel >>  8));
-        /*7*/ddpUdp.write(0xFF & (channel      ));
-        // data length in bytes, 16-bit number, MSB first
-        /*8*/ddpUdp.write(0xFF & (packetSize >> 8));
-        /*9*/ddpUdp.write(0xFF & (packetSize     ));
-
-        // write the colors, the write write(const uint8_t *buffer, size_t size)
-        // function is just a loop internally too
-        for (size_t i = 0; i < packetSize; i += (isRGBW?4:3)) {
-          ddpUdp.write(scale8(buffer[bufferOffset++], bri)); // R
-          ddpUdp.write(scale8(buffer[bufferOffset++], bri)); // G
-          ddpUdp.write(scale8(buffer[bufferOffset++], bri)); // B
-          if (isRGBW) ddpUdp.write(scale8(buffer[bufferOffset++], bri)); // W
-        }
-
-        if (!ddpUdp.endPacket()) {
-          DEBUG_PRINTLN(F("WiFiUDP.endPacket returned an error"));
-          return 1; // problem
-        }
-
-        channel += packetSize;
-      }
-    } break;
-
-    case 1: //E1.31
-    {
-    } break;
-
-    case 2: //ArtNet
-    {
-      // calculate the number of UDP packets we need to send
-      const size_t channelCount = length * (isRGBW?4:3); // 1 channel for every R,G,B,(W?) value
-      const size_t ARTNET_CHANNELS_PER_PACKET = isRGBW?512:510; // 512/4=128 RGBW LEDs, 510/3=170 RGB LEDs
-      const size_t packetCount = ((channelCount-1)/ARTNET_CHANNELS_PER_PACKET)+1;
+    case 1:  return E131_HEADER_LEN;
+    case 2:  return ART_NET_HEADER_SIZE + 6;
+    default: return DDP_HEADER_LEN;
+  }
+}
 
-      uint32_t channel = 0; 
-      size_t bufferOffset = 0;
+size_t realtimeChannelsPerPacket(uint8_t type, bool isRGBW) {
+  if (type == 0) return DDP_CHANNELS_PER_PACKET; // divisible by 3 and 4
+  return isRGBW ? 512 : 510; // 512/4=128 RGBW LEDs, 510/3=170 RGB LEDs
+}
 
-      sequenceNumber++;
+static inline void writeBE16(uint8_t *p, uint16_t v) { p[0] = v >> 8; p[1] = v; }
+
+void realtimeInitPackets(uint8_t type, uint8_t *buffer, uint16_t length, bool isRGBW) {
+  const size_t headerLen    = realtimeHeaderLen(type);
+  const size_t chPerPacket  = realtimeChannelsPerPacket(type, isRGBW);
+  const size_t channelCount = length * (isRGBW?4:3); // 1 channel for every R,G,B,(W?) value
+  const size_t packetCount  = ((channelCount-1) / chPerPacket) + 1;
+
+  for (size_t currentPacket = 0; currentPacket < packetCount; currentPacket++) {
+    uint8_t *p = buffer + currentPacket * (headerLen + chPerPacket);
+    size_t packetSize = chPerPacket; // the amount of data AFTER the header in the current packet
+    if (currentPacket == (packetCount - 1U) && (channelCount % chPerPacket)) packetSize = channelCount % chPerPacket;
+    uint32_t channel = currentPacket * chPerPacket;
+    memset(p, 0, headerLen);
+
+    switch (type) {
+      case 0: // DDP
+        // last packet has the push flag set
+        // TODO: determine if we want to send an empty push packet to each destination after sending the pixel data
+        p[0] = DDP_FLAGS1_VER1 | (currentPacket == (packetCount - 1U) ? DDP_FLAGS1_PUSH : 0);
+        // p[1] is sequence number, set when sending
+        p[2] = isRGBW ? DDP_TYPE_RGBW32 : DDP_TYPE_RGB24;
+        p[3] = DDP_ID_DISPLAY;
+        writeBE16(p+4, channel >> 16); // data offset in bytes, 32-bit number, MSB first
+        writeBE16(p+6, channel);
+        writeBE16(p+8, packetSize);    // data length in bytes, 16-bit number, MSB first
+        break;
+
+      case 1: // E1.31
+      {
+        const size_t packetLen = headerLen + packetSize;
+        writeBE16(p + E131_ROOT_PREAMBLE_SIZE, 0x0010);
+        memcpy_P(p + E131_ROOT_ID, E131_ACN_ID, sizeof(E131_ACN_ID));
+        writeBE16(p + E131_ROOT_FLENGTH, 0x7000 | (packetLen - E131_ROOT_FLENGTH));
+        p[E131_ROOT_VECTOR+3] = 0x04; // VECTOR_ROOT_E131_DATA
+        // CID (unique sender id): "WLED" followed by MAC address
+        memcpy_P(p + E131_ROOT_CID, PSTR("WLED"), 4);
+        for (size_t i = 0; i < 12 && i < escapedMac.length(); i++) p[E131_ROOT_CID + 4 + i] = escapedMac[i];
+        writeBE16(p + E131_FRAME_FLENGTH, 0x7000 | (packetLen - E131_FRAME_FLENGTH));
+        p[E131_FRAME_VECTOR+3] = 0x02; // VECTOR_E131_DATA_PACKET
+        strncpy((char*)p + E131_FRAME_SOURCE, serverDescription, 63);
+        p[E131_FRAME_PRIORITY] = 100;
+        // p[E131_FRAME_SEQ] is sequence number, set when sending
+        writeBE16(p + E131_FRAME_UNIVERSE, currentPacket + 1); // 1 full packet == 1 full universe, E1.31 universes start at 1
+        writeBE16(p + E131_DMP_FLENGTH, 0x7000 | (packetLen - E131_DMP_FLENGTH));
+        p[E131_DMP_VECTOR] = 0x02; // VECTOR_DMP_SET_PROPERTY
+        p[E131_DMP_TYPE]   = 0xA1;
+        writeBE16(p + E131_DMP_ADDR_INC, 1);
+        writeBE16(p + E131_DMP_COUNT, packetSize + 1); // includes DMX start code (0) at E131_DMP_DATA
+      } break;
+
+      case 2: // ArtNet
+        memcpy_P(p, ART_NET_HEADER, ART_NET_HEADER_SIZE); // This doesn't change. Hard coded ID, OpCode, and protocol version.
+        // p[12] is sequence number, set when sending
+        // p[13] physical - more an FYI, not really used for anything. 0..3
+        p[14] = currentPacket & 0xFF; // Universe LSB. 1 full packet == 1 full universe, so just use current packet number.
+        // p[15] Universe MSB, unused.
+        writeBE16(p+16, packetSize); // 16-bit length of channel data, MSB first
+        break;
+    }
+  }
+}
 
-      for (size_t currentPacket = 0; currentPacket < packetCount; currentPacket++) {
+//
+// Send real time UDP updates to the specified client
+//
+// client - the IP address to send to
+// buffer - prebuilt packets (see realtimeInitPackets()) followed by one spare packet
+//          which is used as scratch space when brightness needs to be applied
+// bri    - brightness applied to channel values
+// from, to - range of pixels that changed, only packets containing them are sent
+//
+static WiFiUDP ddpUdp; // reused for all outputs instead of constructing one for every frame
 
-        if (sequenceNumber > 255) sequenceNumber = 0;
+uint8_t realtimeBroadcast(uint8_t type, IPAddress client, uint16_t length, uint8_t *buffer, uint8_t bri, bool isRGBW, uint16_t from, uint16_t to)  {
+  if (!(apActive || interfacesInited) || !client[0] || !length) return 1;  // network not initialised or dummy/unset IP address  031522 ajn added check for ap
 
-        if (!ddpUdp.beginPacket(client, ARTNET_DEFAULT_PORT)) {
-          DEBUG_PRINTLN(F("Art-Net WiFiUDP.beginPacket returned an error"));
-          return 1; // borked
-        }
+  const size_t   headerLen    = realtimeHeaderLen(type);
+  const size_t   chPerPacket  = realtimeChannelsPerPacket(type, isRGBW);
+  const size_t   stride       = headerLen + chPerPacket;
+  const size_t   channelCount = length * (isRGBW?4:3);
+  const size_t   packetCount  = ((channelCount-1) / chPerPacket) + 1;
+  const uint16_t port         = type == 1 ? E131_DEFAULT_PORT : (type == 2 ? ARTNET_DEFAULT_PORT : DDP_DEFAULT_PORT); // ports defined in ESPAsyncE131.h
+  uint8_t       *scratch      = buffer + packetCount * stride;
+  // only packets containing pixels from..to-1 are sent
+  if (to > length) to = length;
+  if (from >= to) return 0;
+  const size_t   firstPacket  = (from * (isRGBW?4:3)) / chPerPacket;
+  const size_t   lastPacket   = ((to * (isRGBW?4:3)) - 1) / chPerPacket;
+
+  if (type != 0) { // Art-Net and E1.31 use one sequence number per frame
+    sequenceNumber++;
+    if (sequenceNumber > 255) sequenceNumber = 1;
+  }
 
-        size_t packetSize = ARTNET_CHANNELS_PER_PACKET;
+  for (size_t currentPacket = firstPacket; currentPacket <= lastPacket; currentPacket++) {
+    uint8_t *p = buffer + currentPacket * stride;
+    size_t packetSize = chPerPacket;
+    if (currentPacket == (packetCount - 1U) && (channelCount % chPerPacket)) packetSize = channelCount % chPerPacket;
 
-        if (currentPacket == (packetCount - 1U)) {
-          // last packet
-          if (channelCount % ARTNET_CHANNELS_PER_PACKET) {
-            packetSize = channelCount % ARTNET_CHANNELS_PER_PACKET;
-          }
-        }
+    switch (type) {
+      case 0: // DDP
+        // last packet sent has the push flag set (receivers display data when they get it)
+        p[0] = DDP_FLAGS1_VER1 | (currentPacket == lastPacket ? DDP_FLAGS1_PUSH : 0);
+        if (sequenceNumber > 15) sequenceNumber = 0;
+        p[1] = sequenceNumber++ & 0x0F; // sequence may be unnecessary unless we are sending twice (as requested in Sync settings)
+        break;
+      case 1: p[E131_FRAME_SEQ] = sequenceNumber; break;
+      case 2: p[12] = sequenceNumber; break; // 1..255
+    }
 
-        byte header_buffer[ART_NET_HEADER_SIZE];
-        memcpy_P(header_buffer, ART_NET_HEADER, ART_NET_HEADER_SIZE);
-        ddpUdp.write(header_buffer, ART_NET_HEADER_SIZE); // This doesn't change. Hard coded ID, OpCode, and protocol version.
-        ddpUdp.write(sequenceNumber & 0xFF); // sequence number. 1..255
-        ddpUdp.write(0x00); // physical - more an FYI, not really used for anything. 0..3
-        ddpUdp.write((currentPacket) & 0xFF); // Universe LSB. 1 full packet == 1 full universe, so just use current packet number.
-        ddpUdp.write(0x00); // Universe MSB, unused.
-        ddpUdp.write(0xFF & (packetSize >> 8)); // 16-bit length of channel data, MSB
-        ddpUdp.write(0xFF & (packetSize     )); // 16-bit length of channel data, LSB
-
-        for (size_t i = 0; i < packetSize; i += (isRGBW?4:3)) {
-          ddpUdp.write(scale8(buffer[bufferOffset++], bri)); // R
-          ddpUdp.write(scale8(buffer[bufferOffset++], bri)); // G
-          ddpUdp.write(scale8(buffer[bufferOffset++], bri)); // B
-          if (isRGBW) ddpUdp.write(scale8(buffer[bufferOffset++], bri)); // W
-        }
+    if (bri < 255) { // apply brightness in spare packet, channel values in buffer must remain unscaled
+      memcpy(scratch, p, headerLen);
+      for (size_t i = 0; i < packetSize; i++) scratch[headerLen + i] = scale8(p[headerLen + i], bri);
+      p = scratch;
+    }
 
-        if (!ddpUdp.endPacket()) {
-          DEBUG_PRINTLN(F("Art-Net WiFiUDP.endPacket returned an error"));
-          return 1; // borked
-        }
-        channel += packetSize;
-      }
-    } break;
+    if (!ddpUdp.beginPacket(client, port)) {
+      DEBUG_PRINTLN(F("WiFiUDP.beginPacket returned an error"));
+      return 1; // problem
+    }
+    ddpUdp.write(p, headerLen + packetSize);
+    if (!ddpUdp.endPacket()) {
+      DEBUG_PRINTLN(F("WiFiUDP.endPacket returned an error"));
+      return 1; // problem
+    }
   }
   return 0;
 }
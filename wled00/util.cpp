@@ -527,13 +527,15 @@ um_data_t* simulateSound(uint8_t simulationId)
 }
 
 
-// enumerate all ledmapX.json files on FS and extract ledmap names if existing
+// enumerate all ledmapX.json (or binary ledmapX.lmb) files on FS and extract ledmap names if existing
 void enumerateLedmaps() {
   ledMaps = 1;
   for (size_t i=1; i<WLED_MAX_LEDMAPS; i++) {
     char fileName[33];
-    sprintf_P(fileName, PSTR("/ledmap%d.json"), i);
-    bool isFile = WLED_FS.exists(fileName);
+    sprintf_P(fileName, PSTR("/ledmap%d.lmb"), i);
+    bool isBinary = WLED_FS.exists(fileName);
+    if (!isBinary) sprintf_P(fileName, PSTR("/ledmap%d.json"), i);
+    bool isFile = isBinary || WLED_FS.exists(fileName);
 
     #ifndef ESP8266
     if (ledmapNames[i-1]) { //clear old name
@@ -546,7 +548,14 @@ void enumerateLedmaps() {
       ledMaps |= 1 << i;
 
       #ifndef ESP8266
-      if (requestJSONBufferLock(21)) {
+      if (isBinary) {
+        char name[33];
+        if (readLedmapFile(fileName, nullptr, nullptr, name)) {
+          if (!name[0]) snprintf_P(name, 32, PSTR("ledmap%d.lmb"), i);
+          ledmapNames[i-1] = new char[strlen(name)+1];
+          if (ledmapNames[i-1]) strcpy(ledmapNames[i-1], name);
+        }
+      } else if (requestJSONBufferLock(21)) {
         if (readObjectFromFile(fileName, nullptr, &doc)) {
           size_t len = 0;
           if (!doc["n"].isNull()) {
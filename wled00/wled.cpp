@@ -90,6 +90,9 @@ void WLED::loop()
     yield();
   }
 
+  handleJsonQueue(); // apply JSON API commands received since last loop()
+  yield();
+
   #ifdef WLED_DEBUG
   stripMillis = millis();
   #endif
@@ -815,9 +818,9 @@ void WLED::handleConnection()
       DEBUG_PRINT(F("Heap too low! "));
       DEBUG_PRINTLN(heap);
       forceReconnect = true;
-      strip.purgeSegments(true); // remove all but one segments from memory
+      strip.purgeSegments(true); // remove all but one segments from memory (also frees pooled transitions)
     } else if (heap < MIN_HEAP_SIZE) {
-      strip.purgeSegments();
+      strip.purgeSegments();     // also frees pooled transitions
     }
     lastHeap = heap;
     heapTime = now;
@@ -338,6 +338,17 @@ WLED_GLOBAL bool useGlobalLedBuffer _INIT(false); // double buffering disabled o
 #else
 WLED_GLOBAL bool useGlobalLedBuffer _INIT(true);  // double buffering enabled on ESP32
 #endif
+#ifdef ESP8266
+WLED_GLOBAL bool useSegmentBuffers  _INIT(false); // per-segment frame buffers disabled on ESP8266 (RAM)
+#else
+WLED_GLOBAL bool useSegmentBuffers  _INIT(true);  // effects render into per-segment frame buffers
+#endif
+WLED_GLOBAL bool multiCoreRender    _INIT(WLED_FX_CORES > 1); // render buffered segments on both cores (dual core ESP32)
+#ifdef ESP8266
+WLED_GLOBAL bool useMappingPlans    _INIT(false); // mapping plans disabled on ESP8266 (RAM, 4 bytes per mapped pixel)
+#else
+WLED_GLOBAL bool useMappingPlans    _INIT(true);  // 1D segments write through compiled mapping plans (false: per-pixel index math)
+#endif
 WLED_GLOBAL bool correctWB          _INIT(false); // CCT color correction of RGB color
 WLED_GLOBAL bool cctFromRgb         _INIT(false); // CCT is calculated from RGB instead of using seg.cct
 WLED_GLOBAL bool gammaCorrectCol    _INIT(true);  // use gamma correction on colors
@@ -394,6 +405,8 @@ WLED_GLOBAL bool notifyAlexa  _INIT(false);                       // send notifi
 WLED_GLOBAL bool notifyMacro  _INIT(false);                       // send notification for macro
 WLED_GLOBAL bool notifyHue    _INIT(true);                        // send notification if Hue light changes
 WLED_GLOBAL uint8_t udpNumRetries _INIT(0);                       // Number of times a UDP sync message is retransmitted. Increase to increase reliability
+WLED_GLOBAL bool notifyDelta _INIT(false);                        // send only changes since last keyframe (all receivers need delta support)
+WLED_GLOBAL byte frameSyncMode _INIT(FRAME_SYNC_OFF);             // align clock and frames with other nodes (FRAME_SYNC_*)
 
 WLED_GLOBAL bool alexaEnabled _INIT(false);                       // enable device discovery by Amazon Echo
 WLED_GLOBAL char alexaInvocationName[33] _INIT("Light");          // speech control name of device. Choose something voice-to-text can understand
@@ -417,6 +430,7 @@ WLED_GLOBAL uint16_t e131Universe _INIT(1);                       // settings fo
 WLED_GLOBAL uint16_t e131Port _INIT(5568);                        // DMX in port. E1.31 default is 5568, Art-Net is 6454
 WLED_GLOBAL byte e131Priority _INIT(0);                           // E1.31 port priority (if != 0 priority handling is active)
 WLED_GLOBAL E131Priority highPriority _INIT(3);                   // E1.31 highest priority tracking, init = timeout in seconds
+WLED_GLOBAL byte rtMergeMode _INIT(RT_MERGE_PRIORITY);            // how frames of multiple realtime senders are merged (RT_MERGE_*)
 WLED_GLOBAL byte DMXMode _INIT(DMX_MODE_MULTIPLE_RGB);            // DMX mode (s.a.)
 WLED_GLOBAL uint16_t DMXAddress _INIT(1);                         // DMX start address of fixture, a.k.a. first Channel [for E1.31 (sACN) protocol]
 WLED_GLOBAL uint16_t DMXSegmentSpacing _INIT(0);                  // Number of void/unused channels between each segments DMX channels
@@ -528,6 +542,7 @@ WLED_GLOBAL byte lastRandomIndex _INIT(0);        // used to save last random co
 // transitions
 WLED_GLOBAL bool          fadeTransition          _INIT(true);    // enable crossfading brightness/color
 WLED_GLOBAL bool          modeBlending            _INIT(true);    // enable effect blending
+WLED_GLOBAL byte          transitionCurve         _INIT(TRANSITION_LINEAR); // effect blending curve (only for segments with frame buffer)
 WLED_GLOBAL bool          transitionActive        _INIT(false);
 WLED_GLOBAL uint16_t      transitionDelay         _INIT(750);     // global transition duration
 WLED_GLOBAL uint16_t      transitionDelayDefault  _INIT(750);     // default transition time (stored in cfg.json)
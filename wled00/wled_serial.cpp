@@ -19,6 +19,8 @@ enum class AdaState {
   TPM2_Header_CountLo,
 };
 
+#define ADALIGHT_SPAN_LEN 64 // received pixels written to the strip at once
+
 uint16_t currentBaud = 1152; //default baudrate 115200 (divided by 100)
 bool continuousSendLED = false;
 uint32_t lastUpdate = 0;
@@ -77,8 +79,8 @@ void handleSerial()
   static uint16_t count = 0;
   static uint16_t pixel = 0;
   static byte check = 0x00;
-  static byte red   = 0x00;
-  static byte green = 0x00;
+  static byte rgb[ADALIGHT_SPAN_LEN*3]; // received pixel data not yet written to the strip
+  static uint16_t rgbLen = 0;
 
   while (Serial.available() > 0)
   {
@@ -145,6 +147,7 @@ void handleSerial()
         break;
       case AdaState::Header_CountHi:
         pixel = 0;
+        rgbLen = 0;
         count = next * 0x100;
         check = next;
         state = AdaState::Header_CountLo;
@@ -165,6 +168,7 @@ void handleSerial()
         break;
       case AdaState::TPM2_Header_CountHi:
         pixel = 0;
+        rgbLen = 0;
         count = (next * 0x100) /3;
         state = AdaState::TPM2_Header_CountLo;
         break;
@@ -173,17 +177,22 @@ void handleSerial()
         state = AdaState::Data_Red;
         break;
       case AdaState::Data_Red:
-        red   = next;
+        rgb[rgbLen++] = next;
         state = AdaState::Data_Green;
         break;
       case AdaState::Data_Green:
-        green = next;
+        rgb[rgbLen++] = next;
         state = AdaState::Data_Blue;
         break;
       case AdaState::Data_Blue:
-        byte blue  = next;
-        if (!realtimeOverride) setRealtimePixel(pixel++, red, green, blue, 0);
-        if (--count > 0) state = AdaState::Data_Red;
+        rgb[rgbLen++] = next;
+        --count;
+        if (rgbLen == sizeof(rgb) || count == 0) { // write pixels in spans instead of one by one
+          if (!realtimeOverride) setRealtimePixels(pixel, rgb, rgbLen/3, 3);
+          pixel += rgbLen/3;
+          rgbLen = 0;
+        }
+        if (count > 0) state = AdaState::Data_Red;
         else {
           realtimeLock(realtimeTimeoutMs, REALTIME_MODE_ADALIGHT);
 
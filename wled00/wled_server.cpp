@@ -52,7 +52,7 @@ void handleUpload(AsyncWebServerRequest *request, const String& filename, size_t
     request->_tempFile = WLED_FS.open(finalname, "w");
     DEBUG_PRINT(F("Uploading "));
     DEBUG_PRINTLN(finalname);
-    if (finalname.equals("/presets.json")) presetsModifiedTime = toki.second();
+    if (finalname.equals("/presets.json")) { presetsModifiedTime = toki.second(); invalidatePresetIndex(); markPresetCacheDirty(); }
   }
   if (len) {
     request->_tempFile.write(data,len);
@@ -64,21 +64,41 @@ void handleUpload(AsyncWebServerRequest *request, const String& filename, size_t
       request->send(200, "text/plain", F("Configuration restore successful.\nRebooting..."));
     } else {
       if (filename.indexOf(F("palette")) >= 0 && filename.indexOf(F(".json")) >= 0) strip.loadCustomPalettes();
+      if (filename.indexOf(F("presets.json")) >= 0) { invalidatePresetIndex(); markPresetCacheDirty(); } // presets applied during upload
       request->send(200, "text/plain", F("File Uploaded!"));
     }
     cacheInvalidate++;
   }
 }
 
+#ifdef WLED_ENABLE_FS_EDITOR
+// SPIFFSEditor (its handlers are final) that drops preset index and cache after files were uploaded, created or deleted
+class PresetAwareEditor : public AsyncWebHandler {
+  private:
+    SPIFFSEditor _editor;
+  public:
+    #ifdef ARDUINO_ARCH_ESP32
+    PresetAwareEditor() : _editor(WLED_FS) {}//http_username,http_password)
+    #else
+    PresetAwareEditor() : _editor("","",WLED_FS) {}//http_username,http_password)
+    #endif
+    bool canHandle(AsyncWebServerRequest *request) override { return _editor.canHandle(request); }
+    void handleRequest(AsyncWebServerRequest *request) override {
+      _editor.handleRequest(request);
+      if (request->method() != HTTP_GET) { invalidatePresetIndex(); markPresetCacheDirty(); }
+    }
+    void handleUpload(AsyncWebServerRequest *request, const String& filename, size_t index, uint8_t *data, size_t len, bool final) override {
+      _editor.handleUpload(request, filename, index, data, len, final);
+    }
+    bool isRequestHandlerTrivial() override { return false; }
+};
+#endif
+
 void createEditHandler(bool enable) {
   if (editHandler != nullptr) server.removeHandler(editHandler);
   if (enable) {
     #ifdef WLED_ENABLE_FS_EDITOR
-      #ifdef ARDUINO_ARCH_ESP32
-      editHandler = &server.addHandler(new SPIFFSEditor(WLED_FS));//http_username,http_password));
-      #else
-      editHandler = &server.addHandler(new SPIFFSEditor("","",WLED_FS));//http_username,http_password));
-      #endif
+      editHandler = &server.addHandler(new PresetAwareEditor());
     #else
       editHandler = &server.on("/edit", HTTP_GET, [](AsyncWebServerRequest *request){
         serveMessage(request, 501, "Not implemented", F("The FS editor is disabled in this build."), 254);
@@ -177,6 +197,31 @@ void initServer()
     bool verboseResponse = false;
     bool isConfig = false;
 
+    const String& url = request->url();
+    isConfig = url.indexOf("cfg") > -1;
+    if (!isConfig) {
+      // only look at "v" and "pin" here, state change itself is applied from loop() (see json_queue.cpp)
+      StaticJsonDocument<16> filter;
+      filter["v"] = true;
+      filter["pin"] = true;
+      StaticJsonDocument<128> hdr;
+      DeserializationError error = deserializeJson(hdr, (const char*)(request->_tempObject), request->contentLength(), DeserializationOption::Filter(filter));
+      if (error || !hdr.is<JsonObject>()) {
+        request->send(400, "application/json", F("{\"error\":9}")); // ERR_JSON
+        return;
+      }
+      if (hdr.containsKey("pin")) checkSettingsPIN(hdr["pin"].as<const char*>());
+      if (!hdr["v"]) {
+        if (!queueJsonCommand((const char*)(request->_tempObject), request->contentLength(), JSON_SOURCE_HTTP)) {
+          request->send(503, "application/json", F("{\"error\":3}")); // ERR_NOBUF
+          return;
+        }
+        request->send(200, "application/json", F("{\"success\":true}"));
+        return;
+      }
+      // verbose response requested, apply immediately so that the response contains new state
+    }
+
     if (!requestJSONBufferLock(14)) return;
 
     DeserializationError error = deserializeJson(doc, (uint8_t*)(request->_tempObject));
@@ -188,8 +233,6 @@ void initServer()
     }
     if (root.containsKey("pin")) checkSettingsPIN(root["pin"].as<const char*>());
 
-    const String& url = request->url();
-    isConfig = url.indexOf("cfg") > -1;
     if (!isConfig) {
       /*
       #ifdef WLED_DEBUG
@@ -11,6 +11,253 @@ unsigned long wsLastLiveTime = 0;
 
 #define WS_LIVE_INTERVAL 40
 
+/*
+ * Binary control protocol
+ * Compact alternative to the JSON API for frequent small changes (e.g. faders of a lighting desk).
+ * Message byte 0 is 'C' (command, client -> WLED) or 'D' (delta, WLED -> client), byte 1 is the protocol
+ * version, followed by any number of operations: opcode byte + fixed size payload (16 bit values little endian).
+ * Segment operations start with the segment ID (255 = all selected segments, commands only).
+ * Subscribed clients receive changed values as 'D' messages; full JSON state is not sent to them
+ * (and not serialized at all if all connected clients are subscribed). JSON API works on the same connection.
+ */
+#define WSB_VERSION     1
+#define WSB_ON          0x01 // on (1)
+#define WSB_BRI         0x02 // brightness (1)
+#define WSB_SEG_ON      0x10 // seg, on (2)
+#define WSB_SEG_BRI     0x11 // seg, opacity (2)
+#define WSB_SEG_COL     0x12 // seg, slot, R, G, B, W (6)
+#define WSB_SEG_FX      0x13 // seg, effect (2)
+#define WSB_SEG_PAL     0x14 // seg, palette (2)
+#define WSB_SEG_SX      0x15 // seg, speed (2)
+#define WSB_SEG_IX      0x16 // seg, intensity (2)
+#define WSB_SEG_BOUNDS  0x17 // seg, start, stop (5); stop 0 in delta: segment deleted
+#define WSB_SUBSCRIBE   0x7F // subscribe to delta messages, full state is sent as first delta (0)
+
+#define WSB_MAX_CLIENTS 4
+#define WSB_SEG_DELTA_LEN (3*6 + 7*NUM_COLORS + 6) // max. delta bytes per segment
+
+typedef struct WsbSegState {
+  uint32_t colors[NUM_COLORS];
+  uint16_t start, stop;
+  uint8_t  on, opacity, mode, palette, speed, intensity;
+} wsbseg;
+
+static WsbSegState wsbSeg[MAX_NUM_SEGMENTS]; // state last sent to subscribers
+static uint8_t  wsbSegs = 0;
+static uint8_t  wsbOn = 0, wsbBri = 0;
+static uint32_t wsbClients[WSB_MAX_CLIENTS] = {0};
+
+// payload length of operation, -1 if unknown
+static int8_t wsbOpLen(uint8_t op)
+{
+  switch (op) {
+    case WSB_SUBSCRIBE:  return 0;
+    case WSB_ON:
+    case WSB_BRI:        return 1;
+    case WSB_SEG_COL:    return 6;
+    case WSB_SEG_BOUNDS: return 5;
+    case WSB_SEG_ON:
+    case WSB_SEG_BRI:
+    case WSB_SEG_FX:
+    case WSB_SEG_PAL:
+    case WSB_SEG_SX:
+    case WSB_SEG_IX:     return 2;
+  }
+  return -1;
+}
+
+// number of connected subscribers
+static uint8_t wsbSubscribers()
+{
+  uint8_t n = 0;
+  for (size_t i = 0; i < WSB_MAX_CLIENTS; i++) {
+    if (!wsbClients[i]) continue;
+    if (ws.client(wsbClients[i])) n++;
+    else wsbClients[i] = 0;
+  }
+  return n;
+}
+
+static bool wsbIsSubscriber(uint32_t clientId)
+{
+  for (size_t i = 0; i < WSB_MAX_CLIENTS; i++) if (wsbClients[i] == clientId) return true;
+  return false;
+}
+
+// writes delta message with all values that differ from state last sent (or all values if full), returns length
+static size_t wsbWriteDelta(uint8_t *buf, bool full)
+{
+  size_t pos = 0;
+  buf[pos++] = 'D';
+  buf[pos++] = WSB_VERSION;
+  uint8_t on = bri > 0;
+  if (full || on != wsbOn)          { buf[pos++] = WSB_ON;  buf[pos++] = wsbOn  = on; }
+  if (full || briLast != wsbBri)    { buf[pos++] = WSB_BRI; buf[pos++] = wsbBri = briLast; }
+
+  size_t segs = strip.getSegmentsNum();
+  if (segs > MAX_NUM_SEGMENTS) segs = MAX_NUM_SEGMENTS;
+  for (size_t i = 0; i < segs; i++) {
+    Segment &seg = strip.getSegment(i);
+    WsbSegState &s = wsbSeg[i];
+    bool all = full || i >= wsbSegs;
+    if (all || seg.start != s.start || seg.stop != s.stop) {
+      s.start = seg.start; s.stop = seg.stop;
+      buf[pos++] = WSB_SEG_BOUNDS; buf[pos++] = i;
+      buf[pos++] = s.start & 0xFF; buf[pos++] = s.start >> 8;
+      buf[pos++] = s.stop  & 0xFF; buf[pos++] = s.stop  >> 8;
+    }
+    if (all || seg.on        != s.on)        { buf[pos++] = WSB_SEG_ON;  buf[pos++] = i; buf[pos++] = s.on        = seg.on; }
+    if (all || seg.opacity   != s.opacity)   { buf[pos++] = WSB_SEG_BRI; buf[pos++] = i; buf[pos++] = s.opacity   = seg.opacity; }
+    if (all || seg.mode      != s.mode)      { buf[pos++] = WSB_SEG_FX;  buf[pos++] = i; buf[pos++] = s.mode      = seg.mode; }
+    if (all || seg.palette   != s.palette)   { buf[pos++] = WSB_SEG_PAL; buf[pos++] = i; buf[pos++] = s.palette   = seg.palette; }
+    if (all || seg.speed     != s.speed)     { buf[pos++] = WSB_SEG_SX;  buf[pos++] = i; buf[pos++] = s.speed     = seg.speed; }
+    if (all || seg.intensity != s.intensity) { buf[pos++] = WSB_SEG_IX;  buf[pos++] = i; buf[pos++] = s.intensity = seg.intensity; }
+    for (size_t c = 0; c < NUM_COLORS; c++) {
+      if (!all && seg.colors[c] == s.colors[c]) continue;
+      uint32_t col = s.colors[c] = seg.colors[c];
+      buf[pos++] = WSB_SEG_COL; buf[pos++] = i; buf[pos++] = c;
+      buf[pos++] = R(col); buf[pos++] = G(col); buf[pos++] = B(col); buf[pos++] = W(col);
+    }
+  }
+  for (size_t i = segs; i < wsbSegs; i++) { // deleted segments
+    buf[pos++] = WSB_SEG_BOUNDS; buf[pos++] = i;
+    buf[pos++] = 0; buf[pos++] = 0; buf[pos++] = 0; buf[pos++] = 0;
+  }
+  wsbSegs = segs;
+  return pos;
+}
+
+// sends changes since last delta to all subscribers (or full state to a single client)
+static void sendWsDelta(AsyncWebSocketClient * client = nullptr)
+{
+  static uint8_t buf[6 + WSB_SEG_DELTA_LEN*MAX_NUM_SEGMENTS]; // too large for ESP8266 stack, only called from loop()
+  size_t len = wsbWriteDelta(buf, client != nullptr);
+  if (len <= 2) return; // nothing changed
+
+  if (client) {
+    client->binary(buf, len);
+    return;
+  }
+  AsyncWebSocketMessageBuffer * buffer = ws.makeBuffer(buf, len);
+  if (!buffer) return;
+  buffer->lock();
+  for (size_t i = 0; i < WSB_MAX_CLIENTS; i++) {
+    AsyncWebSocketClient * wsc = wsbClients[i] ? ws.client(wsbClients[i]) : nullptr;
+    if (wsc) wsc->binary(buffer);
+  }
+  buffer->unlock();
+  ws._cleanBuffers();
+}
+
+static bool wsbApplySegment(uint8_t id, uint8_t op, const uint8_t *p)
+{
+  Segment &seg = strip.getSegment(id);
+  switch (op) {
+    case WSB_SEG_ON:
+      if (seg.on == (p[0] > 0)) return false;
+      seg.setOption(SEG_OPTION_ON, p[0]); // use transition
+      break;
+    case WSB_SEG_BRI:
+      if (seg.opacity == p[0]) return false;
+      seg.setOpacity(p[0]);
+      break;
+    case WSB_SEG_COL:
+      if (p[0] >= NUM_COLORS) return false;
+      return seg.setColor(p[0], RGBW32(p[1], p[2], p[3], p[4]));
+    case WSB_SEG_FX:
+      if (p[0] == seg.mode || p[0] >= strip.getModeCount()) return false;
+      if (currentPlaylist >= 0) unloadPlaylist();
+      seg.setMode(p[0]);
+      break;
+    case WSB_SEG_PAL:
+      if (p[0] == seg.palette || !(seg.getLightCapabilities() & 1)) return false; // ignore palette for White and On/Off segments
+      seg.setPalette(p[0]);
+      break;
+    case WSB_SEG_SX:
+      if (seg.speed == p[0]) return false;
+      seg.speed = p[0];
+      break;
+    case WSB_SEG_IX:
+      if (seg.intensity == p[0]) return false;
+      seg.intensity = p[0];
+      break;
+    case WSB_SEG_BOUNDS: {
+      uint16_t start = p[0] | (p[1] << 8);
+      uint16_t stop  = p[2] | (p[3] << 8);
+      if (start == seg.start && stop == seg.stop) return false;
+      // WS2812FX handles queueing of the change (same as JSON API)
+      strip.setSegment(id, start, stop, seg.grouping, seg.spacing, seg.offset, seg.startY, seg.stopY);
+    } break;
+    default:
+      return false;
+  }
+  return true;
+}
+
+// applies binary command message (called from loop() via JSON queue)
+void handleWsBinaryCommand(const uint8_t *data, size_t len, uint32_t clientId)
+{
+  AsyncWebSocketClient * client = ws.client(clientId);
+  if (len < 2 || data[0] != 'C' || data[1] != WSB_VERSION) {
+    if (client) client->text(F("{\"error\":9}")); // ERR_JSON (unsupported message)
+    return;
+  }
+
+  bool onBefore = bri;
+  bool subscribe = false;
+  size_t pos = 2;
+  while (pos < len) {
+    uint8_t op = data[pos++];
+    int8_t opLen = wsbOpLen(op);
+    if (opLen < 0 || pos + opLen > len) {
+      if (client) client->text(F("{\"error\":9}"));
+      break; // apply what was valid so far
+    }
+    const uint8_t *p = data + pos;
+    pos += opLen;
+
+    switch (op) {
+      case WSB_SUBSCRIBE: subscribe = true; break;
+      case WSB_ON:        if (!p[0] != !bri) toggleOnOff(); break;
+      case WSB_BRI:       bri = p[0]; break;
+      default:
+        if (p[0] == 255) { // all selected segments
+          if (op == WSB_SEG_BOUNDS) break;
+          for (size_t i = 0; i < strip.getSegmentsNum(); i++) {
+            if (strip.getSegment(i).isSelected() && wsbApplySegment(i, op, p+1)) stateChanged = true;
+          }
+        } else if (p[0] < strip.getSegmentsNum()) {
+          if (wsbApplySegment(p[0], op, p+1)) stateChanged = true;
+        }
+        break;
+    }
+  }
+
+  if (bri && !onBefore) { // unfreeze all segments when turning on
+    for (size_t s=0; s < strip.getSegmentsNum(); s++) {
+      strip.getSegment(s).freeze = false;
+    }
+    if (realtimeMode && !realtimeOverride && useMainSegmentOnly) { // keep live segment frozen if live
+      strip.getMainSegment().freeze = true;
+    }
+  }
+  stateUpdated(CALL_MODE_DIRECT_CHANGE);
+
+  // send deltas right away, subscribers do not have to wait for INTERFACE_UPDATE_COOLDOWN
+  if (wsbSubscribers()) sendWsDelta();
+  if (subscribe && client) {
+    size_t i = 0;
+    while (i < WSB_MAX_CLIENTS && wsbClients[i] != clientId) i++; // already subscribed (slot before may be free)
+    if (i == WSB_MAX_CLIENTS) { i = 0; while (i < WSB_MAX_CLIENTS && wsbClients[i]) i++; } // free slot
+    if (i < WSB_MAX_CLIENTS) {
+      wsbClients[i] = clientId;
+      sendWsDelta(client); // full state
+    } else {
+      client->text(F("{\"error\":3}")); // too many subscribers
+    }
+  }
+}
+
 void wsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventType type, void * arg, uint8_t *data, size_t len)
 {
   if(type == WS_EVT_CONNECT){
@@ -20,6 +267,7 @@ void wsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventTyp
   } else if(type == WS_EVT_DISCONNECT){
     //client disconnected
     if (client->id() == wsLiveClientId) wsLiveClientId = 0;
+    for (size_t i = 0; i < WSB_MAX_CLIENTS; i++) if (wsbClients[i] == client->id()) wsbClients[i] = 0;
     DEBUG_PRINTLN(F("WS client disconnected."));
   } else if(type == WS_EVT_DATA){
     // data packet
@@ -35,34 +283,14 @@ void wsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventTyp
           return;
         }
 
-        bool verboseResponse = false;
-        if (!requestJSONBufferLock(11)) return;
-
-        DeserializationError error = deserializeJson(doc, data, len);
-        JsonObject root = doc.as<JsonObject>();
-        if (error || root.isNull()) {
-          releaseJSONBufferLock();
-          return;
+        // state changes are applied from loop() (see json_queue.cpp), response is sent from there too
+        if (!queueJsonCommand((const char*)data, len, JSON_SOURCE_WS, client->id())) {
+          client->text(F("{\"error\":3}")); // busy, try again
         }
-        if (root["v"] && root.size() == 1) {
-          //if the received value is just "{"v":true}", send only to this client
-          verboseResponse = true;
-        } else if (root.containsKey("lv")) {
-          wsLiveClientId = root["lv"] ? client->id() : 0;
-        } else {
-          verboseResponse = deserializeState(root);
-        }
-        releaseJSONBufferLock(); // will clean fileDoc
-
-        if (!interfaceUpdateCallMode) { // individual client response only needed if no WS broadcast soon
-          if (verboseResponse) {
-            sendDataWs(client);
-          } else {
-            // we have to send something back otherwise WS connection closes
-            client->text(F("{\"success\":true}"));
-          }
-          // force broadcast in 500ms after updating client
-          //lastInterfaceUpdate = millis() - (INTERFACE_UPDATE_COOLDOWN -500); // ESP8266 does not like this
+      } else if (info->opcode == WS_BINARY) {
+        // binary control protocol, applied from loop() as well
+        if (!queueJsonCommand((const char*)data, len, JSON_SOURCE_WS_BIN, client->id())) {
+          client->text(F("{\"error\":3}"));
         }
       }
     } else {
@@ -101,6 +329,12 @@ void sendDataWs(AsyncWebSocketClient * client)
   if (!ws.count()) return;
   AsyncWebSocketMessageBuffer * buffer;
 
+  if (!client) {
+    uint8_t subscribers = wsbSubscribers();
+    if (subscribers) sendWsDelta(); // binary protocol subscribers only get changes
+    if (ws.count() <= subscribers) return; // no JSON clients
+  }
+
   if (!requestJSONBufferLock(12)) return;
 
   JsonObject state = doc.createNestedObject("state");
@@ -115,6 +349,7 @@ void sendDataWs(AsyncWebSocketClient * client)
   DEBUG_PRINT(F("heap ")); DEBUG_PRINTLN(ESP.getFreeHeap());
   #ifdef ESP8266
   if (len>heap1) {
+    releaseJSONBufferLock();
     DEBUG_PRINTLN(F("Out of memory (WS)!"));
     return;
   }
@@ -129,27 +364,30 @@ void sendDataWs(AsyncWebSocketClient * client)
   if (!buffer || heap1-heap2<len) {
     releaseJSONBufferLock();
     DEBUG_PRINTLN(F("WS buffer allocation failed."));
-    ws.closeAll(1013); //code 1013 = temporary overload, try again later
-    ws.cleanupClients(0); //disconnect all clients to release memory
+    // disconnect JSON clients to release memory, binary subscribers only get small deltas and stay connected
+    for (const auto& c : ws.getClients()) {
+      if (c->status() == WS_CONNECTED && !wsbIsSubscriber(c->id())) c->close(1013); //code 1013 = temporary overload, try again later
+    }
     ws._cleanBuffers();
     return; //out of memory
   }
 
   buffer->lock();
   serializeJson(doc, (char *)buffer->get(), len);
+  releaseJSONBufferLock(); // JSON buffer is no longer needed, do not hold it while sending
 
   DEBUG_PRINT(F("Sending WS data "));
   if (client) {
     client->text(buffer);
     DEBUG_PRINTLN(F("to a single client."));
   } else {
-    ws.textAll(buffer);
+    for (const auto& c : ws.getClients()) { // like textAll() but binary protocol subscribers do not get JSON
+      if (c->status() == WS_CONNECTED && !wsbIsSubscriber(c->id())) c->text(buffer);
+    }
     DEBUG_PRINTLN(F("to multiple clients."));
   }
   buffer->unlock();
   ws._cleanBuffers();
-
-  releaseJSONBufferLock();
 }
 
 bool sendLiveLedsWs(uint32_t wsClient)
@@ -231,4 +469,5 @@ void handleWs()
 #else
 void handleWs() {}
 void sendDataWs(AsyncWebSocketClient * client) {}
+void handleWsBinaryCommand(const uint8_t *data, size_t len, uint32_t client) {}
 #endif
\ No newline at end of file